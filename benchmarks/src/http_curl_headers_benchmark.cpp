@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <curl/curl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include "http_curl_headers.hpp"
+
+/**
+ * Benchmark for parsing http response headers in the curl transport of the sample app.
+ * Compares in place parsing from a single header buffer against the previous approach of
+ * copying each header line into a curl_slist and allocating each key and value separately.
+ */
+
+#define BENCHMARK_ITERATIONS 20000
+
+
+/**
+ * @brief Get monotonic time in nanoseconds
+ */
+static long long get_time_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/**
+ * @brief Builds raw response header lines as delivered by curl, one line per callback
+ */
+static std::vector<std::string> build_resp_header_lines(int num_headers)
+{
+  std::vector<std::string> lines;
+  char buf[128];
+
+  lines.push_back("HTTP/1.1 202 Accepted\r\n");
+
+  for (int i = 0; i < num_headers; i++)
+  {
+    snprintf(buf, sizeof(buf), "X-Benchmark-Header-%d: value-of-response-header-%d\r\n", i, i);
+    lines.push_back(buf);
+  }
+
+  lines.push_back("\r\n");
+
+  return lines;
+}
+
+
+/**
+ * @brief Previous header handling: copy each line into curl_slist, then split and copy key and value
+ */
+static int legacy_parse_resp_headers(const std::vector<std::string>& lines)
+{
+  struct curl_slist* slist = NULL;
+
+  for (size_t i = 0; i < lines.size(); i++)
+  {
+    size_t realsize = lines[i].length();
+    char buf[realsize + 1];
+    memcpy(buf, lines[i].data(), realsize);
+    buf[realsize] = '\0';
+    slist = curl_slist_append(slist, buf);
+  }
+
+  int num_resp_headers = 0;
+
+  for (struct curl_slist* iter = slist; iter != NULL; iter = iter->next)
+  {
+    if (strchr(iter->data, ':') != NULL)
+    {
+      num_resp_headers++;
+    }
+  }
+
+  appd_iot_data_t* headers = (appd_iot_data_t*)calloc(num_resp_headers, sizeof(appd_iot_data_t));
+  int header_index = 0;
+
+  for (struct curl_slist* iter = slist; iter != NULL; iter = iter->next)
+  {
+    size_t data_len = strlen(iter->data);
+    char buf[data_len + 1];
+    char* buf_ptr = buf;
+
+    memcpy(buf, iter->data, data_len + 1);
+
+    char* header = strsep(&buf_ptr, "\r\n");
+    char* pch = (header != NULL) ? strchr(header, ':') : NULL;
+
+    if (pch == NULL)
+    {
+      continue;
+    }
+
+    size_t key_length = pch - header;
+    size_t value_length = strlen(pch + 1);
+    char* key = (char*)calloc(1, key_length + 1);
+    char* value = (char*)calloc(1, value_length + 1);
+
+    memcpy(key, header, key_length);
+    memcpy(value, pch + 1, value_length);
+
+    appd_iot_data_set_string(&headers[header_index++], key, value);
+  }
+
+  for (int i = 0; i < header_index; i++)
+  {
+    free((void*)headers[i].key);
+    free((void*)headers[i].strval);
+  }
+
+  free(headers);
+  curl_slist_free_all(slist);
+
+  return header_index;
+}
+
+
+/**
+ * @brief Current header handling: append lines to a single buffer and parse in place
+ */
+static int inplace_parse_resp_headers(const std::vector<std::string>& lines)
+{
+  http_curl_header_buf_t buf;
+  appd_iot_data_t* headers = NULL;
+
+  memset(&buf, 0, sizeof(buf));
+
+  for (size_t i = 0; i < lines.size(); i++)
+  {
+    http_curl_header_buf_append(&buf, lines[i].data(), lines[i].length());
+  }
+
+  int num_headers = http_curl_header_buf_parse(&buf, &headers);
+
+  http_curl_header_buf_free(&buf);
+
+  return num_headers;
+}
+
+
+/**
+ * @brief Runs parse function for given number of iterations and reports time per response
+ */
+static void run_benchmark(const char* name, int (*parse)(const std::vector<std::string>&), int num_headers)
+{
+  std::vector<std::string> lines = build_resp_header_lines(num_headers);
+  int parsed = 0;
+
+  long long start = get_time_ns();
+
+  for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+  {
+    parsed += parse(lines);
+  }
+
+  long long elapsed = get_time_ns() - start;
+
+  if (parsed != num_headers * BENCHMARK_ITERATIONS)
+  {
+    fprintf(stderr, "%s: parsed %d headers, expected %d\n", name, parsed, num_headers * BENCHMARK_ITERATIONS);
+  }
+
+  fprintf(stdout, "%-10s headers:%-4d ns/response:%-10lld ns/header:%lld\n", name, num_headers,
+          elapsed / BENCHMARK_ITERATIONS, elapsed / ((long long)BENCHMARK_ITERATIONS * num_headers));
+}
+
+
+int main(int argc, char* argv[])
+{
+  const int num_headers[] = {8, 32, 128};
+
+  for (size_t i = 0; i < sizeof(num_headers) / sizeof(num_headers[0]); i++)
+  {
+    run_benchmark("legacy", legacy_parse_resp_headers, num_headers[i]);
+    run_benchmark("inplace", inplace_parse_resp_headers, num_headers[i]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <appd_iot_interface.h>
+
+/**
+ * Benchmark for per call overhead of the event add path when application links the shared sdk library
+ * versus the static library with link time optimization. The same source is built into
+ * link_benchmark_shared and link_benchmark_static, and uses public API only, as an application would.
+ *
+ * Calls are timed in batches, as a single call is too short to time on its own. Each case reports one
+ * JSON object per line on stdout:
+ *   {"benchmark":"<name>","library":"<shared|static_lto>","param":"<param>=<value>","iterations":N,"ns_per_op":N}
+ *
+ * Cases:
+ *   add_custom_event  : appd_iot_add_custom_event() with given number of properties
+ *   add_error_event   : appd_iot_add_error_event()
+ *   error_code_to_str : appd_iot_error_code_to_str(), a tiny accessor which shows the cost of the call alone
+ */
+
+#ifndef APPD_IOT_BENCHMARK_LIBRARY
+#define APPD_IOT_BENCHMARK_LIBRARY "shared"
+#endif
+
+#define BENCHMARK_BATCHES 200
+#define BENCHMARK_EVENT_BATCH 100
+#define BENCHMARK_ACCESSOR_BATCH 10000
+
+
+/**
+ * @brief Get monotonic time in nanoseconds
+ */
+static long long get_time_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/**
+ * @brief Initializes SDK with logging off
+ */
+static appd_iot_error_code_t init_sdk(void)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = "BENCHMARK-APP-KEY";
+  sdkcfg.eum_collector_url = "http://localhost:9001";
+  sdkcfg.log_level = APPD_IOT_LOG_OFF;
+
+  devcfg.device_id = "1111";
+  devcfg.device_type = "SmartCar";
+
+  return appd_iot_init_sdk(sdkcfg, devcfg);
+}
+
+
+/**
+ * @brief Writes result of a benchmark case as a JSON line
+ */
+static void report(const char* name, const char* param, int value, long iterations, long long total_ns)
+{
+  fprintf(stdout, "{\"benchmark\":\"%s\",\"library\":\"%s\",\"param\":\"%s=%d\",\"iterations\":%ld,"
+          "\"ns_per_op\":%.1f}\n", name, APPD_IOT_BENCHMARK_LIBRARY, param, value, iterations,
+          (double)total_ns / iterations);
+  fflush(stdout);
+}
+
+
+/**
+ * @brief Adds custom events with given number of properties. Events are cleared between batches.
+ */
+static void run_add_custom_event(int properties)
+{
+  appd_iot_custom_event_t custom_event;
+  appd_iot_data_t data[4];
+  long long total = 0;
+
+  appd_iot_data_set_integer(&data[0], "Speed mph", 65);
+  appd_iot_data_set_string(&data[1], "Location", "SFO Bay Area");
+  appd_iot_data_set_double(&data[2], "Fuel Level", 0.6);
+  appd_iot_data_set_boolean(&data[3], "Engine On", true);
+
+  appd_iot_init_to_zero(&custom_event, sizeof(custom_event));
+
+  custom_event.type = "SmartCar Data";
+  custom_event.summary = "Car Speed and Location";
+  custom_event.timestamp_ms = ((int64_t)time(NULL) * 1000);
+  custom_event.data_count = properties;
+  custom_event.data = (properties > 0) ? data : NULL;
+
+  for (int b = 0; b < BENCHMARK_BATCHES; b++)
+  {
+    appd_iot_clear_all_events();
+
+    long long start = get_time_ns();
+
+    for (int i = 0; i < BENCHMARK_EVENT_BATCH; i++)
+    {
+      appd_iot_add_custom_event(custom_event);
+    }
+
+    total += get_time_ns() - start;
+  }
+
+  appd_iot_clear_all_events();
+
+  report("add_custom_event", "properties", properties, (long)BENCHMARK_BATCHES * BENCHMARK_EVENT_BATCH, total);
+}
+
+
+/**
+ * @brief Adds error events. Events are cleared between batches.
+ */
+static void run_add_error_event(void)
+{
+  appd_iot_error_event_t error_event;
+  long long total = 0;
+
+  appd_iot_init_to_zero(&error_event, sizeof(error_event));
+
+  error_event.name = "Warning Light";
+  error_event.message = "Oil Change Reminder";
+  error_event.severity = APPD_IOT_ERR_SEVERITY_ALERT;
+  error_event.timestamp_ms = ((int64_t)time(NULL) * 1000);
+
+  for (int b = 0; b < BENCHMARK_BATCHES; b++)
+  {
+    appd_iot_clear_all_events();
+
+    long long start = get_time_ns();
+
+    for (int i = 0; i < BENCHMARK_EVENT_BATCH; i++)
+    {
+      appd_iot_add_error_event(error_event);
+    }
+
+    total += get_time_ns() - start;
+  }
+
+  appd_iot_clear_all_events();
+
+  report("add_error_event", "properties", 0, (long)BENCHMARK_BATCHES * BENCHMARK_EVENT_BATCH, total);
+}
+
+
+/**
+ * @brief Calls a tiny accessor of the sdk
+ */
+static void run_error_code_to_str(void)
+{
+  long long total = 0;
+  size_t len = 0;
+
+  for (int b = 0; b < BENCHMARK_BATCHES; b++)
+  {
+    long long start = get_time_ns();
+
+    for (int i = 0; i < BENCHMARK_ACCESSOR_BATCH; i++)
+    {
+      len += strlen(appd_iot_error_code_to_str((appd_iot_error_code_t)(i & 7)));
+    }
+
+    total += get_time_ns() - start;
+  }
+
+  //use result so that calls are not optimized out
+  if (len == 0)
+  {
+    fprintf(stderr, "unexpected empty error code string\n");
+  }
+
+  report("error_code_to_str", "calls", 1, (long)BENCHMARK_BATCHES * BENCHMARK_ACCESSOR_BATCH, total);
+}
+
+
+int main(int argc, char* argv[])
+{
+  if (init_sdk() != APPD_IOT_SUCCESS)
+  {
+    fprintf(stderr, "sdk init failed\n");
+    return 1;
+  }
+
+  run_add_custom_event(0);
+  run_add_custom_event(4);
+  run_add_error_event();
+  run_error_code_to_str();
+
+  return 0;
+}
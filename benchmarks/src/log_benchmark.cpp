@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include <appd_iot_interface.h>
+#include "log.hpp"
+
+/**
+ * Benchmark for latency of adding a custom event with logging turned off, with
+ * INFO logging written synchronously to stderr, with INFO logging handed off
+ * to the background log thread and with INFO logging deferred in binary.
+ * stderr is redirected to /dev/null while measuring.
+ *
+ * Also measures cost of a single log call in each log mode, with the buffered log file and in JSON log format,
+ * with queued log messages written out between batches of calls so that log rings do not overflow.
+ */
+
+#define BENCHMARK_ITERATIONS 20000
+#define BENCHMARK_CLEAR_EVENTS_INTERVAL 100
+#define BENCHMARK_LOG_BATCH 256
+#define BENCHMARK_LOG_FILE "/tmp/appd_iot_log_benchmark.log"
+
+
+/**
+ * @brief Get monotonic time in nanoseconds
+ */
+static long long get_time_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/**
+ * @brief Initializes SDK with given log level and log mode
+ */
+static appd_iot_error_code_t init_sdk(appd_iot_log_level_t log_level, appd_iot_log_mode_t log_mode,
+                                      const char* log_file = NULL,
+                                      appd_iot_log_format_t log_format = APPD_IOT_LOG_FORMAT_TEXT)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = "BENCHMARK-APP-KEY";
+  sdkcfg.eum_collector_url = "http://localhost:9001";
+  sdkcfg.log_level = log_level;
+  sdkcfg.log_mode = log_mode;
+  sdkcfg.log_file = log_file;
+  sdkcfg.log_format = log_format;
+
+  devcfg.device_id = "1111";
+  devcfg.device_type = "SmartCar";
+
+  return appd_iot_init_sdk(sdkcfg, devcfg);
+}
+
+
+/**
+ * @brief Adds custom events for given number of iterations and reports latency per event
+ */
+static void run_benchmark(const char* name, appd_iot_log_level_t log_level, appd_iot_log_mode_t log_mode)
+{
+  appd_iot_custom_event_t custom_event;
+  appd_iot_data_t custom_event_data[3];
+  std::vector<long long> samples(BENCHMARK_ITERATIONS);
+
+  if (init_sdk(log_level, log_mode) != APPD_IOT_SUCCESS)
+  {
+    fprintf(stdout, "%-6s sdk init failed\n", name);
+    return;
+  }
+
+  appd_iot_init_to_zero(&custom_event, sizeof(custom_event));
+
+  custom_event.type = "SmartCar Data";
+  custom_event.summary = "Car Speed and Location";
+  custom_event.timestamp_ms = ((int64_t)time(NULL) * 1000);
+  custom_event.duration_ms = 0;
+  custom_event.data_count = 3;
+  custom_event.data = custom_event_data;
+
+  appd_iot_data_set_integer(&custom_event_data[0], "Speed mph", 65);
+  appd_iot_data_set_string(&custom_event_data[1], "Location", "SFO Bay Area");
+  appd_iot_data_set_double(&custom_event_data[2], "Fuel Level", 0.6);
+
+  long long total = 0;
+
+  for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+  {
+    if (i % BENCHMARK_CLEAR_EVENTS_INTERVAL == 0)
+    {
+      appd_iot_clear_all_events();
+    }
+
+    long long start = get_time_ns();
+
+    appd_iot_add_custom_event(custom_event);
+
+    samples[i] = get_time_ns() - start;
+    total += samples[i];
+  }
+
+  appd_iot_clear_all_events();
+  appd_iot_flush_log();
+
+  std::sort(samples.begin(), samples.end());
+
+  fprintf(stdout, "%-6s ns/event:%-8lld p50:%-8lld p99:%lld\n", name, total / BENCHMARK_ITERATIONS,
+          samples[BENCHMARK_ITERATIONS / 2], samples[(BENCHMARK_ITERATIONS * 99) / 100]);
+}
+
+
+/**
+ * @brief Logs a typical SDK message for given number of iterations and reports time per log call
+ */
+static void run_log_call_benchmark(const char* name, appd_iot_log_mode_t log_mode, const char* log_file = NULL,
+                                   appd_iot_log_format_t log_format = APPD_IOT_LOG_FORMAT_TEXT)
+{
+  const char* key = "Location";
+  long long total = 0;
+
+  if (init_sdk(APPD_IOT_LOG_INFO, log_mode, log_file, log_format) != APPD_IOT_SUCCESS)
+  {
+    fprintf(stdout, "%-6s sdk init failed\n", name);
+    return;
+  }
+
+  appd_iot_flush_log();
+
+  for (int i = 0; i < BENCHMARK_ITERATIONS; i += BENCHMARK_LOG_BATCH)
+  {
+    long long start = get_time_ns();
+
+    for (int j = 0; j < BENCHMARK_LOG_BATCH; j++)
+    {
+      appd_iot_log(APPD_IOT_LOG_INFO, "Added Key :%s with value type:%d", key, j);
+    }
+
+    total += get_time_ns() - start;
+
+    appd_iot_flush_log();
+  }
+
+  int calls = ((BENCHMARK_ITERATIONS + BENCHMARK_LOG_BATCH - 1) / BENCHMARK_LOG_BATCH) * BENCHMARK_LOG_BATCH;
+
+  fprintf(stdout, "%-6s ns/log-call:%lld\n", name, total / calls);
+}
+
+
+int main(int argc, char* argv[])
+{
+  int devnull = open("/dev/null", O_WRONLY);
+
+  if (devnull < 0)
+  {
+    fprintf(stderr, "Failed to open /dev/null\n");
+    return 1;
+  }
+
+  fflush(stdout);
+  dup2(devnull, STDERR_FILENO);
+  close(devnull);
+
+  run_benchmark("off", APPD_IOT_LOG_OFF, APPD_IOT_LOG_MODE_SYNC);
+  run_benchmark("sync", APPD_IOT_LOG_INFO, APPD_IOT_LOG_MODE_SYNC);
+  run_benchmark("async", APPD_IOT_LOG_INFO, APPD_IOT_LOG_MODE_ASYNC);
+  run_benchmark("binary", APPD_IOT_LOG_INFO, APPD_IOT_LOG_MODE_BINARY);
+
+  run_log_call_benchmark("sync", APPD_IOT_LOG_MODE_SYNC);
+  run_log_call_benchmark("async", APPD_IOT_LOG_MODE_ASYNC);
+  run_log_call_benchmark("binary", APPD_IOT_LOG_MODE_BINARY);
+  run_log_call_benchmark("file", APPD_IOT_LOG_MODE_SYNC, BENCHMARK_LOG_FILE);
+  run_log_call_benchmark("json", APPD_IOT_LOG_MODE_SYNC, NULL, APPD_IOT_LOG_FORMAT_JSON);
+
+  init_sdk(APPD_IOT_LOG_OFF, APPD_IOT_LOG_MODE_SYNC);
+  unlink(BENCHMARK_LOG_FILE);
+  unlink(BENCHMARK_LOG_FILE ".1");
+
+  return 0;
+}
@@ -0,0 +1,696 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <appd_iot_interface.h>
+#include "custom_event.hpp"
+#include "json_serializer.hpp"
+
+/**
+ * Benchmark suite for the event path of the SDK. Each case is run for a list of parameter values
+ * and reports one JSON object per line on stdout, so that results can be tracked across releases:
+ *   {"benchmark":"<name>","param":"<param>=<value>","cxx":<C++ standard>,"iterations":N,"ns_per_op":N,
+ *    "p50_ns":N,"p99_ns":N}
+ * "cxx" is the C++ standard sdk and benchmarks are built with (APPD_IOT_CXX_STANDARD), so that results of
+ * builds with different standards can be compared.
+ *
+ * Cases:
+ *   add_custom_event     : appd_iot_add_custom_event() with given number of properties
+ *   add_error_event      : appd_iot_add_error_event() with a stack trace of given number of frames
+ *   copy_event_data      : copy of given number of properties into SDK event data
+ *   json_escape          : serializing a string value of given length which needs escaping
+ *   send_all_events      : appd_iot_send_all_events() with given number of events, against an
+ *                          in-process mock transport which accepts each beacon
+ *   serialize_beacon     : beacon serialization part of send_all_events, from SDK stats
+ *   serialize_mixed_events : appd_iot_send_all_events() with given number of events, a third each of
+ *                          custom, network request and error events with stack traces. Time is the
+ *                          serialization time from SDK stats. Also reports serializer throughput in
+ *                          "mb_per_sec" and "cache_misses_per_op", hardware cache misses of the whole
+ *                          send, which is -1 if hardware counters are not available (e.g. non Linux,
+ *                          virtual machines or kernel.perf_event_paranoid > 2). Also reports mean time
+ *                          per event added in "add_ns_per_event" and mean time of the whole send in "send_ns"
+ *   serialize_on_add_mixed_events : serialize_mixed_events with events serialized when added, as enabled by
+ *                          serialize_on_add in SDK config. Serialization time is then the time to join
+ *                          events serialized when added, and serialization cost moves to "add_ns_per_event"
+ *
+ * Usage: sdk_benchmark [name filter]
+ * Only cases whose name contains the filter are run.
+ */
+
+#define BENCHMARK_ITERATIONS 2000
+#define BENCHMARK_CLEAR_EVENTS_INTERVAL 100
+#define BENCHMARK_MAX_PROPERTIES 64
+#define BENCHMARK_MAX_STACK_FRAMES 64
+#define BENCHMARK_MIXED_EVENT_STACK_FRAMES 16
+
+#if __cplusplus >= 201703L
+#define BENCHMARK_CXX_STANDARD 17
+#elif __cplusplus >= 201402L
+#define BENCHMARK_CXX_STANDARD 14
+#elif __cplusplus >= 201103L
+#define BENCHMARK_CXX_STANDARD 11
+#else
+#define BENCHMARK_CXX_STANDARD 98
+#endif
+
+static appd_iot_http_resp_t benchmark_http_resp;
+
+
+/**
+ * @brief Get monotonic time in nanoseconds
+ */
+static long long get_time_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/**
+ * @brief Opens a counter of hardware cache misses of the calling thread in user space
+ * @return file descriptor of the counter, -1 if hardware counters are not available
+ */
+static int open_cache_miss_counter(void)
+{
+#ifdef __linux__
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_CACHE_MISSES;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+  return -1;
+#endif
+}
+
+
+/**
+ * @brief Starts counting from zero
+ */
+static void start_counter(int fd)
+{
+#ifdef __linux__
+  if (fd >= 0)
+  {
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+}
+
+
+/**
+ * @brief Stops counting
+ * @return count since counter was started, -1 if counter is not available
+ */
+static long long stop_counter(int fd)
+{
+#ifdef __linux__
+  long long count = 0;
+
+  if (fd >= 0)
+  {
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+    if (read(fd, &count, sizeof(count)) == (ssize_t)sizeof(count))
+    {
+      return count;
+    }
+  }
+#endif
+
+  return -1;
+}
+
+
+/**
+ * @brief Mock transport which accepts each beacon without sending it
+ */
+static appd_iot_http_resp_t* benchmark_http_req_send_cb(const appd_iot_http_req_t* http_req)
+{
+  memset(&benchmark_http_resp, 0, sizeof(benchmark_http_resp));
+  benchmark_http_resp.resp_code = 202;
+
+  return &benchmark_http_resp;
+}
+
+
+/**
+ * @brief Http response done callback of mock transport
+ */
+static void benchmark_http_resp_done_cb(appd_iot_http_resp_t* http_resp)
+{
+}
+
+
+/**
+ * @brief Initializes SDK with logging off and registers mock transport
+ * @param serialize_on_add indicates if events are serialized when added
+ */
+static appd_iot_error_code_t init_sdk(bool serialize_on_add = false)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  appd_iot_http_cb_t http_cb;
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = "BENCHMARK-APP-KEY";
+  sdkcfg.eum_collector_url = "http://localhost:9001";
+  sdkcfg.log_level = APPD_IOT_LOG_OFF;
+  sdkcfg.serialize_on_add = serialize_on_add;
+
+  devcfg.device_id = "1111";
+  devcfg.device_type = "SmartCar";
+
+  if ((retcode = appd_iot_init_sdk(sdkcfg, devcfg)) != APPD_IOT_SUCCESS)
+  {
+    return retcode;
+  }
+
+  http_cb.http_req_send_cb = &benchmark_http_req_send_cb;
+  http_cb.http_resp_done_cb = &benchmark_http_resp_done_cb;
+
+  return appd_iot_register_network_interface(http_cb);
+}
+
+
+/**
+ * @brief Fills properties of a custom event, cycling through value types
+ * @param data to be filled
+ * @param count contains number of properties
+ * @param keys holds key strings, which must outlive data
+ */
+static void fill_properties(appd_iot_data_t* data, int count, std::vector<std::string>& keys)
+{
+  char key[32];
+
+  keys.clear();
+
+  for (int i = 0; i < count; i++)
+  {
+    snprintf(key, sizeof(key), "Property %d", i);
+    keys.push_back(key);
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    switch (i % 4)
+    {
+      case 0:
+        appd_iot_data_set_integer(&data[i], keys[i].c_str(), 65 + i);
+        break;
+
+      case 1:
+        appd_iot_data_set_string(&data[i], keys[i].c_str(), "SFO Bay Area");
+        break;
+
+      case 2:
+        appd_iot_data_set_double(&data[i], keys[i].c_str(), 0.6 * i);
+        break;
+
+      default:
+        appd_iot_data_set_boolean(&data[i], keys[i].c_str(), true);
+        break;
+    }
+  }
+}
+
+
+/**
+ * @brief Initializes custom event with given properties
+ */
+static void init_custom_event(appd_iot_custom_event_t* custom_event, appd_iot_data_t* data, int count)
+{
+  appd_iot_init_to_zero(custom_event, sizeof(appd_iot_custom_event_t));
+
+  custom_event->type = "SmartCar Data";
+  custom_event->summary = "Car Speed and Location";
+  custom_event->timestamp_ms = ((int64_t)time(NULL) * 1000);
+  custom_event->data_count = count;
+  custom_event->data = (count > 0) ? data : NULL;
+}
+
+
+/**
+ * @brief Writes result of a benchmark case as a JSON line
+ * @param samples contains time of each operation in nanoseconds, sorted in place
+ * @param extra_fields contains case specific fields, each starting with a comma
+ */
+static void report(const char* name, const char* param, int value, std::vector<long long>& samples,
+                   const char* extra_fields = "")
+{
+  long long total = 0;
+
+  if (samples.empty())
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < samples.size(); i++)
+  {
+    total += samples[i];
+  }
+
+  std::sort(samples.begin(), samples.end());
+
+  fprintf(stdout, "{\"benchmark\":\"%s\",\"param\":\"%s=%d\",\"cxx\":%d,\"iterations\":%lu,"
+          "\"ns_per_op\":%lld,\"p50_ns\":%lld,\"p99_ns\":%lld%s}\n", name, param, value, BENCHMARK_CXX_STANDARD,
+          (unsigned long)samples.size(), total / (long long)samples.size(), samples[samples.size() / 2],
+          samples[(samples.size() * 99) / 100], extra_fields);
+  fflush(stdout);
+}
+
+
+/**
+ * @brief Adds custom events with given number of properties
+ */
+static void run_add_custom_event(int properties)
+{
+  appd_iot_custom_event_t custom_event;
+  appd_iot_data_t data[BENCHMARK_MAX_PROPERTIES];
+  std::vector<std::string> keys;
+  std::vector<long long> samples(BENCHMARK_ITERATIONS);
+
+  fill_properties(data, properties, keys);
+  init_custom_event(&custom_event, data, properties);
+
+  for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+  {
+    if (i % BENCHMARK_CLEAR_EVENTS_INTERVAL == 0)
+    {
+      appd_iot_clear_all_events();
+    }
+
+    long long start = get_time_ns();
+
+    appd_iot_add_custom_event(custom_event);
+
+    samples[i] = get_time_ns() - start;
+  }
+
+  appd_iot_clear_all_events();
+
+  report("add_custom_event", "properties", properties, samples);
+}
+
+
+/**
+ * @brief Initializes an error event with a stack trace of given number of frames
+ * @param stack_trace and stack_frame hold the stack trace, which must outlive error_event
+ */
+static void init_error_event(appd_iot_error_event_t* error_event, appd_iot_stack_trace_t* stack_trace,
+                             appd_iot_stack_frame_t* stack_frame, int frames)
+{
+  for (int i = 0; i < frames; i++)
+  {
+    appd_iot_init_to_zero(&stack_frame[i], sizeof(stack_frame[i]));
+
+    stack_frame[i].symbol_name = "_appd_iot_benchmark_symbol_with_a_long_mangled_name";
+    stack_frame[i].package_name = "/usr/lib/libappdynamicsiotbenchmark.so";
+    stack_frame[i].file_name = "sdk_benchmark.cpp";
+    stack_frame[i].lineno = i;
+    stack_frame[i].absolute_addr = 0x7f0000000000ULL + i;
+  }
+
+  appd_iot_init_to_zero(stack_trace, sizeof(*stack_trace));
+
+  stack_trace->thread = "main";
+  stack_trace->stack_frame_count = frames;
+  stack_trace->stack_frame = (frames > 0) ? stack_frame : NULL;
+
+  appd_iot_init_to_zero(error_event, sizeof(*error_event));
+
+  error_event->name = "Warning Light";
+  error_event->message = "Oil Change Reminder";
+  error_event->severity = APPD_IOT_ERR_SEVERITY_ALERT;
+  error_event->timestamp_ms = ((int64_t)time(NULL) * 1000);
+  error_event->stack_trace_count = 1;
+  error_event->stack_trace = stack_trace;
+}
+
+
+/**
+ * @brief Adds error events with a stack trace of given number of frames
+ */
+static void run_add_error_event(int frames)
+{
+  appd_iot_error_event_t error_event;
+  appd_iot_stack_trace_t stack_trace;
+  appd_iot_stack_frame_t stack_frame[BENCHMARK_MAX_STACK_FRAMES];
+  std::vector<long long> samples(BENCHMARK_ITERATIONS);
+
+  init_error_event(&error_event, &stack_trace, stack_frame, frames);
+
+  for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+  {
+    if (i % BENCHMARK_CLEAR_EVENTS_INTERVAL == 0)
+    {
+      appd_iot_clear_all_events();
+    }
+
+    long long start = get_time_ns();
+
+    appd_iot_add_error_event(error_event);
+
+    samples[i] = get_time_ns() - start;
+  }
+
+  appd_iot_clear_all_events();
+
+  report("add_error_event", "frames", frames, samples);
+}
+
+
+/**
+ * @brief Copies given number of properties into SDK event data
+ */
+static void run_copy_event_data(int properties)
+{
+  appd_iot_data_t data[BENCHMARK_MAX_PROPERTIES];
+  std::vector<std::string> keys;
+  std::vector<long long> samples(BENCHMARK_ITERATIONS);
+
+  fill_properties(data, properties, keys);
+
+  for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+  {
+    data_t event_data;
+    long long start = get_time_ns();
+
+    appd_iot_copy_event_data(&event_data, data, properties);
+
+    samples[i] = get_time_ns() - start;
+  }
+
+  report("copy_event_data", "properties", properties, samples);
+}
+
+
+/**
+ * @brief Serializes a string value of given length, a quarter of which are chars that need escaping
+ */
+static void run_json_escape(int length)
+{
+  static const char escaped_chars[] = {'"', '\\', '\n', '\t'};
+  std::vector<long long> samples(BENCHMARK_ITERATIONS);
+  std::string value;
+  json_t* json = appd_iot_json_init();
+
+  if (json == NULL)
+  {
+    return;
+  }
+
+  for (int i = 0; i < length; i++)
+  {
+    value += (i % 4 == 3) ? escaped_chars[(i / 4) % sizeof(escaped_chars)] : (char)('a' + i % 26);
+  }
+
+  for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+  {
+    long long start = get_time_ns();
+
+    appd_iot_json_reset(json);
+    appd_iot_json_start_object(json, NULL);
+    appd_iot_json_add_string_key_value(json, "message", value.c_str());
+    appd_iot_json_end_object(json);
+
+    samples[i] = get_time_ns() - start;
+  }
+
+  appd_iot_json_free(json);
+
+  report("json_escape", "length", length, samples);
+}
+
+
+/**
+ * @brief Sends given number of events against mock transport. Also reports serialization time of
+ * each send, as measured by the SDK.
+ */
+static void run_send_all_events(int events)
+{
+  appd_iot_custom_event_t custom_event;
+  appd_iot_data_t data[BENCHMARK_MAX_PROPERTIES];
+  std::vector<std::string> keys;
+  int iterations = BENCHMARK_ITERATIONS / 10;
+  std::vector<long long> samples(iterations);
+  std::vector<long long> serialize_samples(iterations);
+  appd_iot_stats_t before, after;
+
+  fill_properties(data, 8, keys);
+  init_custom_event(&custom_event, data, 8);
+
+  appd_iot_clear_all_events();
+
+  for (int i = 0; i < iterations; i++)
+  {
+    for (int j = 0; j < events; j++)
+    {
+      appd_iot_add_custom_event(custom_event);
+    }
+
+    appd_iot_get_stats(&before);
+
+    long long start = get_time_ns();
+
+    appd_iot_send_all_events();
+
+    samples[i] = get_time_ns() - start;
+
+    appd_iot_get_stats(&after);
+
+    serialize_samples[i] = (long long)(after.serialize_latency.sum_us - before.serialize_latency.sum_us) * 1000;
+  }
+
+  report("send_all_events", "events", events, samples);
+  report("serialize_beacon", "events", events, serialize_samples);
+}
+
+
+/**
+ * @brief Sends given number of events of all types against mock transport and reports serialization
+ * time, serializer throughput and cache misses of each send, along with time to add events and time
+ * of the whole send
+ * @param name contains name of benchmark case
+ * @param events contains number of events sent at once
+ */
+static void run_serialize_mixed_events(const char* name, int events)
+{
+  appd_iot_custom_event_t custom_event;
+  appd_iot_network_request_event_t network_event;
+  appd_iot_error_event_t error_event;
+  appd_iot_stack_trace_t stack_trace;
+  appd_iot_stack_frame_t stack_frame[BENCHMARK_MIXED_EVENT_STACK_FRAMES];
+  appd_iot_data_t data[BENCHMARK_MAX_PROPERTIES];
+  appd_iot_data_t resp_headers[2];
+  std::vector<std::string> keys;
+  int iterations = BENCHMARK_ITERATIONS / 10;
+  std::vector<long long> samples(iterations);
+  appd_iot_stats_t before, after;
+  uint64_t bytes = 0;
+  long long serialize_ns = 0;
+  long long add_ns = 0;
+  long long send_ns = 0;
+  long long cache_misses = 0;
+  int counter_fd = open_cache_miss_counter();
+
+  fill_properties(data, 8, keys);
+  init_custom_event(&custom_event, data, 8);
+  init_error_event(&error_event, &stack_trace, stack_frame, BENCHMARK_MIXED_EVENT_STACK_FRAMES);
+
+  appd_iot_data_set_string(&resp_headers[0], "Content-Type", "application/json");
+  appd_iot_data_set_string(&resp_headers[1], "Cache-Control", "no-cache");
+
+  appd_iot_init_to_zero(&network_event, sizeof(network_event));
+
+  network_event.url = "https://api.smartcar.com/v1/vehicles/status";
+  network_event.resp_code = 200;
+  network_event.duration_ms = 10;
+  network_event.req_content_length = 256;
+  network_event.resp_content_length = 1024;
+  network_event.timestamp_ms = ((int64_t)time(NULL) * 1000);
+  network_event.resp_headers_count = 2;
+  network_event.resp_headers = resp_headers;
+  network_event.data_count = 4;
+  network_event.data = data;
+
+  appd_iot_clear_all_events();
+
+  for (int i = 0; i < iterations; i++)
+  {
+    long long start = get_time_ns();
+
+    for (int j = 0; j < events; j++)
+    {
+      if (j % 3 == 0)
+      {
+        appd_iot_add_custom_event(custom_event);
+      }
+      else if (j % 3 == 1)
+      {
+        appd_iot_add_network_request_event(network_event);
+      }
+      else
+      {
+        appd_iot_add_error_event(error_event);
+      }
+    }
+
+    add_ns += get_time_ns() - start;
+
+    appd_iot_get_stats(&before);
+
+    start_counter(counter_fd);
+    start = get_time_ns();
+
+    appd_iot_send_all_events();
+
+    send_ns += get_time_ns() - start;
+
+    long long count = stop_counter(counter_fd);
+
+    appd_iot_get_stats(&after);
+
+    samples[i] = (long long)(after.serialize_latency.sum_us - before.serialize_latency.sum_us) * 1000;
+    serialize_ns += samples[i];
+    bytes += after.bytes_serialized - before.bytes_serialized;
+    cache_misses = (count >= 0 && cache_misses >= 0) ? cache_misses + count : -1;
+  }
+
+  appd_iot_clear_all_events();
+
+  if (counter_fd >= 0)
+  {
+    close(counter_fd);
+  }
+
+  char extra_fields[192];
+
+  snprintf(extra_fields, sizeof(extra_fields), ",\"mb_per_sec\":%.1f,\"cache_misses_per_op\":%lld,"
+           "\"add_ns_per_event\":%lld,\"send_ns\":%lld",
+           (serialize_ns > 0) ? ((double)bytes * 1000.0) / serialize_ns : 0.0,
+           (cache_misses >= 0) ? cache_misses / iterations : -1LL,
+           add_ns / ((long long)iterations * events), send_ns / iterations);
+
+  report(name, "events", events, samples, extra_fields);
+}
+
+
+/**
+ * @brief Checks if benchmark case is selected by name filter
+ */
+static bool is_selected(const char* filter, const char* name)
+{
+  return (filter == NULL || strstr(name, filter) != NULL);
+}
+
+
+int main(int argc, char* argv[])
+{
+  static const int properties[] = {0, 4, 16, 64};
+  static const int lengths[] = {16, 256, 4096};
+  static const int events[] = {1, 50, 200};
+  static const int mixed_events[] = {30, 150, 600};
+  const char* filter = (argc > 1) ? argv[1] : NULL;
+
+  if (init_sdk() != APPD_IOT_SUCCESS)
+  {
+    fprintf(stderr, "sdk init failed\n");
+    return 1;
+  }
+
+  for (size_t i = 0; i < sizeof(properties) / sizeof(properties[0]); i++)
+  {
+    if (is_selected(filter, "add_custom_event"))
+    {
+      run_add_custom_event(properties[i]);
+    }
+
+    if (is_selected(filter, "copy_event_data"))
+    {
+      run_copy_event_data(properties[i]);
+    }
+
+    if (is_selected(filter, "add_error_event"))
+    {
+      run_add_error_event(properties[i]);
+    }
+  }
+
+  for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+  {
+    if (is_selected(filter, "json_escape"))
+    {
+      run_json_escape(lengths[i]);
+    }
+  }
+
+  for (size_t i = 0; i < sizeof(events) / sizeof(events[0]); i++)
+  {
+    if (is_selected(filter, "send_all_events") || is_selected(filter, "serialize_beacon"))
+    {
+      run_send_all_events(events[i]);
+    }
+  }
+
+  for (size_t i = 0; i < sizeof(mixed_events) / sizeof(mixed_events[0]); i++)
+  {
+    if (is_selected(filter, "serialize_mixed_events"))
+    {
+      run_serialize_mixed_events("serialize_mixed_events", mixed_events[i]);
+    }
+  }
+
+  if (is_selected(filter, "serialize_on_add_mixed_events"))
+  {
+    init_sdk(true);
+
+    for (size_t i = 0; i < sizeof(mixed_events) / sizeof(mixed_events[0]); i++)
+    {
+      run_serialize_mixed_events("serialize_on_add_mixed_events", mixed_events[i]);
+    }
+
+    init_sdk();
+  }
+
+  return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "http_curl_headers.hpp"
+
+#define HTTP_CURL_HEADER_BUF_MIN_CAP 512
+#define HTTP_CURL_HEADER_ALIGN 8
+
+
+/**
+ * @brief Grows header buffer geometrically to hold at least min_cap bytes
+ * @param buf header buffer to be grown
+ * @param min_cap contains minimum number of bytes required
+ * @return true on success, false on failure to allocate memory
+ */
+static bool http_curl_header_buf_reserve(http_curl_header_buf_t* buf, size_t min_cap)
+{
+  if (min_cap <= buf->cap)
+  {
+    return true;
+  }
+
+  size_t new_cap = (buf->cap != 0) ? buf->cap : HTTP_CURL_HEADER_BUF_MIN_CAP;
+
+  while (new_cap < min_cap)
+  {
+    new_cap *= 2;
+  }
+
+  char* tmp = (char*)realloc(buf->data, new_cap);
+
+  if (tmp == NULL)
+  {
+    return false;
+  }
+
+  buf->data = tmp;
+  buf->cap = new_cap;
+
+  return true;
+}
+
+
+/**
+ * @brief Appends a raw response header line to header buffer.
+ * @param buf header buffer to which line is appended
+ * @param line contains header line. It need not be null terminated.
+ * @param len contains length of the header line
+ * @return number of bytes appended. 0 on failure to allocate memory.
+ */
+size_t http_curl_header_buf_append(http_curl_header_buf_t* buf, const char* line, size_t len)
+{
+  /* status line of a new response, keep headers of final response only */
+  if (len >= 5 && memcmp(line, "HTTP/", 5) == 0)
+  {
+    buf->len = 0;
+    buf->num_headers = 0;
+  }
+
+  if (!http_curl_header_buf_reserve(buf, buf->len + len))
+  {
+    return 0;
+  }
+
+  memcpy(buf->data + buf->len, line, len);
+  buf->len += len;
+
+  if (memchr(line, ':', len) != NULL)
+  {
+    buf->num_headers++;
+  }
+
+  return len;
+}
+
+
+/**
+ * @brief Parses header lines in key:value format in place.
+ * @param buf header buffer containing header lines
+ * @param dest_headers to which pointer to the array of parsed headers is written to
+ * @return number of headers parsed
+ */
+int http_curl_header_buf_parse(http_curl_header_buf_t* buf, appd_iot_data_t** dest_headers)
+{
+  *dest_headers = NULL;
+
+  if (buf->num_headers == 0)
+  {
+    return 0;
+  }
+
+  /* header array is placed after header lines, leaving room to null terminate the last line */
+  size_t array_offset = (buf->len + HTTP_CURL_HEADER_ALIGN) & ~((size_t)HTTP_CURL_HEADER_ALIGN - 1);
+
+  if (!http_curl_header_buf_reserve(buf, array_offset + buf->num_headers * sizeof(appd_iot_data_t)))
+  {
+    return 0;
+  }
+
+  appd_iot_data_t* headers = (appd_iot_data_t*)(buf->data + array_offset);
+  char* line = buf->data;
+  char* end = buf->data + buf->len;
+  int header_index = 0;
+
+  while (line < end && header_index < buf->num_headers)
+  {
+    char* eol = (char*)memchr(line, '\n', end - line);
+    char* line_end = (eol != NULL) ? eol : end;
+    char* next = (eol != NULL) ? eol + 1 : end;
+
+    if (line_end > line && line_end[-1] == '\r')
+    {
+      line_end--;
+    }
+
+    char* delimiter = (char*)memchr(line, ':', line_end - line);
+
+    if (delimiter != NULL)
+    {
+      *delimiter = '\0';
+      *line_end = '\0';
+
+      memset(&headers[header_index], 0, sizeof(appd_iot_data_t));
+      appd_iot_data_set_string(&headers[header_index], line, delimiter + 1);
+      header_index++;
+    }
+
+    line = next;
+  }
+
+  *dest_headers = headers;
+
+  return header_index;
+}
+
+
+/**
+ * @brief Discards header lines in header buffer, keeping its memory for reuse by next response
+ * @param buf header buffer to be reset
+ */
+void http_curl_header_buf_reset(http_curl_header_buf_t* buf)
+{
+  buf->len = 0;
+  buf->num_headers = 0;
+}
+
+
+/**
+ * @brief Frees header buffer along with any headers parsed from it
+ * @param buf header buffer to be freed
+ */
+void http_curl_header_buf_free(http_curl_header_buf_t* buf)
+{
+  free(buf->data);
+
+  buf->data = NULL;
+  buf->len = 0;
+  buf->cap = 0;
+  buf->num_headers = 0;
+}
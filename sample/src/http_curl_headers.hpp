@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _HTTP_CURL_HEADERS_HPP_
+#define _HTTP_CURL_HEADERS_HPP_
+
+#include <stddef.h>
+#include <appd_iot_interface.h>
+
+/**
+ * @brief holder for raw http response header lines of a single response. <br>
+ * Header lines are parsed in place, and parsed headers point into this buffer. <br>
+ * The buffer is the only allocation made for response headers.
+ */
+typedef struct
+{
+  char* data;       /* raw header lines as received */
+  size_t len;       /* number of bytes used in data */
+  size_t cap;       /* number of bytes allocated for data */
+  int num_headers;  /* number of header lines in key:value format */
+} http_curl_header_buf_t;
+
+
+/**
+ * @brief Appends a raw response header line to header buffer. <br>
+ * A status line ("HTTP/...") starts a new response (e.g. after a redirect), discarding headers
+ * of the previous response.
+ * @param buf header buffer to which line is appended
+ * @param line contains header line. It need not be null terminated.
+ * @param len contains length of the header line
+ * @return number of bytes appended. 0 on failure to allocate memory.
+ */
+size_t http_curl_header_buf_append(http_curl_header_buf_t* buf, const char* line, size_t len);
+
+
+/**
+ * @brief Parses header lines in key:value format in place. <br>
+ * Keys and values are null terminated within the header buffer, and the array of parsed headers
+ * is placed at the end of the same buffer. Parsed headers are valid until the header buffer is freed.
+ * This function must be called at most once after all header lines are appended.
+ * @param buf header buffer containing header lines
+ * @param dest_headers to which pointer to the array of parsed headers is written to
+ * @return number of headers parsed
+ */
+int http_curl_header_buf_parse(http_curl_header_buf_t* buf, appd_iot_data_t** dest_headers);
+
+
+/**
+ * @brief Discards header lines in header buffer, keeping its memory for reuse by next response
+ * @param buf header buffer to be reset
+ */
+void http_curl_header_buf_reset(http_curl_header_buf_t* buf);
+
+
+/**
+ * @brief Frees header buffer along with any headers parsed from it
+ * @param buf header buffer to be freed
+ */
+void http_curl_header_buf_free(http_curl_header_buf_t* buf);
+
+#endif //_HTTP_CURL_HEADERS_HPP_
@@ -18,31 +18,77 @@
 #include <stdlib.h>
 #include <string.h>
 #include "http_curl_interface.hpp"
+#include "http_curl_headers.hpp"
 
 
+#define HTTP_CURL_CONTENT_MIN_CAP 1024
+#define HTTP_CURL_CONTENT_MAX_INITIAL_CAP (64 * 1024)
+
 /* holder for curl response content */
 typedef struct
 {
   char* data;
   size_t len;
+  size_t cap;
 } content_t;
 
 typedef struct
 {
   CURL* ch;
   CURLcode respcode;
-  int num_resp_headers;
-  struct curl_slist* req_headers;
-  struct curl_slist* resp_headers;
+  int prepared_id;                      /* id of prepared request handle is set up for, 0 if none */
+  struct curl_slist* req_headers;       /* request headers owned by this handle */
+  struct curl_slist* req_headers_tail;  /* last node of req_headers, linked to prepared static headers */
+  http_curl_header_buf_t resp_headers;
   content_t content;
 } curl_handle_t;
 
 
+#define HTTP_CURL_MAX_IDLE_HANDLES 8
+
+/* state derived from a prepared request, reused across requests with the same prepared id */
+typedef struct
+{
+  int id;
+  CURLU* url;                           /* parsed request url */
+  struct curl_slist* static_headers;    /* encoded static request headers */
+  curl_handle_t* idle_handles[HTTP_CURL_MAX_IDLE_HANDLES]; /* handles kept to reuse their connections */
+  int idle_handles_count;
+} http_curl_prepared_t;
+
+/* sample app sends requests from a single thread, so prepared state is not locked */
+static http_curl_prepared_t global_prepared;
+
+/* multi handle of batch sends, kept across calls so that connections are reused between batches */
+static CURLM* global_multi_handle = NULL;
+
+
+/**
+ * @brief frees request headers owned by curl handle, leaving prepared static headers intact
+ * @param curl_handle containing http req details
+ */
+static void http_curl_free_req_headers(curl_handle_t* curl_handle)
+{
+  if (curl_handle->req_headers_tail != NULL)
+  {
+    curl_handle->req_headers_tail->next = NULL;
+  }
+
+  if (curl_handle->req_headers != NULL)
+  {
+    curl_slist_free_all(curl_handle->req_headers);
+  }
+
+  curl_handle->req_headers = NULL;
+  curl_handle->req_headers_tail = NULL;
+}
+
+
 /**
  * @brief frees CURL data structures used for http req and response.
  * @param curl_handle containing http req and resp details
  */
-static void http_curl_deinit(curl_handle_t* curl_handle)
+static void http_curl_destroy(curl_handle_t* curl_handle)
 {
   if (curl_handle != NULL)
   {
@@ -51,32 +97,69 @@ static void http_curl_deinit(curl_handle_t* curl_handle)
       curl_easy_cleanup(curl_handle->ch);
     }
 
-    if (curl_handle->req_headers != NULL)
-    {
-      curl_slist_free_all(curl_handle->req_headers);
-    }
+    http_curl_free_req_headers(curl_handle);
 
     if (curl_handle->content.data != NULL)
     {
       free(curl_handle->content.data);
     }
 
-    if (curl_handle->resp_headers != NULL)
-    {
-      curl_slist_free_all(curl_handle->resp_headers);
-    }
+    http_curl_header_buf_free(&curl_handle->resp_headers);
 
     free(curl_handle);
   }
 }
 
 
+/**
+ * @brief releases CURL data structures used for http req and response. <br>
+ * Handles set up for the current prepared request are kept for reuse, along with their
+ * connections and buffers, others are freed.
+ * @param curl_handle containing http req and resp details
+ */
+static void http_curl_deinit(curl_handle_t* curl_handle)
+{
+  if (curl_handle == NULL)
+  {
+    return;
+  }
+
+  if (curl_handle->prepared_id == 0 || curl_handle->prepared_id != global_prepared.id ||
+      global_prepared.idle_handles_count == HTTP_CURL_MAX_IDLE_HANDLES)
+  {
+    http_curl_destroy(curl_handle);
+    return;
+  }
+
+  http_curl_free_req_headers(curl_handle);
+
+  if (curl_handle->content.data != NULL)
+  {
+    free(curl_handle->content.data);
+    curl_handle->content.data = NULL;
+  }
+
+  curl_handle->content.len = 0;
+  curl_handle->content.cap = 0;
+
+  http_curl_header_buf_reset(&curl_handle->resp_headers);
+
+  global_prepared.idle_handles[global_prepared.idle_handles_count++] = curl_handle;
+}
+
+
 /**
  * @brief This method initializes data structures for CURL http operation
+ * @param prepared_id of http req. An idle handle set up for this prepared request is reused if available
  * @return curl_handle_t contains context of http curl request
  */
-static curl_handle_t* http_curl_init(void)
+static curl_handle_t* http_curl_init(int prepared_id)
 {
+  if (prepared_id != 0 && prepared_id == global_prepared.id && global_prepared.idle_handles_count > 0)
+  {
+    return global_prepared.idle_handles[--global_prepared.idle_handles_count];
+  }
+
   curl_handle_t* curl_handle = (curl_handle_t*)calloc(1, sizeof(curl_handle_t));
 
   if (curl_handle == NULL)
@@ -89,7 +172,6 @@ static curl_handle_t* http_curl_init(void)
   }
 
   curl_handle->req_headers = NULL;
-  curl_handle->resp_headers = NULL;
   curl_handle->content.data = NULL;
 
   /* init curl handle */
@@ -97,7 +179,7 @@ static curl_handle_t* http_curl_init(void)
   {
     /* log error */
     fprintf(stderr, "Failed to init curl handle\n");
-    http_curl_deinit(curl_handle);
+    http_curl_destroy(curl_handle);
     curl_handle = NULL;
     return NULL;
   }
@@ -105,233 +187,218 @@ static curl_handle_t* http_curl_init(void)
   return curl_handle;
 }
 
+
 /**
- * @brief This is a callback method triggered upon receiving http response to read resp content
- * @param src_content contains response content
- * @param size contains size of one memory block
- * @param nmemb contains number of memory blocks
- * @param dest_content destination to which response content will be written to
- * @return size_t returns the size of the response content
+ * @brief Encodes http request header in key:value format and appends it to list
+ * @param header contains http request header
+ * @param list to which encoded header is appended to
+ * @return true on success, false if header is not valid or memory allocation fails
  */
-static size_t http_curl_resp_content_cb(void* src_content, size_t size, size_t nmemb, content_t* dest_content)
+static bool http_curl_append_req_header(const appd_iot_data_t* header, struct curl_slist** list)
 {
-  size_t new_len = dest_content->len + size * nmemb;
-  char* tmp = (char*)realloc(dest_content->data, new_len + 1);
-
-  if (tmp == NULL)
+  if (header->key == NULL || header->strval == NULL || header->value_type != APPD_IOT_STRING)
   {
-    fprintf(stderr, "realloc() failed\n");
+    fprintf(stderr, "Http Request Headers Not Valid\n");
+    return false;
+  }
 
-    dest_content->len = 0;
-    free(dest_content->data);
-    dest_content->data = NULL;
+  size_t header_len = strlen(header->key) + strlen(header->strval);
+  //+1 for ':' and +1 for terminating char
+  char buf[header_len + 2];
+  snprintf(buf, sizeof(buf), "%s:%s", header->key, header->strval);
+  buf[header_len + 1] = '\0';
 
-    return 0;
+  struct curl_slist* tmp = curl_slist_append(*list, buf);
+
+  if (tmp == NULL)
+  {
+    return false;
   }
 
-  dest_content->data = tmp;
-  memcpy(dest_content->data + dest_content->len, src_content, size * nmemb);
-  dest_content->data[new_len] = '\0';
-  dest_content->len = new_len;
+  *list = tmp;
 
-  return size * nmemb;
+  return true;
 }
 
 
 /**
- * @brief This is a callback method triggered upon receiving http response <br>
- * to read response headers. It is invoked for each response header.
- * @param src_header contains response header which is to be copied
- * @param size contains size of one memory block
- * @param nmemb contains number of memory blocks
- * @param dest_headers destination to which response headers will be copied to
- * @return size_t returns the size of the response headers
+ * @brief Discards state of previous prepared request, destroying idle handles set up for it.
+ * Parsed url is kept to be reused for the next prepared request.
  */
-static size_t http_curl_resp_headers_cb
-(void* src_header, size_t size, size_t nmemb, void* dest_headers)
+static void http_curl_discard_prepared(void)
 {
-  size_t realsize = size * nmemb; /* calculate buffer size */
-
-  //src_header is not guaranteed to be null terminated. so copy src_headers into local buf
-  char buf[realsize + 1];
-  snprintf(buf, sizeof(buf), "%s", (char*)src_header);
-  buf[realsize] = '\0';
+  global_prepared.id = 0;
 
-  struct curl_slist** h = (struct curl_slist**)dest_headers;  /* cast pointer to slist struct */
-
-  *h = curl_slist_append(*h, buf);
-
-  if (*h == NULL)
+  while (global_prepared.idle_handles_count > 0)
   {
-    return 0;
+    http_curl_destroy(global_prepared.idle_handles[--global_prepared.idle_handles_count]);
   }
 
-  /* return size */
-  return realsize;
+  if (global_prepared.static_headers != NULL)
+  {
+    curl_slist_free_all(global_prepared.static_headers);
+    global_prepared.static_headers = NULL;
+  }
 }
 
 
 /**
- * @brief reads and converts response headers into key value pairs
- * @param src_headers response headers in string format
- * @param dest_headers structure into which response headers are populated as a map of key-value pairs
- * @return number of headers parsed
+ * @brief Get state derived from prepared request, building it when prepared id changes. <br>
+ * Url is parsed and static headers are encoded once per prepared id.
+ * @param http_req contains http req details
+ * @return prepared request state, NULL if request is not prepared or state could not be built
  */
-static int http_curl_parse_resp_headers
-(struct curl_slist* src_headers, appd_iot_data_t** dest_headers)
+static http_curl_prepared_t* http_curl_get_prepared(const appd_iot_http_req_t* http_req)
 {
-  const char eol[] = "\r\n";
-  const char headerdelimiter = ':';
-  char* header = NULL;
-  int header_index = 0;
-  int num_resp_headers = 0;
-
-  struct curl_slist* iter = src_headers;
+  if (http_req->prepared_id == 0)
+  {
+    return NULL;
+  }
 
-  /* Count number of headers which are in Key:Value format */
-  while (iter != NULL)
+  if (global_prepared.id == http_req->prepared_id)
   {
-    char* data = iter->data;
+    return &global_prepared;
+  }
 
-    if (strchr(data, headerdelimiter) != NULL)
-    {
-      num_resp_headers++;
-    }
+  http_curl_discard_prepared();
 
-    iter = iter->next;
+  if (global_prepared.url == NULL && (global_prepared.url = curl_url()) == NULL)
+  {
+    return NULL;
   }
 
-  if (num_resp_headers == 0)
+  if (curl_url_set(global_prepared.url, CURLUPART_URL, http_req->url, 0) != CURLUE_OK)
   {
-    fprintf(stderr, "No response headers present in key:value format\n");
-    return num_resp_headers;
+    fprintf(stderr, "Failed to parse url:%s\n", http_req->url);
+    return NULL;
   }
 
-  fprintf(stdout, "Http Response Headers: %d\n", num_resp_headers);
-
-
-  appd_iot_data_t* dest_resp_headers = (appd_iot_data_t*)calloc(num_resp_headers, sizeof(appd_iot_data_t));
+  int static_headers_count = http_req->static_headers_count;
 
-  if (dest_resp_headers == NULL)
+  if (static_headers_count > http_req->headers_count)
   {
-    fprintf(stderr, "Failed to allocate memory for resp headers\n");
-    return 0;
+    static_headers_count = http_req->headers_count;
   }
 
-  /* Parse each response header in key:value format and split them into key and value */
-  iter = src_headers;
-
-  while (iter != NULL)
+  for (int i = 0; i < static_headers_count; i++)
   {
-    if (iter->data == NULL)
+    if (!http_curl_append_req_header(&http_req->headers[i], &global_prepared.static_headers))
     {
-      iter = iter->next;
-      continue;
+      curl_slist_free_all(global_prepared.static_headers);
+      global_prepared.static_headers = NULL;
+      return NULL;
     }
 
-    //copy header data into local buffer
-    size_t data_len = strlen(iter->data);
-    char buf[data_len + 1];
-    char* buf_ptr = buf;
+    fprintf(stdout, "Http Prepared Request Header:%d %s\n", i, http_req->headers[i].key);
+  }
 
-    snprintf(buf, sizeof(buf), "%s", iter->data);
-    buf[data_len] = '\0';
+  global_prepared.id = http_req->prepared_id;
 
-    /* split header using EOL delimiter */
-    header = strsep (&buf_ptr, eol);
+  return &global_prepared;
+}
 
-    if (header == NULL)
-    {
-      iter = iter->next;
-      continue;
-    }
+/**
+ * @brief Grows response content buffer to hold at least min_cap bytes. <br>
+ * On first allocation the buffer is sized from Content-Length if the server sent it, up to
+ * HTTP_CURL_CONTENT_MAX_INITIAL_CAP so that a bogus length cannot force a large allocation,
+ * otherwise the buffer grows geometrically.
+ * @param curl_handle contains response content buffer
+ * @param min_cap contains minimum number of bytes required, including terminating char
+ * @return true on success, false on failure to allocate memory
+ */
+static bool http_curl_reserve_content(curl_handle_t* curl_handle, size_t min_cap)
+{
+  content_t* content = &curl_handle->content;
 
-    if (header[0] == '\0')
-    {
-      iter = iter->next;
-      continue;
-    }
+  if (min_cap <= content->cap)
+  {
+    return true;
+  }
 
-    size_t header_len = strlen(header);
+  size_t new_cap = content->cap * 2;
 
-    /* split header using : delimiter to parse key:value pair */
-    char* pch = strchr(header, headerdelimiter);
+  if (content->cap == 0)
+  {
+    curl_off_t content_length = -1;
 
-    if (pch != NULL)
-    {
-      /* Read Key */
-      size_t key_length = (int)(pch - header);
-      char* key = (char*)calloc(1, key_length + 1);
+    curl_easy_getinfo(curl_handle->ch, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &content_length);
 
-      if (key == NULL)
-      {
-        iter = iter->next;
-        continue;
-      }
+    new_cap = HTTP_CURL_CONTENT_MIN_CAP;
 
-      strncpy(key, header, key_length);
-      key[key_length] = '\0';
+    if (content_length > 0)
+    {
+      new_cap = (content_length < HTTP_CURL_CONTENT_MAX_INITIAL_CAP) ?
+                (size_t)content_length + 1 : HTTP_CURL_CONTENT_MAX_INITIAL_CAP;
+    }
+  }
 
-      /* Read Value */
-      size_t value_length;
+  if (new_cap < min_cap)
+  {
+    new_cap = min_cap;
+  }
 
-      //-1 to header_len to skip last char if it's a new line.
-      //+1 to key_length to skip delimiter ':'
-      if (header[header_len - 1] == '\r' || header[header_len - 1] == '\n')
-      {
-        value_length = (header_len - 1) - (key_length + 1);
-      }
-      else
-      {
-        value_length = header_len - (key_length + 1);
-      }
+  char* tmp = (char*)realloc(content->data, new_cap);
 
-      char* value = (char*)calloc(1, value_length + 1);
+  if (tmp == NULL)
+  {
+    return false;
+  }
 
-      if (value == NULL)
-      {
-        iter = iter->next;
-        free(key);
-        continue;
-      }
+  content->data = tmp;
+  content->cap = new_cap;
 
-      strncpy(value, pch + 1, value_length);
-      value[value_length] = '\0';
+  return true;
+}
 
-      /* Add Key, Value Pair to Response Header */
-      appd_iot_data_set_string(&dest_resp_headers[header_index], key, value);
 
-      fprintf(stdout, "Http Response Header:%d (%s:%s)\n", header_index, dest_resp_headers[header_index].key,
-              dest_resp_headers[header_index].strval);
+/**
+ * @brief This is a callback method triggered upon receiving http response to read resp content
+ * @param src_content contains response content
+ * @param size contains size of one memory block
+ * @param nmemb contains number of memory blocks
+ * @param curl_handle contains buffer to which response content will be written to
+ * @return size_t returns the size of the response content
+ */
+static size_t http_curl_resp_content_cb(void* src_content, size_t size, size_t nmemb, curl_handle_t* curl_handle)
+{
+  content_t* dest_content = &curl_handle->content;
+  size_t new_len = dest_content->len + size * nmemb;
 
-      header_index++;
-    }
+  if (!http_curl_reserve_content(curl_handle, new_len + 1))
+  {
+    fprintf(stderr, "realloc() failed\n");
 
-    iter = iter->next;
+    dest_content->len = 0;
+    dest_content->cap = 0;
+    free(dest_content->data);
+    dest_content->data = NULL;
+
+    return 0;
   }
 
-  //realloc if there is a mismatch in number of headers present vs parsed successfully
-  if (header_index != num_resp_headers)
-  {
-    appd_iot_data_t* temp = (appd_iot_data_t*)realloc(dest_resp_headers,
-                            header_index * sizeof(appd_iot_data_t));
+  memcpy(dest_content->data + dest_content->len, src_content, size * nmemb);
+  dest_content->data[new_len] = '\0';
+  dest_content->len = new_len;
 
-    if (temp == NULL)
-    {
-      free(dest_resp_headers);
-      dest_resp_headers = NULL;
-      num_resp_headers = 0;
-    }
-    else
-    {
-      dest_resp_headers = temp;
-      num_resp_headers = header_index;
-    }
-  }
+  return size * nmemb;
+}
 
-  (*dest_headers) = dest_resp_headers;
 
-  return num_resp_headers;
+/**
+ * @brief This is a callback method triggered upon receiving http response <br>
+ * to read response headers. It is invoked for each response header.
+ * @param src_header contains response header which is to be copied
+ * @param size contains size of one memory block
+ * @param nmemb contains number of memory blocks
+ * @param dest_headers header buffer to which response headers will be copied to
+ * @return size_t returns the size of the response headers
+ */
+static size_t http_curl_resp_headers_cb
+(void* src_header, size_t size, size_t nmemb, void* dest_headers)
+{
+  /* src_header is not null terminated. It is appended as is and parsed once response is complete */
+  return http_curl_header_buf_append((http_curl_header_buf_t*)dest_headers, (const char*)src_header,
+                                     size * nmemb);
 }
 
 
@@ -349,17 +416,30 @@ static appd_iot_error_code_t http_curl_fill_response
     return APPD_IOT_ERR_NULL_PTR;
   }
 
-  struct curl_slist* resp_headers = curl_handle->resp_headers;
-
   curl_easy_getinfo (curl_handle->ch, CURLINFO_RESPONSE_CODE, &(http_resp->resp_code));
 
   fprintf(stdout, "Http Response Code:%d\n",  http_resp->resp_code);
 
   /* check resp headers for null */
-  if (resp_headers != NULL)
+  if (curl_handle->resp_headers.len != 0)
   {
-    /* parse resp headers */
-    http_resp->headers_count = http_curl_parse_resp_headers(resp_headers, &(http_resp->headers));
+    /* parse resp headers in place, headers are freed along with curl handle */
+    http_resp->headers_count = http_curl_header_buf_parse(&curl_handle->resp_headers, &(http_resp->headers));
+
+    if (http_resp->headers_count == 0)
+    {
+      fprintf(stderr, "No response headers present in key:value format\n");
+    }
+    else
+    {
+      fprintf(stdout, "Http Response Headers: %d\n", http_resp->headers_count);
+    }
+
+    for (int i = 0; i < http_resp->headers_count; i++)
+    {
+      fprintf(stdout, "Http Response Header:%d (%s:%s)\n", i, http_resp->headers[i].key,
+              http_resp->headers[i].strval);
+    }
   }
   else
   {
@@ -368,21 +448,15 @@ static appd_iot_error_code_t http_curl_fill_response
     return APPD_IOT_ERR_NULL_PTR;
   }
 
+  /* hand over content buffer to http_resp, it is freed in http resp done callback */
   if (curl_handle->content.len != 0)
   {
-    http_resp->content = (char*)calloc(1, curl_handle->content.len + 1);
+    http_resp->content = curl_handle->content.data;
+    http_resp->content_len = curl_handle->content.len;
 
-    if (http_resp->content != NULL)
-    {
-      memcpy((void*)http_resp->content, curl_handle->content.data, curl_handle->content.len);
-      http_resp->content_len = curl_handle->content.len;
-    }
-    else
-    {
-      fprintf(stderr, "failed to allocate memory to read content\n");
-      http_resp->content = NULL;
-      http_resp->content_len = 0;
-    }
+    curl_handle->content.data = NULL;
+    curl_handle->content.len = 0;
+    curl_handle->content.cap = 0;
   }
 
   return APPD_IOT_SUCCESS;
@@ -397,40 +471,55 @@ static appd_iot_error_code_t http_curl_fill_response
 static appd_iot_error_code_t http_curl_set_options
 (curl_handle_t* curl_handle, const appd_iot_http_req_t* http_req)
 {
-  /* set request headers */
-  for (int i = 0; i < http_req->headers_count; i++)
+  http_curl_prepared_t* prepared = http_curl_get_prepared(http_req);
+  int first_header = (prepared != NULL) ? http_req->static_headers_count : 0;
+
+  /* set request headers, static headers of prepared request are already encoded */
+  for (int i = first_header; i < http_req->headers_count; i++)
   {
-    if ((http_req->headers + i) == NULL)
+    if (http_curl_append_req_header(&http_req->headers[i], &curl_handle->req_headers))
     {
-      continue;
+      fprintf(stdout, "Http Request Header:%d %s\n", i, http_req->headers[i].key);
     }
+  }
 
-    if (http_req->headers[i].key == NULL || http_req->headers[i].strval == NULL ||
-        http_req->headers[i].value_type != APPD_IOT_STRING)
-    {
-      fprintf(stderr, "Http Request Headers Not Valid\n");
-      continue;
-    }
+  CURL* ch = curl_handle->ch;
+  struct curl_slist* req_headers = curl_handle->req_headers;
 
-    size_t header_len = strlen(http_req->headers[i].key) + strlen(http_req->headers[i].strval);
-    //+1 for ':' and +1 for terminating char
-    char header[header_len + 2];
-    snprintf(header, sizeof(header), "%s:%s", http_req->headers[i].key, http_req->headers[i].strval);
-    header[header_len + 1] = '\0';
+  if (prepared != NULL)
+  {
+    curl_handle->prepared_id = prepared->id;
 
-    fprintf(stdout, "Http Request Header:%d %s\n", i, header);
-    curl_handle->req_headers = curl_slist_append(curl_handle->req_headers, header);
-  }
+    /* link static headers after request headers, without copying them */
+    if (req_headers != NULL)
+    {
+      curl_handle->req_headers_tail = req_headers;
 
-  CURL* ch = curl_handle->ch;
+      while (curl_handle->req_headers_tail->next != NULL)
+      {
+        curl_handle->req_headers_tail = curl_handle->req_headers_tail->next;
+      }
+
+      curl_handle->req_headers_tail->next = prepared->static_headers;
+    }
+    else
+    {
+      req_headers = prepared->static_headers;
+    }
 
-  /* set url to fetch */
-  curl_easy_setopt(ch, CURLOPT_URL, http_req->url);
+    /* set parsed url to fetch */
+    curl_easy_setopt(ch, CURLOPT_CURLU, prepared->url);
+  }
+  else
+  {
+    /* set url to fetch */
+    curl_easy_setopt(ch, CURLOPT_URL, http_req->url);
+  }
 
   /* set calback function */
   curl_easy_setopt(ch, CURLOPT_HEADERFUNCTION, http_curl_resp_headers_cb);
 
-  /* pass fetch struct pointer */
+  /* pass header buffer pointer */
   curl_easy_setopt(ch, CURLOPT_HEADERDATA, (void*) & (curl_handle->resp_headers));
 
   /* set default user agent */
@@ -446,7 +535,7 @@ static appd_iot_error_code_t http_curl_set_options
   curl_easy_setopt(ch, CURLOPT_MAXREDIRS, 1);
 
   /* set request headers */
-  curl_easy_setopt(ch, CURLOPT_HTTPHEADER, curl_handle->req_headers);
+  curl_easy_setopt(ch, CURLOPT_HTTPHEADER, req_headers);
 
   /* set request type */
   curl_easy_setopt(ch, CURLOPT_CUSTOMREQUEST, http_req->type);
@@ -459,13 +548,15 @@ static appd_iot_error_code_t http_curl_set_options
 
   curl_handle->content.len = 0;
 
+  curl_handle->content.cap = 0;
+
   curl_handle->content.data = NULL;
 
   /* set callback function */
   curl_easy_setopt(ch, CURLOPT_WRITEFUNCTION, http_curl_resp_content_cb);
 
-  /* pass fetch struct pointer */
-  curl_easy_setopt(ch, CURLOPT_WRITEDATA, &(curl_handle->content));
+  /* pass curl handle holding content buffer */
+  curl_easy_setopt(ch, CURLOPT_WRITEDATA, curl_handle);
 
   return APPD_IOT_SUCCESS;
 
@@ -480,7 +571,7 @@ static appd_iot_error_code_t http_curl_set_options
 appd_iot_http_resp_t* http_curl_req_send_cb(const appd_iot_http_req_t* http_req)
 {
   /* Initialize curl and set req parameters */
-  curl_handle_t* curl_handle = http_curl_init();
+  curl_handle_t* curl_handle = http_curl_init(http_req->prepared_id);
 
   if (curl_handle == NULL)
   {
@@ -531,6 +622,149 @@ appd_iot_http_resp_t* http_curl_req_send_cb(const appd_iot_http_req_t* http_req)
 }
 
 
+/**
+ * @brief Http Req Send Batch Callback function which uses curl multi API to send http reqs <br>
+ * concurrently. Requests to the same host are multiplexed over a single HTTP/2 connection
+ * when the server supports it, otherwise they are sent over parallel keep-alive connections.
+ * Multi handle is kept across calls so that connections are reused between batches, until
+ * http_curl_cleanup() is called.
+ * @param http_reqs contains array of http req details
+ * @param http_resps array to which http_resp of each http req is written to, in the same order
+ * @param http_req_count contains number of http reqs
+ */
+void http_curl_req_send_batch_cb(const appd_iot_http_req_t* http_reqs, appd_iot_http_resp_t** http_resps,
+                                 int http_req_count)
+{
+  if (global_multi_handle == NULL)
+  {
+    if ((global_multi_handle = curl_multi_init()) == NULL)
+    {
+      fprintf(stderr, "Failed to init curl multi handle\n");
+      return;
+    }
+
+    curl_multi_setopt(global_multi_handle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+  }
+
+  CURLM* multi_handle = global_multi_handle;
+
+  /* Initialize curl and set req parameters for each request */
+  for (int i = 0; i < http_req_count; i++)
+  {
+    http_resps[i] = NULL;
+
+    curl_handle_t* curl_handle = http_curl_init(http_reqs[i].prepared_id);
+
+    if (curl_handle == NULL)
+    {
+      continue;
+    }
+
+    appd_iot_http_resp_t* http_resp = (appd_iot_http_resp_t*)calloc(1, sizeof(appd_iot_http_resp_t));
+
+    if (http_resp == NULL)
+    {
+      http_curl_deinit(curl_handle);
+      continue;
+    }
+
+    http_resp->user_data = (void*)(curl_handle);
+    http_resps[i] = http_resp;
+
+    http_resp->error = http_curl_set_options(curl_handle, &http_reqs[i]);
+
+    if (http_resp->error != APPD_IOT_SUCCESS)
+    {
+      continue;
+    }
+
+    /* prefer multiplexing on an existing connection over opening a new one */
+    curl_easy_setopt(curl_handle->ch, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(curl_handle->ch, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(curl_handle->ch, CURLOPT_PRIVATE, (void*)http_resp);
+
+    if (curl_multi_add_handle(multi_handle, curl_handle->ch) != CURLM_OK)
+    {
+      http_resp->error = APPD_IOT_ERR_NETWORK_ERROR;
+    }
+  }
+
+  /* fetch urls */
+  int still_running = 0;
+
+  do
+  {
+    CURLMcode mcode = curl_multi_perform(multi_handle, &still_running);
+
+    if (mcode == CURLM_OK && still_running)
+    {
+      mcode = curl_multi_wait(multi_handle, NULL, 0, 1000, NULL);
+    }
+
+    if (mcode != CURLM_OK)
+    {
+      fprintf(stderr, "curl multi failed: %s\n", curl_multi_strerror(mcode));
+      break;
+    }
+  }
+  while (still_running);
+
+  /* read response of each completed request */
+  CURLMsg* msg = NULL;
+  int msgs_left = 0;
+
+  while ((msg = curl_multi_info_read(multi_handle, &msgs_left)) != NULL)
+  {
+    if (msg->msg != CURLMSG_DONE)
+    {
+      continue;
+    }
+
+    appd_iot_http_resp_t* http_resp = NULL;
+
+    curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&http_resp);
+
+    if (http_resp == NULL)
+    {
+      continue;
+    }
+
+    curl_handle_t* curl_handle = (curl_handle_t*)http_resp->user_data;
+
+    if (msg->data.result == CURLE_OK)
+    {
+      http_resp->error = http_curl_fill_response(curl_handle, http_resp);
+    }
+    else
+    {
+      char* url = NULL;
+
+      curl_easy_getinfo(msg->easy_handle, CURLINFO_EFFECTIVE_URL, &url);
+
+      /* log error */
+      fprintf(stderr, "Failed to fetch url (%s) - curl said: %s\n", url, curl_easy_strerror(msg->data.result));
+
+      http_resp->error = APPD_IOT_ERR_NETWORK_UNREACHABLE;
+    }
+  }
+
+  /* detach easy handles so that they can be cleaned up in http resp done callback */
+  for (int i = 0; i < http_req_count; i++)
+  {
+    if (http_resps[i] != NULL && http_resps[i]->error == APPD_IOT_SUCCESS && http_resps[i]->resp_code == 0)
+    {
+      /* request did not complete */
+      http_resps[i]->error = APPD_IOT_ERR_NETWORK_UNREACHABLE;
+    }
+
+    if (http_resps[i] != NULL && http_resps[i]->user_data != NULL)
+    {
+      curl_multi_remove_handle(multi_handle, ((curl_handle_t*)http_resps[i]->user_data)->ch);
+    }
+  }
+}
+
+
 /**
  * @brief http response done callback. <br>
  * This callback is used to clean up any memory allocated while executing http req. <br>
@@ -545,32 +779,12 @@ void http_curl_resp_done_cb(appd_iot_http_resp_t* http_resp)
     return;
   }
 
+  /* response headers point into header buffer of curl handle and are freed along with it */
   if (http_resp->user_data != NULL)
   {
     http_curl_deinit(( curl_handle_t*)http_resp->user_data);
   }
 
-  for (int i = 0; i < http_resp->headers_count; i++)
-  {
-    if ((http_resp->headers + i) != NULL)
-    {
-      if (http_resp->headers[i].key != NULL)
-      {
-        free((void*)http_resp->headers[i].key);
-      }
-
-      if (http_resp->headers[i].value_type == APPD_IOT_STRING && http_resp->headers[i].strval != NULL)
-      {
-        free((void*)http_resp->headers[i].strval);
-      }
-    }
-  }
-
-  if (http_resp->headers != NULL)
-  {
-    free(http_resp->headers);
-  }
-
   if (http_resp->content != NULL)
   {
     free((void*)http_resp->content);
@@ -580,3 +794,25 @@ void http_curl_resp_done_cb(appd_iot_http_resp_t* http_resp)
 
   return;
 }
+
+
+/**
+ * @brief Releases curl handles and connections kept for reuse across requests: idle handles,
+ * prepared request state and the multi handle of batch sends.
+ */
+void http_curl_cleanup(void)
+{
+  http_curl_discard_prepared();
+
+  if (global_prepared.url != NULL)
+  {
+    curl_url_cleanup(global_prepared.url);
+    global_prepared.url = NULL;
+  }
+
+  if (global_multi_handle != NULL)
+  {
+    curl_multi_cleanup(global_multi_handle);
+    global_multi_handle = NULL;
+  }
+}
@@ -27,6 +27,16 @@
  */
 appd_iot_http_resp_t* http_curl_req_send_cb(const appd_iot_http_req_t* http_req);
 
+/**
+ * @brief Http Req Send Batch Callback function which uses curl multi API to send http reqs <br>
+ * concurrently, multiplexing them over a single connection when the server supports HTTP/2.
+ * @param http_reqs contains array of http req details
+ * @param http_resps array to which http_resp of each http req is written to, in the same order
+ * @param http_req_count contains number of http reqs
+ */
+void http_curl_req_send_batch_cb(const appd_iot_http_req_t* http_reqs, appd_iot_http_resp_t** http_resps,
+                                 int http_req_count);
+
 /**
  * @brief Http Response Done Callback. <br>
  * This callback is used to clean up any memory allocated while executing http req. <br>
@@ -35,4 +45,10 @@ appd_iot_http_resp_t* http_curl_req_send_cb(const appd_iot_http_req_t* http_req)
  */
 void http_curl_resp_done_cb(appd_iot_http_resp_t* http_resp);
 
+/**
+ * @brief Releases curl handles and connections kept for reuse across requests. <br>
+ * Call when no more requests are sent, before curl_global_cleanup().
+ */
+void http_curl_cleanup(void);
+
 #endif //_HTTP_CURL_INTERFACE_HPP_
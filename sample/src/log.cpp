@@ -28,6 +28,7 @@
 #include <sys/time.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <appd_iot_interface.h>
 #include "log.hpp"
 
 static int global_fd = -1;
@@ -88,18 +89,10 @@ void log_write_cb(const char* logmsg, size_t logmsg_len)
   char timestamp[32];
   char eol = '\n';
 
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
+  /* Cached decimal rendering of coarse clock, avoids gettimeofday and snprintf per log line */
+  size_t timestamp_len = appd_iot_get_time_ms_str(timestamp, sizeof(timestamp) - 1);
 
-  int64_t time_in_ms = (int64_t)tv.tv_sec * 1000 + (int64_t)tv.tv_usec / 1000;
-  size_t timestamp_len = snprintf(timestamp, sizeof(timestamp), "%" PRId64 " ", time_in_ms);
-
-  /* Adjust timestamp_len if number of bytes available to write exceeds size of timestamp buffer */
-  if (timestamp_len >= sizeof(timestamp))
-  {
-    timestamp_len = sizeof(timestamp) - 1;
-    timestamp[timestamp_len] = '\0';
-  }
+  timestamp[timestamp_len++] = ' ';
 
   iov[0].iov_base = (void*)timestamp;
   iov[0].iov_len = timestamp_len;
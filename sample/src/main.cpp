@@ -112,6 +112,19 @@ int main(int argc, char* argv[])
     return 1;
   }
 
+  //register pipelined http interface used to drain events left in memory
+  appd_iot_http_pipeline_cb_t http_pipeline_cb;
+  http_pipeline_cb.http_req_send_batch_cb = &http_curl_req_send_batch_cb;
+  http_pipeline_cb.http_resp_done_cb = &http_curl_resp_done_cb;
+  http_pipeline_cb.max_requests_in_flight = 4;
+
+  errcode = appd_iot_register_network_pipeline_interface(http_pipeline_cb);
+
+  if (errcode != APPD_IOT_SUCCESS)
+  {
+    fprintf(stderr, "Error Registering for network pipeline interface:%d\n", errcode);
+  }
+
   event_type event = get_event_type();
 
   //Step3: send events
@@ -144,6 +157,15 @@ int main(int argc, char* argv[])
     send_error_event_fatal();
   }
 
+  //Step4: drain any events left in memory (e.g. after a failed send) as beacons of
+  //at most 100 events each, with up to 4 beacons in flight
+  errcode = appd_iot_drain_all_events(100);
+
+  if (errcode != APPD_IOT_SUCCESS)
+  {
+    fprintf(stderr, "Error Draining events:%d\n", errcode);
+  }
+
   /**
    * It is recommended to move below functionality into a separate thread
    * or use asynchronous timers instead of sleep. Below code is provided for reference to
@@ -171,6 +193,7 @@ int main(int argc, char* argv[])
     }
   }
 
+  http_curl_cleanup();
   free_options();
   close_log();
 
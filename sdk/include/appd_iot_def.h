@@ -121,12 +121,70 @@ typedef enum
 } appd_iot_log_level_t;
 
 
+/**
+ * @brief Log Subsystem Enums, each of which can be given its own log level
+ */
+typedef enum
+{
+  /*! Device config and events stored in beacon */
+  APPD_IOT_LOG_SUBSYSTEM_BEACON,
+  /*! Serializing beacons to json */
+  APPD_IOT_LOG_SUBSYSTEM_SERIALIZER,
+  /*! Sending beacons and app status requests to collector */
+  APPD_IOT_LOG_SUBSYSTEM_TRANSPORT,
+  /*! SDK initialization, interface registration and sdk state */
+  APPD_IOT_LOG_SUBSYSTEM_CONFIG,
+  /*! Custom, network request and error events and their data */
+  APPD_IOT_LOG_SUBSYSTEM_EVENTS,
+  /*! Max Log Subsystems */
+  APPD_IOT_MAX_LOG_SUBSYSTEMS
+} appd_iot_log_subsystem_t;
+
+
+/**
+ * @brief Log Mode Enums to select how log messages are written
+ */
+typedef enum
+{
+  /*! Log messages are written on the calling thread, this is default */
+  APPD_IOT_LOG_MODE_SYNC,
+  /*! Log messages are queued in a per-thread lock-free ring on the calling thread and written by
+   *  a background thread. Calling thread never blocks on log writes. Messages are dropped if the
+   *  ring is full, and the number of dropped messages is logged. */
+  APPD_IOT_LOG_MODE_ASYNC,
+  /*! As APPD_IOT_LOG_MODE_ASYNC, but the calling thread queues the format string id and raw arguments
+   *  instead of the formatted message. Messages are formatted by the background thread, or written
+   *  as is to log_binary_file and formatted offline with appd_iot_log_decoder tool. Format strings
+   *  are identified by their address and must be string literals. */
+  APPD_IOT_LOG_MODE_BINARY,
+  /*! Max Log Modes */
+  APPD_IOT_MAX_LOG_MODES
+} appd_iot_log_mode_t;
+
+
+/**
+ * @brief Log Format Enums to select how log messages are rendered
+ */
+typedef enum
+{
+  /*! Log message is prefixed with log header "E/APPDYNAMICS: ", this is default */
+  APPD_IOT_LOG_FORMAT_TEXT,
+  /*! Log message is a single line JSON object with fields ts (epoch time in milliseconds),
+   *  level, subsystem and message, so that written log is newline delimited JSON. Messages about
+   *  an event type, http response code or error code also carry event_type, resp_code or error_code */
+  APPD_IOT_LOG_FORMAT_JSON,
+  /*! Max Log Formats */
+  APPD_IOT_MAX_LOG_FORMATS
+} appd_iot_log_format_t;
+
+
 /**
  * @brief Log Write Callback implements the functionality to process log messages <br>
  * The callback implementation reads log message and writes it to disk or prints to std terminal
  * @param logmsg contains log message. Newline is not appended to the log message. <br>
  * Each logmsg is appended with a tag "E/APPDYNAMICS:". <br>
  * First Letter in the tag indicates log level as given in appd_iot_log_level_t. <br>
+ * In APPD_IOT_LOG_FORMAT_JSON, logmsg is a JSON object which already includes timestamp. <br>
  * logmsg not to be freed in the log write callback. It is freed by the caller of log write cb.
  * @param logmsg_len contains the length of log message
  */
@@ -162,6 +220,47 @@ typedef struct
   appd_iot_log_write_cb_t log_write_cb;
   /*! Callback function triggered whenever sdk state changes. SDK states are given in appd_iot_sdk_state_t */
   appd_iot_sdk_state_change_cb_t sdk_state_change_cb;
+  /*! Set Log Mode. Defaults to APPD_IOT_LOG_MODE_SYNC when set to 0. In APPD_IOT_LOG_MODE_ASYNC,
+   *  log write callback is triggered from a background thread */
+  appd_iot_log_mode_t log_mode;
+  /*! Path of file to which log records are written without formatting in APPD_IOT_LOG_MODE_BINARY.
+   *  File is appended to if it exists. If NULL, log messages are formatted by the background thread
+   *  and log write callback is triggered */
+  const char* log_binary_file;
+  /*! Log Level per subsystem, indexed by appd_iot_log_subsystem_t. Subsystems set to
+   *  APPD_IOT_LOG_OFF (0) use log_level */
+  appd_iot_log_level_t subsystem_log_level[APPD_IOT_MAX_LOG_SUBSYSTEMS];
+  /*! Maximum number of messages per second logged by a single log statement, with bursts of up to
+   *  the same number. Messages over the limit are dropped and reported as "Suppressed N Similar Log
+   *  Messages" with the next message logged by that statement. 0 for no limit, max 1000 */
+  int log_rate_limit;
+  /*! Path of file to which log messages are written instead of stderr, when log write callback is NULL.
+   *  Messages are buffered and written by a background thread when the buffer is half full, right after
+   *  an ERROR message and at least once a second. File is appended to if it exists. */
+  const char* log_file;
+  /*! Size in KB at which log_file is rotated to log_file.1, log_file.1 to log_file.2 and so on.
+   *  Defaults to 1024 KB when set to 0 */
+  int log_file_max_size_kb;
+  /*! Number of rotated log files kept, the oldest one is removed on rotation. Defaults to 3 when set
+   *  to 0, max 16 */
+  int log_file_max_count;
+  /*! Set Log Format. Defaults to APPD_IOT_LOG_FORMAT_TEXT when set to 0. In APPD_IOT_LOG_FORMAT_JSON,
+   *  log lines written to stderr or log_file are not prefixed with timestamp, and log messages are
+   *  formatted on the calling thread in APPD_IOT_LOG_MODE_BINARY */
+  appd_iot_log_format_t log_format;
+  /*! If true, time in microseconds spent in each phase of a successful send is added as a custom event
+   *  of type "AppDynamicsSDKSendTiming" to the next send which has other events. Sends with no events
+   *  queued do not send timing, so an idle device stays idle */
+  bool send_timing_events;
+  /*! If greater than 0, a custom event of type "AppDynamicsSDKHealth" is added when events are sent,
+   *  at most once per interval, and is sent with them. It reports number of events in SDK buffer per
+   *  event type, estimated memory used by them, and dropped events, bytes sent, send failures and
+   *  average serialize time since process start. Set to 0 to disable */
+  int health_event_interval_ms;
+  /*! If true, each event is serialized to JSON when it is added, and only its JSON is kept in memory.
+   *  Serialization cost is spread over event adds, and sending events only joins events already
+   *  serialized instead of serializing all of them at once. Events added before it was set are sent as is */
+  bool serialize_on_add;
 } appd_iot_sdk_config_t;
 
 
@@ -227,7 +326,7 @@ typedef struct
 
 /**
  * @brief AppDynamics Custom Event <br>
- * Mandatory: type, summary and timestamp_ms Fields
+ * Mandatory: type and summary Fields. timestamp_ms set to 0 is replaced by the time event is added
  */
 typedef struct
 {
@@ -235,7 +334,7 @@ typedef struct
   const char* type;
   /*! Summary of the event */
   const char* summary;
-  /*! Epoch Timestamp in milliseconds */
+  /*! Epoch Timestamp in milliseconds. 0 to use appd_iot_get_time_ms() at the time event is added */
   int64_t timestamp_ms;
   /*! Duration of the event in milliseconds */
   int duration_ms;
@@ -248,7 +347,7 @@ typedef struct
 
 /**
  * @brief AppDynamics Network Request Event <br>
- * Mandatory: url and timestamp_ms Fields
+ * Mandatory: url Field. timestamp_ms set to 0 is replaced by the time event is added
  */
 typedef struct
 {
@@ -268,7 +367,7 @@ typedef struct
   int resp_headers_count;
   /*! Response Headers as <key,value> pairs */
   appd_iot_data_t* resp_headers;
-  /*! Epoch Timestamp in milliseconds */
+  /*! Epoch Timestamp in milliseconds. 0 to use appd_iot_get_time_ms() at the time event is added */
   int64_t timestamp_ms;
   /*! Count of additional data to be sent as part of network request event */
   int data_count;
@@ -319,7 +418,7 @@ typedef struct
 /**
  * @brief AppDynamics Error Event <br>
  * This structure can be used to send error or exception or a crash. <br>
- * Mandatory: name and timestamp_ms Fields
+ * Mandatory: name Field. timestamp_ms set to 0 is replaced by the time event is added
  */
 typedef struct
 {
@@ -329,7 +428,7 @@ typedef struct
   const char* message;
   /*! Severity of error - alert, critical or fatal */
   appd_iot_error_severity_t severity;
-  /*! Epoch Timestamp in milliseconds */
+  /*! Epoch Timestamp in milliseconds. 0 to use appd_iot_get_time_ms() at the time event is added */
   int64_t timestamp_ms;
   /*! Duration of the event in milliseconds */
   int duration_ms;
@@ -364,6 +463,12 @@ typedef struct
   const char* type;
   /*! Request Payload */
   const char* data;
+  /*! Non zero if request is prepared: url, type and the first static_headers_count headers are the <br>
+   * same for all requests with this id. Http transport may cache and reuse any state derived from them,
+   * such as parsed url, encoded headers and connections. Id changes when SDK is re-initialized. */
+  int prepared_id;
+  /*! Number of headers, from the start of headers, which are the same for all requests with prepared_id */
+  int static_headers_count;
 } appd_iot_http_req_t;
 
 
@@ -427,6 +532,95 @@ typedef struct
 } appd_iot_http_cb_t;
 
 
+/**
+ * @brief Http Request Batch Send Callback implements the functionality to send several HTTP Requests <br>
+ * concurrently, e.g. multiplexed over a single HTTP/2 connection or pipelined over a keep-alive
+ * connection. <br>
+ * The callback populates one response per request in http_resps, in the same order as http_reqs.
+ * A NULL response is treated as a failed request.
+ * @param http_reqs contains array of request parameters. The caller allocates memory and caller will free it.
+ * @param http_resps contains array of http_req_count response pointers to be populated by the callback. <br>
+ * Each response is freed as part of appd_iot_http_resp_done_cb_t callback function.
+ * @param http_req_count contains number of requests in http_reqs
+ */
+typedef void (*appd_iot_http_req_send_batch_cb_t)(const appd_iot_http_req_t* http_reqs,
+    appd_iot_http_resp_t** http_resps, int http_req_count);
+
+
+/**
+ * @brief AppDynamics HTTP Pipeline Callback list <br>
+ * Mandatory: All fields
+ */
+typedef struct
+{
+  /*! Callback function to send a batch of requests concurrently */
+  appd_iot_http_req_send_batch_cb_t http_req_send_batch_cb;
+  /*! Callback function triggered for each response returned by batch send callback */
+  appd_iot_http_resp_done_cb_t http_resp_done_cb;
+  /*! Maximum number of requests handed to batch send callback at once */
+  int max_requests_in_flight;
+} appd_iot_http_pipeline_cb_t;
+
+
+/*! Number of buckets in SDK latency histograms
+ */
+#define APPD_IOT_STATS_HISTOGRAM_BUCKETS 24
+
+/**
+ * @brief Latency Histogram of an SDK operation <br>
+ * Bucket i counts operations which took [2^i, 2^(i+1)) microseconds. Bucket 0 also counts operations
+ * which took less than a microsecond and the last bucket counts all longer operations.
+ */
+typedef struct
+{
+  /*! Number of operations */
+  uint64_t count;
+  /*! Total time of all operations in microseconds */
+  uint64_t sum_us;
+  /*! Time of longest operation in microseconds */
+  uint64_t max_us;
+  /*! Number of operations per latency bucket */
+  uint64_t buckets[APPD_IOT_STATS_HISTOGRAM_BUCKETS];
+} appd_iot_histogram_t;
+
+/**
+ * @brief Snapshot of SDK Self-Telemetry <br>
+ * Counters are cumulative since process start. Each counter is read atomically, but counters
+ * updated while snapshot is taken may be off by the updates in flight.
+ */
+typedef struct
+{
+  /*! Events added to SDK buffer */
+  uint64_t custom_events_added;
+  uint64_t network_events_added;
+  uint64_t error_events_added;
+  /*! Events dropped with APPD_IOT_ERR_MAX_LIMIT as SDK buffer is full */
+  uint64_t custom_events_dropped;
+  uint64_t network_events_dropped;
+  uint64_t error_events_dropped;
+  /*! Events and beacons accepted by collector */
+  uint64_t events_sent;
+  uint64_t beacons_sent;
+  /*! Beacons not accepted by collector, or which failed to be sent */
+  uint64_t beacon_send_failures;
+  /*! Events kept in SDK buffer to be sent again after a failed send */
+  uint64_t events_requeued;
+  /*! Bytes of serialized beacons, and of those accepted by collector */
+  uint64_t bytes_serialized;
+  uint64_t bytes_sent;
+  /*! Time SDK has spent disabled by collector, including current disabled period */
+  uint64_t time_disabled_ms;
+  /*! Time spent per send in each phase of sending events to collector: taking events to be sent,
+   *  serializing them, in http send callbacks, processing http responses including http response
+   *  done callbacks, and clearing sent events from SDK buffer */
+  appd_iot_histogram_t snapshot_latency;
+  appd_iot_histogram_t serialize_latency;
+  appd_iot_histogram_t transport_latency;
+  appd_iot_histogram_t response_latency;
+  appd_iot_histogram_t clear_latency;
+} appd_iot_stats_t;
+
+
 /*! Number of Server Correlation Headers
  */
 #define APPD_IOT_NUM_SERVER_CORRELATION_HEADERS 2
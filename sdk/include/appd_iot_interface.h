@@ -63,6 +63,20 @@ appd_iot_error_code_t appd_iot_init_sdk(appd_iot_sdk_config_t sdkcfg,
 appd_iot_error_code_t appd_iot_register_network_interface(appd_iot_http_cb_t http_cb) __APPD_IOT_API;
 
 
+/**
+ * @brief This method registers network interface used to send beacons concurrently <br>
+ * This method must be called before calling appd_iot_drain_all_events() to keep multiple
+ * beacons in flight. If it is not registered, appd_iot_drain_all_events() sends one beacon at a time
+ * using the interface registered with appd_iot_register_network_interface().
+ * @param pipeline_cb contains function pointers for http batch send and http resp done callbacks <br>
+ * and the maximum number of requests to be in flight at once.
+ * @return appd_iot_error_code_t Error code indicating if the function call is a success or fail. <br>
+ * Error code returned provides more details on the type of error occurred.
+ */
+appd_iot_error_code_t appd_iot_register_network_pipeline_interface
+(appd_iot_http_pipeline_cb_t pipeline_cb) __APPD_IOT_API;
+
+
 /**
  * @brief This method adds custom event data <br>
  * Each call to add event will create a new event.
@@ -107,6 +121,21 @@ appd_iot_error_code_t appd_iot_add_error_event(appd_iot_error_event_t error_even
 appd_iot_error_code_t appd_iot_send_all_events(void) __APPD_IOT_API;
 
 
+/**
+ * @brief This method sends all event data split into beacons of at most max_events_per_beacon events. <br>
+ * It is intended to drain a backlog of events built up while collector was not reachable. Up to
+ * max_requests_in_flight beacons are handed to the http batch send callback at once, so drain time is
+ * bound by bandwidth rather than round trip time. <br>
+ * Each beacon sent successfully is flushed out of memory independently of others. Beacons which fail
+ * remain in memory, in the order they were added, for retry. If there is a network reject with response
+ * codes 402, 403 or 429 then all events are flushed out of memory and SDK state set to DISABLED.
+ * @param max_events_per_beacon contains the maximum number of events sent in a single beacon
+ * @return appd_iot_error_code_t Error code indicating if the function call is a success or fail.
+ * Error code returned provides more details on the type of error occurred.
+ */
+appd_iot_error_code_t appd_iot_drain_all_events(int max_events_per_beacon) __APPD_IOT_API;
+
+
 /**
  * @brief This method removes all event data stored in memory <br>
  * This call is not needed if appd_iot_send_all_events return SUCCESS.
@@ -127,6 +156,43 @@ appd_iot_error_code_t appd_iot_clear_all_events(void) __APPD_IOT_API;
  */
 appd_iot_error_code_t appd_iot_check_app_status(void) __APPD_IOT_API;
 
+
+/**
+ * @brief This method writes out log messages queued in APPD_IOT_LOG_MODE_ASYNC, and log messages
+ * buffered for log_file, on the calling thread. <br>
+ * It returns after all messages logged before the call are written. It is recommended to call it
+ * before application exits. Nothing needs to be done in APPD_IOT_LOG_MODE_SYNC without log_file.
+ */
+void appd_iot_flush_log(void) __APPD_IOT_API;
+
+
+/**
+ * @brief Get current UTC time in milliseconds from a coarse clock, without a system call. <br>
+ * Resolution is a few milliseconds. Can be used to set timestamp_ms of events.
+ * @return time in milliseconds since epoch
+ */
+int64_t appd_iot_get_time_ms(void) __APPD_IOT_API;
+
+
+/**
+ * @brief Writes current UTC time in milliseconds as decimal string, as used in timestamps of log
+ * messages written by SDK. Decimal string is cached per thread and reused until the clock advances,
+ * so it is cheap to call for every log message written by log write callback.
+ * @param buf to which null terminated string is written
+ * @param buflen contains size of buf. 24 bytes is enough for any time.
+ * @return length of string written, excluding null char
+ */
+size_t appd_iot_get_time_ms_str(char* buf, size_t buflen) __APPD_IOT_API;
+
+
+/**
+ * @brief Get snapshot of SDK self-telemetry counters and latency histograms. <br>
+ * Counters are maintained per thread without locks and summed when snapshot is taken.
+ * @param stats to which snapshot is written
+ * @return appd_iot_error_code_t Error code indicating if the function call is a success or fail.
+ */
+appd_iot_error_code_t appd_iot_get_stats(appd_iot_stats_t* stats) __APPD_IOT_API;
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif  /* defined(__cplusplus) */
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ATOMIC_HPP
+#define _ATOMIC_HPP
+
+/**
+ * Atomic operations on integral, enum and pointer types built on GCC __atomic builtins,
+ * as std::atomic is not available in C++98.
+ */
+
+/**
+ * @brief Atomically reads value with acquire ordering
+ * @param ptr points to the value to be read
+ * @return value read
+ */
+template <typename T>
+inline T appd_iot_atomic_load(const T* ptr)
+{
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Atomically reads value without ordering. Use for counters.
+ * @param ptr points to the value to be read
+ * @return value read
+ */
+template <typename T>
+inline T appd_iot_atomic_load_relaxed(const T* ptr)
+{
+  return __atomic_load_n(ptr, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Atomically writes value without ordering. Use for counters written by a single thread.
+ * @param ptr points to the value to be written
+ * @param value to be written
+ */
+template <typename T>
+inline void appd_iot_atomic_store_relaxed(T* ptr, T value)
+{
+  __atomic_store_n(ptr, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Atomically writes value with release ordering
+ * @param ptr points to the value to be written
+ * @param value to be written
+ */
+template <typename T>
+inline void appd_iot_atomic_store(T* ptr, T value)
+{
+  __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Atomically replaces value and returns the previous value
+ * @param ptr points to the value to be replaced
+ * @param value to be written
+ * @return previous value
+ */
+template <typename T>
+inline T appd_iot_atomic_exchange(T* ptr, T value)
+{
+  return __atomic_exchange_n(ptr, value, __ATOMIC_ACQ_REL);
+}
+
+/**
+ * @brief Atomically replaces value with desired if it is equal to expected
+ * @param ptr points to the value to be replaced
+ * @param expected contains expected value. Updated with current value on failure.
+ * @param desired contains value to be written
+ * @return true if value is replaced
+ */
+template <typename T>
+inline bool appd_iot_atomic_compare_exchange(T* ptr, T* expected, T desired)
+{
+  return __atomic_compare_exchange_n(ptr, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Atomically adds to value without ordering. Use for counters.
+ * @param ptr points to the value to be updated
+ * @param value to be added
+ * @return previous value
+ */
+template <typename T>
+inline T appd_iot_atomic_fetch_add(T* ptr, T value)
+{
+  return __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Full memory barrier. Orders a preceding store before a following load,
+ * which acquire and release ordering do not.
+ */
+inline void appd_iot_atomic_fence(void)
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#endif /* _ATOMIC_HPP */
@@ -14,19 +14,84 @@
  * limitations under the License.
  */
 
+//Log statements in this file belong to beacon subsystem, unless redefined below
+#define APPD_IOT_LOG_SUBSYSTEM APPD_IOT_LOG_SUBSYSTEM_BEACON
+
 #include <string.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <list>
+#include <vector>
+#if __cplusplus >= 201103L
+#include <utility>
+#endif
 #include "beacon.hpp"
 #include "log.hpp"
 #include "json_serializer.hpp"
 #include "config.hpp"
 #include "utils.hpp"
+#include "stats.hpp"
+#include "clock.hpp"
 
 #define APPD_IOT_SDK_VERSION "4.4.1.0"
 
+//Type of the custom event with time of each send phase, added when enabled in SDK config
+#define APPD_IOT_SEND_TIMING_EVENT_TYPE "AppDynamicsSDKSendTiming"
+
+//Estimated allocator overhead of a std::map node, beyond the element
+#define APPD_IOT_MAP_NODE_OVERHEAD (4 * sizeof(void*))
+
+//Initial capacity of an event array of beacon, capacity is doubled each time the array is full
+#define APPD_IOT_MIN_EVENT_CAPACITY 16
+
+#define APPD_IOT_BEACON_HTTP_HEADERS_COUNT 3
+#define APPD_IOT_BEACON_HTTP_STATIC_HEADERS_COUNT 2
+
+/**
+ * @brief Beacon http request parameters built once at SDK init. Url, type and static headers
+ * are the same for all beacons, send path only patches payload and content length.
+ */
+typedef struct
+{
+  int id;                     /* Prepared request id, changes each time request is prepared */
+  std::string url;            /* Collector URL beacons are posted to */
+  appd_iot_data_t static_headers[APPD_IOT_BEACON_HTTP_STATIC_HEADERS_COUNT]; /* Accept, Content-Type */
+} beacon_http_req_prepared_t;
+
+/**
+ * @brief Part of the events in memory sent to collector as a single beacon
+ */
+typedef struct
+{
+  beacon_t beacon;               /* Events sent as part of this beacon */
+  std::string jsondata;          /* Serialized beacon */
+  char jsonlen_buf[24];          /* Content-Length header value */
+  appd_iot_data_t headers[APPD_IOT_BEACON_HTTP_HEADERS_COUNT]; /* Http request headers */
+} beacon_chunk_t;
+
+/**
+ * @brief Timing of the last successful send, added as custom event to the next send which has other events
+ */
+typedef struct
+{
+  bool pending;                  /* Set when a send succeeded and its timing is not added yet */
+  int64_t timestamp_ms;          /* Time at which the send completed */
+  appd_iot_send_timer_t timer;   /* Time spent in each phase of the send */
+  size_t event_count;            /* Number of events sent */
+  size_t jsonlen;                /* Length of serialized beacons sent */
+} send_timing_t;
+
 static beacon_t global_beacon;
+static send_timing_t global_send_timing;
+static beacon_http_req_prepared_t global_beacon_http_req;
+
+//Reused to serialize events when they are added, allocated with the first event serialized
+static json_t* global_event_json = NULL;
 
-static std::string appd_iot_serialize_beacon_to_json(beacon_t beacon);
+static std::string appd_iot_serialize_beacon_to_json(beacon_t* beacon);
+static void appd_iot_serialize_custom_event_to_json(json_t* json, custom_event_t* event);
+static void appd_iot_serialize_network_request_event_to_json(json_t* json, network_request_event_t* event);
+static void appd_iot_serialize_error_event_to_json(json_t* json, error_event_t* event);
 
 /**
  * @brief Initializes Device Configuration <br>
@@ -82,27 +147,359 @@ appd_iot_error_code_t appd_iot_init_device_config(appd_iot_device_config_t devcf
   return APPD_IOT_SUCCESS;
 }
 
+/**
+ * @brief Get number of events present in beacon
+ * @param beacon contains events
+ * @return total number of custom, network and error events
+ */
+static size_t appd_iot_get_beacon_event_count(beacon_t* beacon)
+{
+  return beacon->timeline.size();
+}
+
+/**
+ * @brief Get number of events of a type present in beacon
+ * @param beacon contains events
+ * @param type contains event type
+ * @return number of events of given type, serialized or not
+ */
+static size_t appd_iot_get_beacon_event_type_count(beacon_t* beacon, event_type_t type)
+{
+  size_t count = beacon->serialized_events[type].ends.size();
+
+  switch (type)
+  {
+    case APPD_IOT_EVENT_TYPE_CUSTOM:
+      count += beacon->custom_events.size();
+      break;
+
+    case APPD_IOT_EVENT_TYPE_NETWORK_REQUEST:
+      count += beacon->network_request_events.size();
+      break;
+
+    case APPD_IOT_EVENT_TYPE_ERROR:
+      count += beacon->error_events.size();
+      break;
+
+    default:
+      break;
+  }
+
+  return count;
+}
+
+/**
+ * @brief Estimates heap memory used by key value pairs of a map, excluding string values
+ */
+template <typename value_t>
+static size_t appd_iot_get_map_memory_bytes(const std::map<std::string, value_t>& map)
+{
+  size_t bytes = 0;
+
+  for (typename std::map<std::string, value_t>::const_iterator it = map.begin(); it != map.end(); ++it)
+  {
+    bytes += APPD_IOT_MAP_NODE_OVERHEAD + sizeof(*it) + it->first.capacity();
+  }
+
+  return bytes;
+}
+
+/**
+ * @brief Estimates heap memory used by event data
+ */
+static size_t appd_iot_get_data_memory_bytes(const data_t& data)
+{
+  size_t bytes = appd_iot_get_map_memory_bytes(data.stringmap) +
+                 appd_iot_get_map_memory_bytes(data.integermap) +
+                 appd_iot_get_map_memory_bytes(data.doublemap) +
+                 appd_iot_get_map_memory_bytes(data.boolmap) +
+                 appd_iot_get_map_memory_bytes(data.datetimemap);
+
+  for (std::map<std::string, std::string>::const_iterator it = data.stringmap.begin();
+       it != data.stringmap.end(); ++it)
+  {
+    bytes += it->second.capacity();
+  }
+
+  return bytes;
+}
+
+/**
+ * @brief Get number of events held in memory per event type and estimate of memory used by them
+ * @param usage to which event counts and memory estimate are written
+ */
+void appd_iot_get_beacon_usage(beacon_usage_t* usage)
+{
+  size_t bytes = global_beacon.timeline.capacity() * sizeof(event_type_t) +
+                 global_beacon.custom_events.capacity() * sizeof(custom_event_t) +
+                 global_beacon.network_request_events.capacity() * sizeof(network_request_event_t) +
+                 global_beacon.error_events.capacity() * sizeof(error_event_t);
+
+  for (size_t i = 0; i < global_beacon.custom_events.size(); i++)
+  {
+    const custom_event_t& event = global_beacon.custom_events[i];
+
+    bytes += event.type.capacity() + event.summary.capacity() + appd_iot_get_data_memory_bytes(event.data);
+  }
+
+  for (size_t i = 0; i < global_beacon.network_request_events.size(); i++)
+  {
+    const network_request_event_t& event = global_beacon.network_request_events[i];
+
+    bytes += event.url.capacity() + event.error.capacity() +
+             appd_iot_get_data_memory_bytes(event.resp_headers) + appd_iot_get_data_memory_bytes(event.data);
+  }
+
+  for (size_t i = 0; i < global_beacon.error_events.size(); i++)
+  {
+    const error_event_t& event = global_beacon.error_events[i];
+
+    bytes += event.name.capacity() + event.message.capacity() + event.severity.capacity() +
+             event.stack_traces.capacity() * sizeof(stack_trace_t) +
+             event.stack_frames.capacity() * sizeof(stack_frame_t) + appd_iot_get_data_memory_bytes(event.data);
+
+    for (size_t j = 0; j < event.stack_traces.size(); j++)
+    {
+      bytes += event.stack_traces[j].thread.capacity() + event.stack_traces[j].runtime.capacity();
+    }
+
+    for (size_t j = 0; j < event.stack_frames.size(); j++)
+    {
+      const stack_frame_t& frame = event.stack_frames[j];
+
+      bytes += frame.symbol_name.capacity() + frame.package_name.capacity() + frame.file_name.capacity();
+    }
+  }
+
+  for (int type = 0; type < APPD_IOT_EVENT_TYPE_COUNT; type++)
+  {
+    const serialized_events_t& serialized = global_beacon.serialized_events[type];
+
+    bytes += serialized.json.capacity() + serialized.ends.capacity() * sizeof(size_t);
+  }
+
+  usage->custom_event_count = appd_iot_get_beacon_event_type_count(&global_beacon, APPD_IOT_EVENT_TYPE_CUSTOM);
+  usage->network_request_event_count =
+    appd_iot_get_beacon_event_type_count(&global_beacon, APPD_IOT_EVENT_TYPE_NETWORK_REQUEST);
+  usage->error_event_count = appd_iot_get_beacon_event_type_count(&global_beacon, APPD_IOT_EVENT_TYPE_ERROR);
+  usage->memory_bytes = bytes;
+}
+
+/**
+ * @brief Swaps event data. Used to move events into beacon, as maps and strings swap without copying.
+ */
+static void appd_iot_swap_data(data_t* a, data_t* b)
+{
+  a->stringmap.swap(b->stringmap);
+  a->integermap.swap(b->integermap);
+  a->doublemap.swap(b->doublemap);
+  a->boolmap.swap(b->boolmap);
+  a->datetimemap.swap(b->datetimemap);
+}
+
+/**
+ * @brief Swaps custom events without copying strings and maps
+ */
+static void appd_iot_swap_event(custom_event_t* a, custom_event_t* b)
+{
+  a->type.swap(b->type);
+  a->summary.swap(b->summary);
+  std::swap(a->timestamp_ms, b->timestamp_ms);
+  std::swap(a->duration_ms, b->duration_ms);
+  appd_iot_swap_data(&a->data, &b->data);
+}
+
+/**
+ * @brief Swaps network request events without copying strings and maps
+ */
+static void appd_iot_swap_event(network_request_event_t* a, network_request_event_t* b)
+{
+  a->url.swap(b->url);
+  a->error.swap(b->error);
+  std::swap(a->req_content_length, b->req_content_length);
+  std::swap(a->resp_content_length, b->resp_content_length);
+  std::swap(a->resp_code, b->resp_code);
+  std::swap(a->timestamp_ms, b->timestamp_ms);
+  std::swap(a->duration_ms, b->duration_ms);
+  appd_iot_swap_data(&a->resp_headers, &b->resp_headers);
+  appd_iot_swap_data(&a->data, &b->data);
+}
+
+/**
+ * @brief Swaps error events without copying strings, stack traces and maps
+ */
+static void appd_iot_swap_event(error_event_t* a, error_event_t* b)
+{
+  a->name.swap(b->name);
+  a->message.swap(b->message);
+  a->severity.swap(b->severity);
+  std::swap(a->timestamp_ms, b->timestamp_ms);
+  std::swap(a->duration_ms, b->duration_ms);
+  std::swap(a->error_stack_trace_index, b->error_stack_trace_index);
+  a->stack_traces.swap(b->stack_traces);
+  a->stack_frames.swap(b->stack_frames);
+  appd_iot_swap_data(&a->data, &b->data);
+}
+
+/**
+ * @brief Grows capacity of event array to at least given capacity. Events are moved into
+ * the grown array, so that they are not copied when array is reallocated. C++98 has no move
+ * constructor, there each event is default constructed in the grown array and swapped in.
+ * @param events contains event array to be grown
+ * @param capacity contains minimum number of events array can hold
+ */
+template <typename event_t>
+static void appd_iot_reserve_events(std::vector<event_t>* events, size_t capacity)
+{
+  if (capacity <= events->capacity())
+  {
+    return;
+  }
+
+  std::vector<event_t> grown;
+
+  grown.reserve(capacity);
+
+  for (size_t i = 0; i < events->size(); i++)
+  {
+#if __cplusplus >= 201103L
+    grown.emplace_back(std::move((*events)[i]));
+#else
+    grown.push_back(event_t());
+    appd_iot_swap_event(&grown.back(), &(*events)[i]);
+#endif
+  }
+
+  events->swap(grown);
+}
+
+/**
+ * @brief Appends event to the end of event array without copying it. Event is move constructed
+ * in place in C++11 and later, and swapped into a default constructed event in C++98.
+ * @param events contains event array to which event is appended to
+ * @param event contains event to be appended, its content is moved out
+ * @param max_events contains maximum number of events array is grown to hold
+ */
+template <typename event_t>
+static void appd_iot_push_event(std::vector<event_t>* events, event_t* event, size_t max_events)
+{
+  if (events->size() == events->capacity())
+  {
+    size_t capacity = std::max((size_t)APPD_IOT_MIN_EVENT_CAPACITY, 2 * events->capacity());
+
+    appd_iot_reserve_events(events, std::min(capacity, max_events));
+  }
+
+#if __cplusplus >= 201103L
+  events->emplace_back(std::move(*event));
+#else
+  events->push_back(event_t());
+  appd_iot_swap_event(&events->back(), event);
+#endif
+}
+
+/**
+ * @brief Appends type of an event added to beacon to the end of its timeline
+ */
+static void appd_iot_add_to_timeline(beacon_t* beacon, event_type_t type)
+{
+  if (beacon->timeline.size() == beacon->timeline.capacity())
+  {
+    size_t capacity = std::max((size_t)APPD_IOT_MIN_EVENT_CAPACITY, 2 * beacon->timeline.capacity());
+
+    beacon->timeline.reserve(std::min(capacity, (size_t)APPD_IOT_MAX_EVENTS));
+  }
+
+  beacon->timeline.push_back(type);
+}
+
+/**
+ * @brief Serializes event to JSON and appends it to serialized events of its type, if enabled in SDK config.
+ * Events are serialized only while no events of the same type are held unserialized, so that serialized
+ * events of a type stay older than the others.
+ * @param beacon to which serialized event is added
+ * @param type contains type of the event
+ * @param events contains events of the same type held unserialized
+ * @param event contains event to be serialized, it is left empty if serialized
+ * @param serialize contains function which serializes event
+ * @return true if event is serialized, false if it is to be added as is
+ */
+template <typename event_t>
+static bool appd_iot_add_serialized_event(beacon_t* beacon, event_type_t type, const std::vector<event_t>& events,
+    event_t* event, void (*serialize)(json_t*, event_t*))
+{
+  if (!appd_iot_get_serialize_on_add() || !events.empty())
+  {
+    return false;
+  }
+
+  if (global_event_json == NULL)
+  {
+    global_event_json = appd_iot_json_init();
+
+    if (global_event_json == NULL)
+    {
+      appd_iot_log(APPD_IOT_LOG_WARN, "Failed to allocate JSON to Serialize Event, Adding Event as is");
+      return false;
+    }
+  }
+  else
+  {
+    appd_iot_json_reset(global_event_json);
+  }
+
+  serialize(global_event_json, event);
+
+  serialized_events_t& serialized = beacon->serialized_events[type];
+
+  if (!serialized.json.empty())
+  {
+    serialized.json += ',';
+  }
+
+  serialized.json.append(appd_iot_json_get_string(global_event_json), global_event_json->len);
+  serialized.ends.push_back(serialized.json.length());
+
+  //only JSON of event is kept, its strings and maps are freed right away
+  event_t discarded;
+
+  appd_iot_swap_event(&discarded, event);
+
+  return true;
+}
+
 /**
   * @brief Adds Custom Event to Beacon
-  * @param event contains custom event data to be sent to collector
+  * @param event contains custom event data to be sent to collector. On success, its content is
+  * moved into beacon without copying, or serialized if enabled in SDK config, and event is left empty.
   * @return appd_iot_error_code_t indicating function execution status
   */
-appd_iot_error_code_t appd_iot_add_custom_event_to_beacon(custom_event_t event)
+appd_iot_error_code_t appd_iot_add_custom_event_to_beacon(custom_event_t* event)
 {
-  if (global_beacon.custom_event_list.size() < APPD_IOT_MAX_CUSTOM_EVENTS)
+  if (appd_iot_get_beacon_event_count(&global_beacon) < APPD_IOT_MAX_EVENTS)
   {
-    global_beacon.custom_event_list.push_back(event);
+    if (!appd_iot_add_serialized_event(&global_beacon, APPD_IOT_EVENT_TYPE_CUSTOM, global_beacon.custom_events, event,
+                                       appd_iot_serialize_custom_event_to_json))
+    {
+      appd_iot_push_event(&global_beacon.custom_events, event, APPD_IOT_MAX_EVENTS);
+    }
+
+    appd_iot_add_to_timeline(&global_beacon, APPD_IOT_EVENT_TYPE_CUSTOM);
+
+    appd_iot_stats_add(APPD_IOT_STAT_CUSTOM_EVENTS_ADDED, 1);
 
     appd_iot_log(APPD_IOT_LOG_INFO, "Custom Event Added, Size:%lu",
-                 (unsigned long)global_beacon.custom_event_list.size());
+                 (unsigned long)appd_iot_get_beacon_event_type_count(&global_beacon, APPD_IOT_EVENT_TYPE_CUSTOM));
 
     return APPD_IOT_SUCCESS;
   }
   else
   {
     appd_iot_log(APPD_IOT_LOG_ERROR,
-                 "Max Custom Events (%d) in Buffer. Send Events in Buffer to Collector before adding new events",
-                 APPD_IOT_MAX_CUSTOM_EVENTS);
+                 "Max Events (%d) in Buffer. Send Events in Buffer to Collector before adding new events",
+                 APPD_IOT_MAX_EVENTS);
+
+    appd_iot_stats_add(APPD_IOT_STAT_CUSTOM_EVENTS_DROPPED, 1);
 
     return APPD_IOT_ERR_MAX_LIMIT;
   }
@@ -110,25 +507,36 @@ appd_iot_error_code_t appd_iot_add_custom_event_to_beacon(custom_event_t event)
 
 /**
   * @brief Adds Network Request Event to Beacon
-  * @param event contains network request event data to be sent to collector
+  * @param event contains network request event data to be sent to collector. On success, its content is
+  * moved into beacon without copying, or serialized if enabled in SDK config, and event is left empty.
   * @return appd_iot_error_code_t indicating function execution status
   */
-appd_iot_error_code_t appd_iot_add_network_request_event_to_beacon(network_request_event_t event)
+appd_iot_error_code_t appd_iot_add_network_request_event_to_beacon(network_request_event_t* event)
 {
-  if (global_beacon.network_request_event_list.size() < APPD_IOT_MAX_NETWORK_EVENTS)
+  if (appd_iot_get_beacon_event_count(&global_beacon) < APPD_IOT_MAX_EVENTS)
   {
-    global_beacon.network_request_event_list.push_back(event);
+    if (!appd_iot_add_serialized_event(&global_beacon, APPD_IOT_EVENT_TYPE_NETWORK_REQUEST, global_beacon.network_request_events, event,
+                                       appd_iot_serialize_network_request_event_to_json))
+    {
+      appd_iot_push_event(&global_beacon.network_request_events, event, APPD_IOT_MAX_EVENTS);
+    }
+
+    appd_iot_add_to_timeline(&global_beacon, APPD_IOT_EVENT_TYPE_NETWORK_REQUEST);
+
+    appd_iot_stats_add(APPD_IOT_STAT_NETWORK_EVENTS_ADDED, 1);
 
     appd_iot_log(APPD_IOT_LOG_INFO, "Network Event Added, Size:%lu",
-                 (unsigned long)global_beacon.network_request_event_list.size());
+                 (unsigned long)appd_iot_get_beacon_event_type_count(&global_beacon, APPD_IOT_EVENT_TYPE_NETWORK_REQUEST));
 
     return APPD_IOT_SUCCESS;
   }
   else
   {
     appd_iot_log(APPD_IOT_LOG_ERROR,
-                 "Max Network Events (%d) in Buffer. Send Events in Buffer to Collector before adding new events",
-                 APPD_IOT_MAX_NETWORK_EVENTS);
+                 "Max Events (%d) in Buffer. Send Events in Buffer to Collector before adding new events",
+                 APPD_IOT_MAX_EVENTS);
+
+    appd_iot_stats_add(APPD_IOT_STAT_NETWORK_EVENTS_DROPPED, 1);
 
     return APPD_IOT_ERR_MAX_LIMIT;
   }
@@ -136,25 +544,36 @@ appd_iot_error_code_t appd_iot_add_network_request_event_to_beacon(network_reque
 
 /**
   * @brief Adds Error Event to Beacon
-  * @param event contains error event data to be sent to collector
+  * @param event contains error event data to be sent to collector. On success, its content is
+  * moved into beacon without copying, or serialized if enabled in SDK config, and event is left empty.
   * @return appd_iot_error_code_t indicating function execution status
   */
-appd_iot_error_code_t appd_iot_add_error_event_to_beacon(error_event_t event)
+appd_iot_error_code_t appd_iot_add_error_event_to_beacon(error_event_t* event)
 {
-  if (global_beacon.error_event_list.size() < APPD_IOT_MAX_ERROR_EVENTS)
+  if (appd_iot_get_beacon_event_count(&global_beacon) < APPD_IOT_MAX_EVENTS)
   {
-    global_beacon.error_event_list.push_back(event);
+    if (!appd_iot_add_serialized_event(&global_beacon, APPD_IOT_EVENT_TYPE_ERROR, global_beacon.error_events, event,
+                                       appd_iot_serialize_error_event_to_json))
+    {
+      appd_iot_push_event(&global_beacon.error_events, event, APPD_IOT_MAX_EVENTS);
+    }
+
+    appd_iot_add_to_timeline(&global_beacon, APPD_IOT_EVENT_TYPE_ERROR);
+
+    appd_iot_stats_add(APPD_IOT_STAT_ERROR_EVENTS_ADDED, 1);
 
     appd_iot_log(APPD_IOT_LOG_INFO, "Error Event Added, Size:%lu",
-                 (unsigned long)global_beacon.error_event_list.size());
+                 (unsigned long)appd_iot_get_beacon_event_type_count(&global_beacon, APPD_IOT_EVENT_TYPE_ERROR));
 
     return APPD_IOT_SUCCESS;
   }
   else
   {
     appd_iot_log(APPD_IOT_LOG_ERROR,
-                 "Max Error Events (%d) in Buffer. Send Events in Buffer to Collector before adding new events",
-                 APPD_IOT_MAX_ERROR_EVENTS);
+                 "Max Events (%d) in Buffer. Send Events in Buffer to Collector before adding new events",
+                 APPD_IOT_MAX_EVENTS);
+
+    appd_iot_stats_add(APPD_IOT_STAT_ERROR_EVENTS_DROPPED, 1);
 
     return APPD_IOT_ERR_MAX_LIMIT;
   }
@@ -170,93 +589,92 @@ appd_iot_error_code_t appd_iot_clear_all_beacons(void)
 {
   appd_iot_log(APPD_IOT_LOG_INFO, "Clearing All Beacons");
   appd_iot_log(APPD_IOT_LOG_INFO, "Clearing %lu Custom Events",
-               (unsigned long)global_beacon.custom_event_list.size());
+               (unsigned long)appd_iot_get_beacon_event_type_count(&global_beacon, APPD_IOT_EVENT_TYPE_CUSTOM));
   appd_iot_log(APPD_IOT_LOG_INFO, "Clearing %lu Network Events",
-               (unsigned long)global_beacon.network_request_event_list.size());
+               (unsigned long)appd_iot_get_beacon_event_type_count(&global_beacon, APPD_IOT_EVENT_TYPE_NETWORK_REQUEST));
   appd_iot_log(APPD_IOT_LOG_INFO, "Clearing %lu Error Events",
-               (unsigned long)global_beacon.error_event_list.size());
+               (unsigned long)appd_iot_get_beacon_event_type_count(&global_beacon, APPD_IOT_EVENT_TYPE_ERROR));
+
+  global_send_timing.pending = false;
+  global_beacon.timeline.clear();
+  global_beacon.custom_events.clear();
+  global_beacon.network_request_events.clear();
+  global_beacon.error_events.clear();
 
-  global_beacon.custom_event_list.clear();
-  global_beacon.network_request_event_list.clear();
-  global_beacon.error_event_list.clear();
+  for (int type = 0; type < APPD_IOT_EVENT_TYPE_COUNT; type++)
+  {
+    global_beacon.serialized_events[type].json.clear();
+    global_beacon.serialized_events[type].ends.clear();
+  }
 
   return APPD_IOT_SUCCESS;
 }
 
 
-/**
-  * @brief Sends Beacons in memory to collector. <br>
-  * Max Limit on the number of events in the beacon is defined by <br>
-  * APPD_IOT_MAX_CUSTOM_EVENTS, APPD_IOT_MAX_NETWORK_EVENTS and APPD_IOT_MAX_CUSTOM_EVENTS
-  * @return appd_iot_error_code_t indicating function execution status
-  */
-appd_iot_error_code_t appd_iot_send_all_beacons(void)
-{
-
-  if (global_beacon.custom_event_list.size() == 0 &&
-      global_beacon.network_request_event_list.size() == 0 &&
-      global_beacon.error_event_list.size() == 0)
-  {
-    appd_iot_log(APPD_IOT_LOG_INFO, "No Events Present");
-    return APPD_IOT_SUCCESS;
-  }
+//Functions below send beacons to collector
+#undef APPD_IOT_LOG_SUBSYSTEM
+#define APPD_IOT_LOG_SUBSYSTEM APPD_IOT_LOG_SUBSYSTEM_TRANSPORT
 
-  appd_iot_log(APPD_IOT_LOG_INFO, "Sending All Beacons");
-  appd_iot_log(APPD_IOT_LOG_INFO, "Sending %lu Custom Events",
-               (unsigned long)global_beacon.custom_event_list.size());
-  appd_iot_log(APPD_IOT_LOG_INFO, "Sending %lu Network Events",
-               (unsigned long)global_beacon.network_request_event_list.size());
-  appd_iot_log(APPD_IOT_LOG_INFO, "Sending %lu Error Events",
-               (unsigned long)global_beacon.error_event_list.size());
 
-  /* Init all the data structures - REQ and RESP */
-  appd_iot_http_req_t http_req;
-  appd_iot_http_resp_t* http_resp = NULL;
-  std::string jsondata;
-  appd_iot_error_code_t retcode = APPD_IOT_SUCCESS;
-  appd_iot_http_req_send_cb_t http_req_send_cb = appd_iot_get_http_req_send_cb();
-  appd_iot_http_resp_done_cb_t http_resp_done_cb = appd_iot_get_http_resp_done_cb();
+/**
+ * @brief Prepares http request parameters which are the same for all beacons. <br>
+ * Must be called after collector url is configured, each time SDK is initialized.
+ * @return appd_iot_error_code_t indicating function execution status
+ */
+appd_iot_error_code_t appd_iot_prepare_beacon_http_req(void)
+{
+  static int prepared_id = 0;
 
-  if (http_req_send_cb == NULL)
-  {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Network Interface Not Available");
-    return APPD_IOT_ERR_NETWORK_NOT_AVAILABLE;
-  }
+  global_beacon_http_req.url = appd_iot_get_eum_collector_url();
 
-  jsondata = appd_iot_serialize_beacon_to_json(global_beacon);
+  appd_iot_data_set_string(&global_beacon_http_req.static_headers[0], "Accept", "application/json");
+  appd_iot_data_set_string(&global_beacon_http_req.static_headers[1], "Content-Type", "application/json");
 
-  if (jsondata.empty())
-  {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Failed to Serialize Data to JSON Format");
-    return APPD_IOT_ERR_NULL_PTR;
-  }
+  /* new id lets http transport discard any state cached for previous url */
+  global_beacon_http_req.id = ++prepared_id;
 
-  char jsonlen_buf[10];
-  snprintf(jsonlen_buf, sizeof(jsonlen_buf), "%lu", (unsigned long)jsondata.length());
+  return APPD_IOT_SUCCESS;
+}
 
-  appd_iot_init_to_zero(&http_req, sizeof(http_req));
 
-  http_req.data = jsondata.c_str();
-  http_req.type = "POST";
-  http_req.url = appd_iot_get_eum_collector_url();
-  http_req.headers_count = 3;
-  http_req.headers = (appd_iot_data_t*)calloc(http_req.headers_count, sizeof(appd_iot_data_t));
+/**
+ * @brief Fills http request used to post serialized beacon to collector from prepared request
+ * @param http_req to which request parameters are written to
+ * @param headers contains APPD_IOT_BEACON_HTTP_HEADERS_COUNT headers referenced by http_req
+ * @param jsonlen_buf to which content length header value is written to
+ * @param jsonlen_buf_size contains size of jsonlen_buf
+ * @param jsondata contains serialized beacon
+ */
+static void appd_iot_init_beacon_http_req(appd_iot_http_req_t* http_req, appd_iot_data_t* headers,
+    char* jsonlen_buf, size_t jsonlen_buf_size, const std::string& jsondata)
+{
+  snprintf(jsonlen_buf, jsonlen_buf_size, "%lu", (unsigned long)jsondata.length());
 
-  if (http_req.headers == NULL)
-  {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Failed to Create HTTP Request Headers");
-    return APPD_IOT_ERR_NULL_PTR;
-  }
+  appd_iot_init_to_zero(http_req, sizeof(appd_iot_http_req_t));
 
-  appd_iot_data_set_string(&http_req.headers[0], "Accept", "application/json");
-  appd_iot_data_set_string(&http_req.headers[1], "Content-Type", "application/json");
-  appd_iot_data_set_string(&http_req.headers[2], "Content-Length", jsonlen_buf);
+  /* static headers come first so that http transport can reuse their encoding across requests */
+  memcpy(headers, global_beacon_http_req.static_headers, sizeof(global_beacon_http_req.static_headers));
+  appd_iot_data_set_string(&headers[APPD_IOT_BEACON_HTTP_STATIC_HEADERS_COUNT], "Content-Length", jsonlen_buf);
 
-  appd_iot_log(APPD_IOT_LOG_INFO, "Content Len:%lu", (unsigned long)jsondata.length());
+  http_req->data = jsondata.c_str();
+  http_req->type = "POST";
+  http_req->url = global_beacon_http_req.url.c_str();
+  http_req->headers_count = APPD_IOT_BEACON_HTTP_HEADERS_COUNT;
+  http_req->headers = headers;
+  http_req->prepared_id = global_beacon_http_req.id;
+  http_req->static_headers_count = APPD_IOT_BEACON_HTTP_STATIC_HEADERS_COUNT;
+}
 
-  http_resp = http_req_send_cb(&http_req);
 
-  free(http_req.headers);
+/**
+ * @brief Reads http response returned for a beacon sent to collector
+ * @param http_resp contains response returned by http send callback
+ * @return appd_iot_error_code_t is SUCCESS if beacon is accepted by collector, NETWORK_REJECT
+ * if collector rejected beacon with response codes 402, 403 or 429, any other error otherwise
+ */
+static appd_iot_error_code_t appd_iot_read_beacon_http_resp(appd_iot_http_resp_t* http_resp)
+{
+  appd_iot_error_code_t retcode;
 
   /* check if any error present in http response */
   if (http_resp != NULL)
@@ -272,13 +690,8 @@ appd_iot_error_code_t appd_iot_send_all_beacons(void)
   /* Return if there is an error executing http req */
   if (retcode != APPD_IOT_SUCCESS)
   {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Error Executing HTTP Request:%s",
-                 appd_iot_error_code_to_str(retcode));
-
-    if (http_resp_done_cb != NULL)
-    {
-      http_resp_done_cb(http_resp);
-    }
+    appd_iot_log_with_fields(APPD_IOT_LOG_ERROR, appd_iot_log_error_code_field(retcode),
+                             "Error Executing HTTP Request:%s", appd_iot_error_code_to_str(retcode));
 
     return retcode;
   }
@@ -309,55 +722,653 @@ appd_iot_error_code_t appd_iot_send_all_beacons(void)
 
   if (http_resp->resp_code >= 200 && http_resp->resp_code < 300)
   {
-    appd_iot_log(APPD_IOT_LOG_INFO, "RespCode:%d Beacon Sent Successfully", http_resp->resp_code);
-    appd_iot_clear_all_beacons();
+    appd_iot_log_with_fields(APPD_IOT_LOG_INFO, appd_iot_log_resp_code_field(http_resp->resp_code),
+                             "RespCode:%d Beacon Sent Successfully", http_resp->resp_code);
     retcode = APPD_IOT_SUCCESS;
   }
   else if ((http_resp->resp_code == 402) ||
            (http_resp->resp_code == 403) ||
            (http_resp->resp_code == 429))
   {
-    appd_iot_clear_all_beacons();
-    appd_iot_disable_sdk(http_resp->resp_code);
     retcode = APPD_IOT_ERR_NETWORK_REJECT;
   }
   else
   {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Resp Code:%d Send Beacons Network Request Failed", http_resp->resp_code);
+    appd_iot_log_with_fields(APPD_IOT_LOG_ERROR, appd_iot_log_resp_code_field(http_resp->resp_code),
+                             "Resp Code:%d Send Beacons Network Request Failed", http_resp->resp_code);
     retcode = APPD_IOT_ERR_NETWORK_ERROR;
   }
 
-  if (http_resp_done_cb != NULL)
-  {
-    http_resp_done_cb(http_resp);
-  }
-
   return retcode;
 }
 
 
 /**
- * @brief Serializes Data into JSON Format
- * @param json object which contains buffer to which serialized data is written to
- * @param data contains data_t object from which data properties are read
+ * @brief Updates self-telemetry counters with outcome of sending a beacon
+ * @param retcode contains result of reading http response of the beacon
+ * @param event_count contains number of events in the beacon
+ * @param jsonlen contains length of serialized beacon
  */
-static void appd_iot_serialize_properties_data_to_json(json_t* json, data_t* data)
+static void appd_iot_stats_beacon_sent(appd_iot_error_code_t retcode, size_t event_count, size_t jsonlen)
 {
-  if (json == NULL)
+  if (retcode == APPD_IOT_SUCCESS)
   {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Serializing Properties failed due to NULL json Object");
+    appd_iot_stats_add(APPD_IOT_STAT_BEACONS_SENT, 1);
+    appd_iot_stats_add(APPD_IOT_STAT_EVENTS_SENT, event_count);
+    appd_iot_stats_add(APPD_IOT_STAT_BYTES_SENT, jsonlen);
     return;
   }
 
-  if (data == NULL)
+  appd_iot_stats_add(APPD_IOT_STAT_BEACON_SEND_FAILURES, 1);
+
+  //rejected beacons are cleared, others are kept to be sent again
+  if (retcode != APPD_IOT_ERR_NETWORK_REJECT)
   {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Serializing Properties failed due to NULL data Object");
-    return;
+    appd_iot_stats_add(APPD_IOT_STAT_EVENTS_REQUEUED, event_count);
   }
+}
 
-  if (!data->stringmap.empty())
+
+/**
+ * @brief Records time spent in each phase of a successful send, if enabled in SDK config.
+ * Timing is added as custom event by the next send which has other events, so that a device
+ * with nothing to report does not keep sending timing of its previous send.
+ * @param timer of the send
+ * @param event_count contains number of events sent
+ * @param jsonlen contains length of serialized beacons sent
+ */
+static void appd_iot_record_send_timing(const appd_iot_send_timer_t* timer, size_t event_count, size_t jsonlen)
+{
+  if (!appd_iot_get_send_timing_events())
   {
-    appd_iot_json_start_object(json, "stringProperties");
+    return;
+  }
+
+  global_send_timing.pending = true;
+  global_send_timing.timestamp_ms = appd_iot_clock_get_time_ms();
+  global_send_timing.timer = *timer;
+  global_send_timing.event_count = event_count;
+  global_send_timing.jsonlen = jsonlen;
+}
+
+
+/**
+ * @brief Adds custom event with timing recorded by the previous successful send, if any.
+ * Must be called only when other events are present in the beacon.
+ */
+static void appd_iot_add_pending_send_timing_event(void)
+{
+  if (!global_send_timing.pending)
+  {
+    return;
+  }
+
+  global_send_timing.pending = false;
+
+  if (!appd_iot_get_send_timing_events() || appd_iot_get_sdk_state() != APPD_IOT_SDK_ENABLED)
+  {
+    return;
+  }
+
+  const appd_iot_send_timer_t* timer = &global_send_timing.timer;
+  custom_event_t event;
+  uint64_t total_us = 0;
+
+  event.type = APPD_IOT_SEND_TIMING_EVENT_TYPE;
+  event.summary = "Time spent in each phase of sending events to collector";
+  event.timestamp_ms = global_send_timing.timestamp_ms;
+
+  for (int i = 0; i < APPD_IOT_MAX_HISTOGRAMS; i++)
+  {
+    total_us += timer->phase_us[i];
+  }
+
+  event.duration_ms = (int)(total_us / 1000);
+
+  event.data.integermap["Snapshot Time us"] = timer->phase_us[APPD_IOT_HISTOGRAM_SNAPSHOT];
+  event.data.integermap["Serialize Time us"] = timer->phase_us[APPD_IOT_HISTOGRAM_SERIALIZE];
+  event.data.integermap["Transport Time us"] = timer->phase_us[APPD_IOT_HISTOGRAM_TRANSPORT];
+  event.data.integermap["Response Time us"] = timer->phase_us[APPD_IOT_HISTOGRAM_RESPONSE];
+  event.data.integermap["Clear Time us"] = timer->phase_us[APPD_IOT_HISTOGRAM_CLEAR];
+  event.data.integermap["Total Time us"] = total_us;
+  event.data.integermap["Events Sent"] = global_send_timing.event_count;
+  event.data.integermap["Bytes Sent"] = global_send_timing.jsonlen;
+
+  appd_iot_add_custom_event_to_beacon(&event);
+}
+
+
+/**
+  * @brief Sends Beacons in memory to collector. <br>
+  * Max Limit on the number of events of all types in the beacon is defined by APPD_IOT_MAX_EVENTS
+  * @return appd_iot_error_code_t indicating function execution status
+  */
+appd_iot_error_code_t appd_iot_send_all_beacons(void)
+{
+
+  if (appd_iot_get_beacon_event_count(&global_beacon) == 0)
+  {
+    appd_iot_log(APPD_IOT_LOG_INFO, "No Events Present");
+    return APPD_IOT_SUCCESS;
+  }
+
+  appd_iot_add_pending_send_timing_event();
+
+  appd_iot_send_timer_t timer;
+
+  appd_iot_send_timer_start(&timer);
+
+  appd_iot_log(APPD_IOT_LOG_INFO, "Sending All Beacons");
+  appd_iot_log(APPD_IOT_LOG_INFO, "Sending %lu Custom Events",
+               (unsigned long)appd_iot_get_beacon_event_type_count(&global_beacon, APPD_IOT_EVENT_TYPE_CUSTOM));
+  appd_iot_log(APPD_IOT_LOG_INFO, "Sending %lu Network Events",
+               (unsigned long)appd_iot_get_beacon_event_type_count(&global_beacon, APPD_IOT_EVENT_TYPE_NETWORK_REQUEST));
+  appd_iot_log(APPD_IOT_LOG_INFO, "Sending %lu Error Events",
+               (unsigned long)appd_iot_get_beacon_event_type_count(&global_beacon, APPD_IOT_EVENT_TYPE_ERROR));
+
+  /* Init all the data structures - REQ and RESP */
+  appd_iot_http_req_t http_req;
+  appd_iot_http_resp_t* http_resp = NULL;
+  appd_iot_data_t http_req_headers[APPD_IOT_BEACON_HTTP_HEADERS_COUNT];
+  char jsonlen_buf[24];
+  std::string jsondata;
+  appd_iot_error_code_t retcode = APPD_IOT_SUCCESS;
+  appd_iot_http_req_send_cb_t http_req_send_cb = appd_iot_get_http_req_send_cb();
+  appd_iot_http_resp_done_cb_t http_resp_done_cb = appd_iot_get_http_resp_done_cb();
+
+  if (http_req_send_cb == NULL)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Network Interface Not Available");
+    return APPD_IOT_ERR_NETWORK_NOT_AVAILABLE;
+  }
+
+  size_t event_count = appd_iot_get_beacon_event_count(&global_beacon);
+
+  appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_SNAPSHOT);
+
+  jsondata = appd_iot_serialize_beacon_to_json(&global_beacon);
+
+  appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_SERIALIZE);
+  appd_iot_stats_add(APPD_IOT_STAT_BYTES_SERIALIZED, jsondata.length());
+
+  if (jsondata.empty())
+  {
+    appd_iot_send_timer_stop(&timer);
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Failed to Serialize Data to JSON Format");
+    return APPD_IOT_ERR_NULL_PTR;
+  }
+
+  appd_iot_init_beacon_http_req(&http_req, http_req_headers, jsonlen_buf, sizeof(jsonlen_buf), jsondata);
+
+  appd_iot_log(APPD_IOT_LOG_INFO, "Content Len:%lu", (unsigned long)jsondata.length());
+
+  appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_SERIALIZE);
+
+  http_resp = http_req_send_cb(&http_req);
+
+  appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_TRANSPORT);
+
+  retcode = appd_iot_read_beacon_http_resp(http_resp);
+
+  appd_iot_stats_beacon_sent(retcode, event_count, jsondata.length());
+  appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_RESPONSE);
+
+  if (retcode == APPD_IOT_SUCCESS)
+  {
+    appd_iot_clear_all_beacons();
+  }
+  else if (retcode == APPD_IOT_ERR_NETWORK_REJECT)
+  {
+    appd_iot_clear_all_beacons();
+    appd_iot_disable_sdk(http_resp->resp_code);
+  }
+
+  appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_CLEAR);
+
+  if (http_resp_done_cb != NULL)
+  {
+    http_resp_done_cb(http_resp);
+  }
+
+  appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_RESPONSE);
+  appd_iot_send_timer_stop(&timer);
+
+  if (retcode == APPD_IOT_SUCCESS)
+  {
+    appd_iot_record_send_timing(&timer, event_count, jsondata.length());
+  }
+
+  return retcode;
+}
+
+
+/**
+ * @brief Moves events from the front of src array to the end of dest array without copying them
+ * @param dest array to which events are moved to
+ * @param src array from which events are moved from
+ * @param max_events contains maximum number of events to be moved
+ * @return number of events moved
+ */
+template <typename event_t>
+static size_t appd_iot_move_events(std::vector<event_t>* dest, std::vector<event_t>* src, size_t max_events)
+{
+  size_t count = std::min(src->size(), max_events);
+
+  appd_iot_reserve_events(dest, dest->size() + count);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    dest->push_back(event_t());
+    appd_iot_swap_event(&dest->back(), &(*src)[i]);
+  }
+
+  //events left in src are shifted to the front, moved out events end up at the back and are dropped
+  for (size_t i = count; i < src->size(); i++)
+  {
+    appd_iot_swap_event(&(*src)[i - count], &(*src)[i]);
+  }
+
+  src->erase(src->end() - count, src->end());
+
+  return count;
+}
+
+
+/**
+ * @brief Moves all events of src array to the front of dest array without copying them
+ * @param dest array to which events are moved to
+ * @param src array from which events are moved from
+ */
+template <typename event_t>
+static void appd_iot_prepend_events(std::vector<event_t>* dest, std::vector<event_t>* src)
+{
+  size_t count = src->size();
+  size_t size = dest->size();
+
+  if (count == 0)
+  {
+    return;
+  }
+
+  appd_iot_reserve_events(dest, size + count);
+  dest->resize(size + count);
+
+  //events of dest are shifted back to make room for src events at the front
+  for (size_t i = size; i > 0; i--)
+  {
+    appd_iot_swap_event(&(*dest)[i - 1 + count], &(*dest)[i - 1]);
+  }
+
+  for (size_t i = 0; i < count; i++)
+  {
+    appd_iot_swap_event(&(*dest)[i], &(*src)[i]);
+  }
+
+  src->clear();
+}
+
+
+/**
+ * @brief Moves serialized events from the front of src to the end of dest
+ * @param dest to which serialized events are moved to
+ * @param src from which serialized events are moved from
+ * @param max_events contains maximum number of events to be moved
+ * @return number of events moved
+ */
+static size_t appd_iot_move_serialized_events(serialized_events_t* dest, serialized_events_t* src,
+    size_t max_events)
+{
+  size_t count = std::min(src->ends.size(), max_events);
+
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  size_t len = src->ends[count - 1];
+  size_t offset = dest->json.length();
+
+  if (!dest->json.empty())
+  {
+    dest->json += ',';
+    offset++;
+  }
+
+  dest->json.append(src->json, 0, len);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    dest->ends.push_back(offset + src->ends[i]);
+  }
+
+  //events left in src are shifted to the front along with the comma before them
+  size_t erase_len = (count < src->ends.size()) ? len + 1 : len;
+
+  src->json.erase(0, erase_len);
+
+  for (size_t i = count; i < src->ends.size(); i++)
+  {
+    src->ends[i] -= erase_len;
+  }
+
+  src->ends.erase(src->ends.begin(), src->ends.begin() + count);
+
+  return count;
+}
+
+
+/**
+ * @brief Moves all serialized events of src to the front of dest
+ * @param dest to which serialized events are moved to
+ * @param src from which serialized events are moved from
+ */
+static void appd_iot_prepend_serialized_events(serialized_events_t* dest, serialized_events_t* src)
+{
+  if (src->ends.empty())
+  {
+    return;
+  }
+
+  if (!dest->ends.empty())
+  {
+    size_t offset = src->json.length() + 1;
+
+    for (size_t i = 0; i < dest->ends.size(); i++)
+    {
+      dest->ends[i] += offset;
+    }
+
+    src->json += ',';
+    src->json += dest->json;
+    src->ends.insert(src->ends.end(), dest->ends.begin(), dest->ends.end());
+  }
+
+  dest->json.swap(src->json);
+  dest->ends.swap(src->ends);
+
+  src->json.clear();
+  src->ends.clear();
+}
+
+
+/**
+ * @brief Moves oldest events of global beacon, of any type, into chunk beacon
+ * @param chunk to which events are moved to
+ * @param max_events contains maximum number of events to be moved
+ */
+static void appd_iot_move_events_to_chunk(beacon_t* chunk, size_t max_events)
+{
+  std::vector<event_type_t>& timeline = global_beacon.timeline;
+  size_t count = std::min(timeline.size(), max_events);
+  size_t type_count[APPD_IOT_EVENT_TYPE_COUNT] = {0};
+
+  chunk->devcfg = global_beacon.devcfg;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    type_count[timeline[i]]++;
+  }
+
+  chunk->timeline.insert(chunk->timeline.end(), timeline.begin(), timeline.begin() + count);
+  timeline.erase(timeline.begin(), timeline.begin() + count);
+
+  //serialized events of a type are older than the others, so they are moved first
+  for (int type = 0; type < APPD_IOT_EVENT_TYPE_COUNT; type++)
+  {
+    type_count[type] -= appd_iot_move_serialized_events(&chunk->serialized_events[type],
+                        &global_beacon.serialized_events[type], type_count[type]);
+  }
+
+  appd_iot_move_events(&chunk->custom_events, &global_beacon.custom_events,
+                       type_count[APPD_IOT_EVENT_TYPE_CUSTOM]);
+  appd_iot_move_events(&chunk->network_request_events, &global_beacon.network_request_events,
+                       type_count[APPD_IOT_EVENT_TYPE_NETWORK_REQUEST]);
+  appd_iot_move_events(&chunk->error_events, &global_beacon.error_events,
+                       type_count[APPD_IOT_EVENT_TYPE_ERROR]);
+}
+
+
+/**
+ * @brief Moves events of chunk beacon back to the front of global beacon
+ * @param chunk from which events are moved from
+ */
+static void appd_iot_restore_events_from_chunk(beacon_t* chunk)
+{
+  global_beacon.timeline.insert(global_beacon.timeline.begin(), chunk->timeline.begin(), chunk->timeline.end());
+  chunk->timeline.clear();
+
+  appd_iot_prepend_events(&global_beacon.custom_events, &chunk->custom_events);
+  appd_iot_prepend_events(&global_beacon.network_request_events, &chunk->network_request_events);
+  appd_iot_prepend_events(&global_beacon.error_events, &chunk->error_events);
+
+  for (int type = 0; type < APPD_IOT_EVENT_TYPE_COUNT; type++)
+  {
+    appd_iot_prepend_serialized_events(&global_beacon.serialized_events[type], &chunk->serialized_events[type]);
+  }
+}
+
+
+/**
+ * @brief Moves events of chunk beacons back to the front of global beacon, in the order they were added
+ * @param chunks from which events are moved from, in the order they were moved into them
+ */
+static void appd_iot_restore_events_from_chunks(std::list<beacon_chunk_t>* chunks)
+{
+  for (std::list<beacon_chunk_t>::reverse_iterator rit = chunks->rbegin(); rit != chunks->rend(); ++rit)
+  {
+    appd_iot_restore_events_from_chunk(&rit->beacon);
+  }
+
+  chunks->clear();
+}
+
+
+/**
+  * @brief Sends Beacons in memory to collector, split into beacons of at most
+  * max_events_per_beacon events. Up to max_requests_in_flight beacons are sent at once
+  * using http batch send callback. If batch send callback is not registered, beacons are
+  * sent one at a time using http send callback. <br>
+  * Each beacon is acknowledged independently. Beacons which fail to be sent are kept in memory,
+  * in the order they were added, and draining stops after the batch in which failure occurred.
+  * @param max_events_per_beacon contains maximum number of events in a single beacon
+  * @return appd_iot_error_code_t indicating function execution status
+  */
+appd_iot_error_code_t appd_iot_drain_all_beacons(int max_events_per_beacon)
+{
+  if (appd_iot_get_beacon_event_count(&global_beacon) == 0)
+  {
+    appd_iot_log(APPD_IOT_LOG_INFO, "No Events Present");
+    return APPD_IOT_SUCCESS;
+  }
+
+  appd_iot_add_pending_send_timing_event();
+
+  appd_iot_http_pipeline_cb_t http_pipeline_cb = appd_iot_get_http_pipeline_cb();
+  appd_iot_http_req_send_cb_t http_req_send_cb = appd_iot_get_http_req_send_cb();
+  appd_iot_http_resp_done_cb_t http_resp_done_cb = appd_iot_get_http_resp_done_cb();
+  int max_requests_in_flight = 1;
+
+  if (http_pipeline_cb.http_req_send_batch_cb != NULL)
+  {
+    max_requests_in_flight = http_pipeline_cb.max_requests_in_flight;
+    http_resp_done_cb = http_pipeline_cb.http_resp_done_cb;
+  }
+  else if (http_req_send_cb == NULL)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Network Interface Not Available");
+    return APPD_IOT_ERR_NETWORK_NOT_AVAILABLE;
+  }
+
+  appd_iot_log(APPD_IOT_LOG_INFO, "Draining %lu Events, Max Events per Beacon:%d, Max Beacons in Flight:%d",
+               (unsigned long)appd_iot_get_beacon_event_count(&global_beacon), max_events_per_beacon,
+               max_requests_in_flight);
+
+  appd_iot_error_code_t retcode = APPD_IOT_SUCCESS;
+  int reject_resp_code = 0;
+  size_t sent_event_count = 0;
+  size_t sent_bytes = 0;
+  appd_iot_send_timer_t timer;
+
+  appd_iot_send_timer_start(&timer);
+
+  while (retcode == APPD_IOT_SUCCESS && appd_iot_get_beacon_event_count(&global_beacon) > 0)
+  {
+    /* chunks are kept in a list so that the events moved into them are never copied */
+    std::list<beacon_chunk_t> chunks;
+    std::list<beacon_chunk_t> failed_chunks;
+    std::list<beacon_chunk_t>::iterator it;
+
+    for (int i = 0; i < max_requests_in_flight && appd_iot_get_beacon_event_count(&global_beacon) > 0; i++)
+    {
+      chunks.push_back(beacon_chunk_t());
+
+      beacon_chunk_t& chunk = chunks.back();
+
+      appd_iot_move_events_to_chunk(&chunk.beacon, max_events_per_beacon);
+
+      appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_SNAPSHOT);
+
+      chunk.jsondata = appd_iot_serialize_beacon_to_json(&chunk.beacon);
+
+      appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_SERIALIZE);
+      appd_iot_stats_add(APPD_IOT_STAT_BYTES_SERIALIZED, chunk.jsondata.length());
+
+      if (chunk.jsondata.empty())
+      {
+        appd_iot_log(APPD_IOT_LOG_ERROR, "Failed to Serialize Data to JSON Format");
+        retcode = APPD_IOT_ERR_NULL_PTR;
+        break;
+      }
+    }
+
+    /* events of a batch which could not be serialized are kept to be sent again */
+    if (retcode != APPD_IOT_SUCCESS)
+    {
+      appd_iot_restore_events_from_chunks(&chunks);
+      break;
+    }
+
+    int http_req_count = (int)chunks.size();
+    std::vector<appd_iot_http_req_t> http_reqs(http_req_count);
+    std::vector<appd_iot_http_resp_t*> http_resps(http_req_count, (appd_iot_http_resp_t*)NULL);
+
+    it = chunks.begin();
+
+    for (int i = 0; i < http_req_count; i++, ++it)
+    {
+      appd_iot_init_beacon_http_req(&http_reqs[i], it->headers, it->jsonlen_buf, sizeof(it->jsonlen_buf),
+                                    it->jsondata);
+    }
+
+    appd_iot_log(APPD_IOT_LOG_INFO, "Sending %d Beacons", http_req_count);
+
+    appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_SERIALIZE);
+
+    if (http_pipeline_cb.http_req_send_batch_cb != NULL)
+    {
+      http_pipeline_cb.http_req_send_batch_cb(&http_reqs[0], &http_resps[0], http_req_count);
+    }
+    else
+    {
+      http_resps[0] = http_req_send_cb(&http_reqs[0]);
+    }
+
+    appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_TRANSPORT);
+
+    /* Acknowledge each beacon independently */
+    it = chunks.begin();
+
+    for (int i = 0; i < http_req_count; i++)
+    {
+      std::list<beacon_chunk_t>::iterator chunk_it = it++;
+      appd_iot_error_code_t chunk_retcode = appd_iot_read_beacon_http_resp(http_resps[i]);
+
+      appd_iot_stats_beacon_sent(chunk_retcode, appd_iot_get_beacon_event_count(&chunk_it->beacon),
+                                 chunk_it->jsondata.length());
+
+      if (chunk_retcode == APPD_IOT_SUCCESS)
+      {
+        appd_iot_log(APPD_IOT_LOG_INFO, "Beacon %d of %d Sent with %lu Events", i + 1, http_req_count,
+                     (unsigned long)appd_iot_get_beacon_event_count(&chunk_it->beacon));
+
+        sent_event_count += appd_iot_get_beacon_event_count(&chunk_it->beacon);
+        sent_bytes += chunk_it->jsondata.length();
+      }
+      else
+      {
+        if (chunk_retcode == APPD_IOT_ERR_NETWORK_REJECT)
+        {
+          reject_resp_code = http_resps[i]->resp_code;
+        }
+
+        if (retcode == APPD_IOT_SUCCESS || chunk_retcode == APPD_IOT_ERR_NETWORK_REJECT)
+        {
+          retcode = chunk_retcode;
+        }
+
+        failed_chunks.splice(failed_chunks.end(), chunks, chunk_it);
+      }
+
+      if (http_resp_done_cb != NULL)
+      {
+        http_resp_done_cb(http_resps[i]);
+      }
+    }
+
+    appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_RESPONSE);
+
+    /* Put back events of failed beacons in the order they were added */
+    appd_iot_restore_events_from_chunks(&failed_chunks);
+    chunks.clear();
+
+    appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_CLEAR);
+  }
+
+  if (retcode == APPD_IOT_ERR_NETWORK_REJECT)
+  {
+    appd_iot_clear_all_beacons();
+    appd_iot_disable_sdk(reject_resp_code);
+    appd_iot_send_timer_phase(&timer, APPD_IOT_HISTOGRAM_CLEAR);
+  }
+
+  appd_iot_send_timer_stop(&timer);
+
+  if (retcode == APPD_IOT_SUCCESS)
+  {
+    appd_iot_record_send_timing(&timer, sent_event_count, sent_bytes);
+  }
+
+  return retcode;
+}
+
+
+//Functions below serialize beacons to json
+#undef APPD_IOT_LOG_SUBSYSTEM
+#define APPD_IOT_LOG_SUBSYSTEM APPD_IOT_LOG_SUBSYSTEM_SERIALIZER
+
+
+/**
+ * @brief Serializes Data into JSON Format
+ * @param json object which contains buffer to which serialized data is written to
+ * @param data contains data_t object from which data properties are read
+ */
+static void appd_iot_serialize_properties_data_to_json(json_t* json, data_t* data)
+{
+  if (json == NULL)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Serializing Properties failed due to NULL json Object");
+    return;
+  }
+
+  if (data == NULL)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Serializing Properties failed due to NULL data Object");
+    return;
+  }
+
+  if (!data->stringmap.empty())
+  {
+    appd_iot_json_start_object(json, "stringProperties");
 
     for (std::map<std::string, std::string>::iterator it = data->stringmap.begin();
          it != data->stringmap.end(); ++it)
@@ -433,299 +1444,384 @@ static void appd_iot_serialize_properties_data_to_json(json_t* json, data_t* dat
 
 
 /**
-  * @brief Serializes Beacon Data into JSON Format
-  * @param beacon contains beacon data to be serialized
-  * @return string which contains json formatted data
-  */
-static std::string appd_iot_serialize_beacon_to_json(beacon_t beacon)
+ * @brief Serializes Custom Event into JSON Format
+ * @param json object to which serialized event is written to, as an element of the event array
+ * @param event contains event to be serialized
+ */
+static void appd_iot_serialize_custom_event_to_json(json_t* json, custom_event_t* event)
 {
-  /* Initialize JSON */
-  json_t* json = appd_iot_json_init();
-
-  appd_iot_json_start_array(json, NULL);
   appd_iot_json_start_object(json, NULL);
 
-  /* Set SDK Version */
-  appd_iot_json_add_string_key_value(json, "agentVersion", APPD_IOT_SDK_VERSION);
+  if (!event->type.empty())
+  {
+    appd_iot_json_add_string_key_value(json, "eventType", event->type.c_str());
+  }
 
-  /* Start Device Config Processing */
-  if (!(beacon.devcfg.device_id.empty() &&
-        beacon.devcfg.device_name.empty() &&
-        beacon.devcfg.device_type.empty()))
+  if (!event->summary.empty())
   {
-    appd_iot_json_start_object(json, "deviceInfo");
+    appd_iot_json_add_string_key_value(json, "eventSummary", event->summary.c_str());
+  }
 
-    /* Start Device Config Processing */
-    if (!beacon.devcfg.device_id.empty())
-    {
-      appd_iot_json_add_string_key_value(json, "deviceId", beacon.devcfg.device_id.c_str());
-    }
+  if (event->timestamp_ms != 0)
+  {
+    appd_iot_json_add_integer_key_value(json, "timestamp", event->timestamp_ms);
+  }
 
-    if (!beacon.devcfg.device_name.empty())
-    {
-      appd_iot_json_add_string_key_value(json, "deviceName", beacon.devcfg.device_name.c_str());
-    }
+  if (event->duration_ms > 0)
+  {
+    appd_iot_json_add_integer_key_value(json, "duration", event->duration_ms);
+  }
 
-    if (!beacon.devcfg.device_type.empty())
-    {
-      appd_iot_json_add_string_key_value(json, "deviceType", beacon.devcfg.device_type.c_str());
-    }
+  appd_iot_serialize_properties_data_to_json(json, &event->data);
 
-    appd_iot_json_end_object(json);
+  appd_iot_json_end_object(json);
+}
+
+
+/**
+ * @brief Serializes Network Request Event into JSON Format
+ * @param json object to which serialized event is written to, as an element of the event array
+ * @param event contains event to be serialized
+ */
+static void appd_iot_serialize_network_request_event_to_json(json_t* json, network_request_event_t* event)
+{
+  appd_iot_json_start_object(json, NULL);
+
+  appd_iot_json_add_string_key_value(json, "url", event->url.c_str());
+
+  if (event->resp_code != 0)
+  {
+    appd_iot_json_add_integer_key_value(json, "statusCode", event->resp_code);
   }
 
-  if (!(beacon.devcfg.hw_version.empty() &&
-        beacon.devcfg.fw_version.empty() &&
-        beacon.devcfg.sw_version.empty() &&
-        beacon.devcfg.os_version.empty()))
+  if (!event->error.empty())
   {
-    appd_iot_json_start_object(json, "versionInfo");
+    appd_iot_json_add_string_key_value(json, "networkError", event->error.c_str());
+  }
 
-    if (!beacon.devcfg.hw_version.empty())
-    {
-      appd_iot_json_add_string_key_value(json, "hardwareVersion", beacon.devcfg.hw_version.c_str());
-    }
+  if (event->req_content_length > 0)
+  {
+    appd_iot_json_add_integer_key_value(json, "requestContentLength", event->req_content_length);
+  }
 
-    if (!beacon.devcfg.fw_version.empty())
-    {
-      appd_iot_json_add_string_key_value(json, "firmwareVersion", beacon.devcfg.fw_version.c_str());
-    }
+  if (event->resp_content_length > 0)
+  {
+    appd_iot_json_add_integer_key_value(json, "responseContentLength", event->resp_content_length);
+  }
 
-    if (!beacon.devcfg.sw_version.empty())
-    {
-      appd_iot_json_add_string_key_value(json, "softwareVersion", beacon.devcfg.sw_version.c_str());
-    }
+  if (event->timestamp_ms != 0)
+  {
+    appd_iot_json_add_integer_key_value(json, "timestamp", event->timestamp_ms);
+  }
+
+  if (event->duration_ms > 0)
+  {
+    appd_iot_json_add_integer_key_value(json, "duration", event->duration_ms);
+  }
+
+  //Response Headers are expected to have {key, value} pairs as strings
+  if (!(event->resp_headers.stringmap.empty()))
+  {
+    appd_iot_json_start_object(json, "responseHeaders");
 
-    if (!beacon.devcfg.os_version.empty())
+    for (std::map<std::string, std::string>::iterator resp_header_it = event->resp_headers.stringmap.begin();
+         resp_header_it != event->resp_headers.stringmap.end(); ++resp_header_it)
     {
-      appd_iot_json_add_string_key_value(json, "operatingSystemVersion", beacon.devcfg.os_version.c_str());
+      appd_iot_json_start_array(json, (resp_header_it->first).c_str());
+      appd_iot_json_add_string_value(json, (resp_header_it->second).c_str());
+      appd_iot_json_end_array(json);
     }
 
     appd_iot_json_end_object(json);
-  } /* End Device Config Processing */
-
-  /* Start Custom Event Processing */
-  if (beacon.custom_event_list.size() != 0)
-  {
-    std::list<custom_event_t>::iterator it = beacon.custom_event_list.begin();
-
-    appd_iot_json_start_array(json, "customEvents");
+  }
 
-    for (; it != beacon.custom_event_list.end(); ++it)
-    {
-      custom_event_t event = (custom_event_t)(*it);
+  appd_iot_serialize_properties_data_to_json(json, &event->data);
 
-      appd_iot_json_start_object(json, NULL);
+  appd_iot_json_end_object(json);
+}
 
-      if (!event.type.empty())
-      {
-        appd_iot_json_add_string_key_value(json, "eventType", event.type.c_str());
-      }
 
-      if (!event.summary.empty())
-      {
-        appd_iot_json_add_string_key_value(json, "eventSummary", event.summary.c_str());
-      }
+/**
+ * @brief Serializes Error Event into JSON Format
+ * @param json object to which serialized event is written to, as an element of the event array
+ * @param event contains event to be serialized
+ */
+static void appd_iot_serialize_error_event_to_json(json_t* json, error_event_t* event)
+{
+  appd_iot_json_start_object(json, NULL);
 
-      if (event.timestamp_ms != 0)
-      {
-        appd_iot_json_add_integer_key_value(json, "timestamp", event.timestamp_ms);
-      }
+  if (!event->name.empty())
+  {
+    appd_iot_json_add_string_key_value(json, "name", event->name.c_str());
+  }
 
-      if (event.duration_ms > 0)
-      {
-        appd_iot_json_add_integer_key_value(json, "duration", event.duration_ms);
-      }
+  if (!event->message.empty())
+  {
+    appd_iot_json_add_string_key_value(json, "message", event->message.c_str());
+  }
 
-      appd_iot_serialize_properties_data_to_json(json, &event.data);
+  if (!event->severity.empty())
+  {
+    appd_iot_json_add_string_key_value(json, "severity", event->severity.c_str());
+  }
 
-      appd_iot_json_end_object(json);
-    }
+  if (event->timestamp_ms != 0)
+  {
+    appd_iot_json_add_integer_key_value(json, "timestamp", event->timestamp_ms);
+  }
 
-    appd_iot_json_end_array(json);
-  } /* End Custom Event Processing */
+  if (event->duration_ms > 0)
+  {
+    appd_iot_json_add_integer_key_value(json, "duration", event->duration_ms);
+  }
 
-  /* Start Network Event Processing */
-  if (beacon.network_request_event_list.size() != 0)
+  if (!event->stack_traces.empty())
   {
-    std::list<network_request_event_t>::iterator it = beacon.network_request_event_list.begin();
+    appd_iot_json_add_integer_key_value(json, "errorStackTraceIndex", event->error_stack_trace_index);
 
-    appd_iot_json_start_array(json, "networkRequestEvents");
+    appd_iot_json_start_array(json, "stackTraces");
 
-    for (; it != beacon.network_request_event_list.end(); ++it)
+    //loop over stack traces
+    for (size_t j = 0; j < event->stack_traces.size(); j++)
     {
-      network_request_event_t event = (network_request_event_t)(*it);
+      const stack_trace_t& stack_trace = event->stack_traces[j];
 
       appd_iot_json_start_object(json, NULL);
 
-      appd_iot_json_add_string_key_value(json, "url", event.url.c_str());
+      appd_iot_json_add_string_key_value(json, "thread", stack_trace.thread.c_str());
+      appd_iot_json_add_string_key_value(json, "runtime", stack_trace.runtime.c_str());
 
-      if (event.resp_code != 0)
+      if (stack_trace.stack_frame_count > 0)
       {
-        appd_iot_json_add_integer_key_value(json, "statusCode", event.resp_code);
-      }
+        appd_iot_json_start_array(json, "stackFrames");
 
-      if (!event.error.empty())
-      {
-        appd_iot_json_add_string_key_value(json, "networkError", event.error.c_str());
-      }
+        //loop over stack frames within a single stack trace, stored contiguously in the event
+        for (size_t k = 0; k < stack_trace.stack_frame_count; k++)
+        {
+          const stack_frame_t& stack_frame = event->stack_frames[stack_trace.stack_frame_index + k];
+          appd_iot_json_start_object(json, NULL);
 
-      if (event.req_content_length > 0)
-      {
-        appd_iot_json_add_integer_key_value(json, "requestContentLength", event.req_content_length);
-      }
+          if (!stack_frame.symbol_name.empty())
+          {
+            appd_iot_json_add_string_key_value(json, "symbolName", stack_frame.symbol_name.c_str());
+            appd_iot_json_add_integer_key_value(json, "symbolOffset", stack_frame.symbol_offset);
+          }
 
-      if (event.resp_content_length > 0)
-      {
-        appd_iot_json_add_integer_key_value(json, "responseContentLength", event.resp_content_length);
-      }
+          if (!stack_frame.package_name.empty())
+          {
+            appd_iot_json_add_string_key_value(json, "packageName", stack_frame.package_name.c_str());
+          }
 
-      if (event.timestamp_ms != 0)
-      {
-        appd_iot_json_add_integer_key_value(json, "timestamp", event.timestamp_ms);
-      }
+          if (!stack_frame.file_name.empty())
+          {
+            appd_iot_json_add_string_key_value(json, "filePath", stack_frame.file_name.c_str());
+          }
 
-      if (event.duration_ms > 0)
-      {
-        appd_iot_json_add_integer_key_value(json, "duration", event.duration_ms);
-      }
+          if (stack_frame.lineno > 0)
+          {
+            appd_iot_json_add_integer_key_value(json, "lineNumber", stack_frame.lineno);
+          }
 
-      //Response Headers are expected to have {key, value} pairs as strings
-      if (!(event.resp_headers.stringmap.empty()))
-      {
-        appd_iot_json_start_object(json, "responseHeaders");
+          appd_iot_json_add_integer_key_value(json, "absoluteAddress", stack_frame.absolute_addr);
+          appd_iot_json_add_integer_key_value(json, "imageOffset", stack_frame.image_offset);
 
-        for (std::map<std::string, std::string>::iterator resp_header_it = event.resp_headers.stringmap.begin();
-             resp_header_it != event.resp_headers.stringmap.end(); ++resp_header_it)
-        {
-          appd_iot_json_start_array(json, (resp_header_it->first).c_str());
-          appd_iot_json_add_string_value(json, (resp_header_it->second).c_str());
-          appd_iot_json_end_array(json);
+          appd_iot_json_end_object(json);
         }
 
-        appd_iot_json_end_object(json);
+        appd_iot_json_end_array(json);
       }
 
-      appd_iot_serialize_properties_data_to_json(json, &event.data);
-
       appd_iot_json_end_object(json);
     }
 
     appd_iot_json_end_array(json);
-  } /* End Network Event Processing */
+  }
+
+  appd_iot_serialize_properties_data_to_json(json, &event->data);
+
+  appd_iot_json_end_object(json);
+}
 
 
-  /* Start Error Event Processing */
-  if (beacon.error_event_list.size() != 0)
+/**
+ * @brief Serializes events of beacon into their per type JSON arrays, written directly to beacon object. <br>
+ * A single scan over beacon timeline counts events of each type. As events of a type are kept in their
+ * array in timeline order, n-th event of a type in timeline is at index n of its array, after events
+ * serialized when they were added, so each array is then written in order without further lookups.
+ * Events serialized when they were added are copied as is.
+ * @param json object of beacon to which event arrays are added
+ * @param beacon contains events to be serialized
+ * @return true on success, false if timeline does not match events or JSON could not be written
+ */
+static bool appd_iot_serialize_events_to_json(json_t* json, beacon_t* beacon)
+{
+  static const char* array_names[APPD_IOT_EVENT_TYPE_COUNT] =
   {
-    std::list<error_event_t>::iterator it = beacon.error_event_list.begin();
+    "customEvents", "networkRequestEvents", "errorEvents"
+  };
+  size_t type_count[APPD_IOT_EVENT_TYPE_COUNT] = {0};
+  size_t event_count[APPD_IOT_EVENT_TYPE_COUNT];
 
-    appd_iot_json_start_array(json, "errorEvents");
+  for (size_t i = 0; i < beacon->timeline.size(); i++)
+  {
+    event_type_t type = beacon->timeline[i];
 
-    for (; it != beacon.error_event_list.end(); ++it)
+    if (type >= APPD_IOT_EVENT_TYPE_COUNT)
     {
-      error_event_t event = (error_event_t)(*it);
+      appd_iot_log(APPD_IOT_LOG_ERROR, "Unknown event type:%d in beacon", (int)type);
+      return false;
+    }
 
-      appd_iot_json_start_object(json, NULL);
+    type_count[type]++;
+  }
 
-      if (!event.name.empty())
-      {
-        appd_iot_json_add_string_key_value(json, "name", event.name.c_str());
-      }
+  event_count[APPD_IOT_EVENT_TYPE_CUSTOM] = beacon->custom_events.size();
+  event_count[APPD_IOT_EVENT_TYPE_NETWORK_REQUEST] = beacon->network_request_events.size();
+  event_count[APPD_IOT_EVENT_TYPE_ERROR] = beacon->error_events.size();
 
-      if (!event.message.empty())
-      {
-        appd_iot_json_add_string_key_value(json, "message", event.message.c_str());
-      }
+  for (int type = 0; type < APPD_IOT_EVENT_TYPE_COUNT; type++)
+  {
+    serialized_events_t* serialized = &beacon->serialized_events[type];
 
-      if (!event.severity.empty())
-      {
-        appd_iot_json_add_string_key_value(json, "severity", event.severity.c_str());
-      }
+    if (type_count[type] != serialized->ends.size() + event_count[type])
+    {
+      appd_iot_log(APPD_IOT_LOG_ERROR, "Beacon timeline has %lu events of type %s, expected %lu",
+                   (unsigned long)type_count[type], array_names[type],
+                   (unsigned long)(serialized->ends.size() + event_count[type]));
+      return false;
+    }
 
-      if (event.timestamp_ms != 0)
-      {
-        appd_iot_json_add_integer_key_value(json, "timestamp", event.timestamp_ms);
-      }
+    if (type_count[type] == 0)
+    {
+      continue;
+    }
 
-      if (event.duration_ms > 0)
-      {
-        appd_iot_json_add_integer_key_value(json, "duration", event.duration_ms);
-      }
+    if (appd_iot_json_start_array(json, array_names[type]) != APPD_IOT_SUCCESS)
+    {
+      return false;
+    }
+
+    if (!serialized->ends.empty() &&
+        appd_iot_json_add_json_value(json, serialized->json.c_str(), serialized->json.length()) != APPD_IOT_SUCCESS)
+    {
+      return false;
+    }
 
-      if (!event.stack_trace_list.empty())
+    for (size_t n = 0; n < event_count[type]; n++)
+    {
+      switch (type)
       {
-        std::list<stack_trace_t>::iterator stack_trace_it = event.stack_trace_list.begin();
+        case APPD_IOT_EVENT_TYPE_CUSTOM:
+          appd_iot_serialize_custom_event_to_json(json, &beacon->custom_events[n]);
+          break;
 
-        appd_iot_json_add_integer_key_value(json, "errorStackTraceIndex", event.error_stack_trace_index);
+        case APPD_IOT_EVENT_TYPE_NETWORK_REQUEST:
+          appd_iot_serialize_network_request_event_to_json(json, &beacon->network_request_events[n]);
+          break;
 
-        appd_iot_json_start_array(json, "stackTraces");
+        case APPD_IOT_EVENT_TYPE_ERROR:
+          appd_iot_serialize_error_event_to_json(json, &beacon->error_events[n]);
+          break;
 
-        //loop over stack traces
-        for (; stack_trace_it != event.stack_trace_list.end(); ++stack_trace_it)
-        {
-          stack_trace_t stack_trace = (stack_trace_t)(*stack_trace_it);
+        default:
+          break;
+      }
+    }
 
-          appd_iot_json_start_object(json, NULL);
+    if (appd_iot_json_end_array(json) != APPD_IOT_SUCCESS)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
 
-          appd_iot_json_add_string_key_value(json, "thread", stack_trace.thread.c_str());
-          appd_iot_json_add_string_key_value(json, "runtime", stack_trace.runtime.c_str());
 
-          if (!(stack_trace.stack_frame_list.empty()))
-          {
-            std::list<stack_frame_t>::iterator stack_frame_it = stack_trace.stack_frame_list.begin();
+/**
+  * @brief Serializes Beacon Data into JSON Format
+  * @param beacon contains beacon data to be serialized
+  * @return string which contains json formatted data
+  */
+static std::string appd_iot_serialize_beacon_to_json(beacon_t* beacon)
+{
+  /* Initialize JSON */
+  json_t* json = appd_iot_json_init();
 
-            appd_iot_json_start_array(json, "stackFrames");
+  if (json == NULL)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Failed to allocate JSON Object for Beacon");
+    return std::string();
+  }
 
-            //loop over stack frames within a single stack trace
-            for (; stack_frame_it != stack_trace.stack_frame_list.end(); ++stack_frame_it)
-            {
-              stack_frame_t stack_frame = (stack_frame_t)(*stack_frame_it);
-              appd_iot_json_start_object(json, NULL);
+  appd_iot_json_start_array(json, NULL);
+  appd_iot_json_start_object(json, NULL);
 
-              if (!stack_frame.symbol_name.empty())
-              {
-                appd_iot_json_add_string_key_value(json, "symbolName", stack_frame.symbol_name.c_str());
-                appd_iot_json_add_integer_key_value(json, "symbolOffset", stack_frame.symbol_offset);
-              }
+  /* Set SDK Version */
+  appd_iot_json_add_string_key_value(json, "agentVersion", APPD_IOT_SDK_VERSION);
 
-              if (!stack_frame.package_name.empty())
-              {
-                appd_iot_json_add_string_key_value(json, "packageName", stack_frame.package_name.c_str());
-              }
+  /* Start Device Config Processing */
+  if (!(beacon->devcfg.device_id.empty() &&
+        beacon->devcfg.device_name.empty() &&
+        beacon->devcfg.device_type.empty()))
+  {
+    appd_iot_json_start_object(json, "deviceInfo");
 
-              if (!stack_frame.file_name.empty())
-              {
-                appd_iot_json_add_string_key_value(json, "filePath", stack_frame.file_name.c_str());
-              }
+    /* Start Device Config Processing */
+    if (!beacon->devcfg.device_id.empty())
+    {
+      appd_iot_json_add_string_key_value(json, "deviceId", beacon->devcfg.device_id.c_str());
+    }
 
-              if (stack_frame.lineno > 0)
-              {
-                appd_iot_json_add_integer_key_value(json, "lineNumber", stack_frame.lineno);
-              }
+    if (!beacon->devcfg.device_name.empty())
+    {
+      appd_iot_json_add_string_key_value(json, "deviceName", beacon->devcfg.device_name.c_str());
+    }
 
-              appd_iot_json_add_integer_key_value(json, "absoluteAddress", stack_frame.absolute_addr);
-              appd_iot_json_add_integer_key_value(json, "imageOffset", stack_frame.image_offset);
+    if (!beacon->devcfg.device_type.empty())
+    {
+      appd_iot_json_add_string_key_value(json, "deviceType", beacon->devcfg.device_type.c_str());
+    }
 
-              appd_iot_json_end_object(json);
-            }
+    appd_iot_json_end_object(json);
+  }
 
-            appd_iot_json_end_array(json);
-          }
+  if (!(beacon->devcfg.hw_version.empty() &&
+        beacon->devcfg.fw_version.empty() &&
+        beacon->devcfg.sw_version.empty() &&
+        beacon->devcfg.os_version.empty()))
+  {
+    appd_iot_json_start_object(json, "versionInfo");
 
-          appd_iot_json_end_object(json);
-        }
+    if (!beacon->devcfg.hw_version.empty())
+    {
+      appd_iot_json_add_string_key_value(json, "hardwareVersion", beacon->devcfg.hw_version.c_str());
+    }
 
-        appd_iot_json_end_array(json);
-      }
+    if (!beacon->devcfg.fw_version.empty())
+    {
+      appd_iot_json_add_string_key_value(json, "firmwareVersion", beacon->devcfg.fw_version.c_str());
+    }
 
-      appd_iot_serialize_properties_data_to_json(json, &event.data);
+    if (!beacon->devcfg.sw_version.empty())
+    {
+      appd_iot_json_add_string_key_value(json, "softwareVersion", beacon->devcfg.sw_version.c_str());
+    }
 
-      appd_iot_json_end_object(json);
+    if (!beacon->devcfg.os_version.empty())
+    {
+      appd_iot_json_add_string_key_value(json, "operatingSystemVersion", beacon->devcfg.os_version.c_str());
     }
 
-    appd_iot_json_end_array(json);
-  } /* End Error Event Processing */
+    appd_iot_json_end_object(json);
+  } /* End Device Config Processing */
+
+  /* Event arrays are built in a single scan over events in the order they were added */
+  if (!appd_iot_serialize_events_to_json(json, beacon))
+  {
+    appd_iot_json_free(json);
+    return std::string();
+  }
 
   appd_iot_json_end_object(json);
 
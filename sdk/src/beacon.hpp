@@ -19,12 +19,24 @@
 
 #include <string>
 #include <map>
-#include <list>
+#include <vector>
 #include <appd_iot_interface.h>
 
-#define APPD_IOT_MAX_CUSTOM_EVENTS 200
-#define APPD_IOT_MAX_NETWORK_EVENTS 200
-#define APPD_IOT_MAX_ERROR_EVENTS 200
+//Maximum number of events of all types held in memory
+#ifndef APPD_IOT_MAX_EVENTS
+#define APPD_IOT_MAX_EVENTS 600
+#endif
+
+/**
+ * @brief Type of an event held in beacon
+ */
+typedef enum
+{
+  APPD_IOT_EVENT_TYPE_CUSTOM = 0,
+  APPD_IOT_EVENT_TYPE_NETWORK_REQUEST,
+  APPD_IOT_EVENT_TYPE_ERROR,
+  APPD_IOT_EVENT_TYPE_COUNT
+} event_type_t;
 
 typedef struct
 {
@@ -72,7 +84,8 @@ typedef struct
 {
   std::string thread;
   std::string runtime;
-  std::list<stack_frame_t> stack_frame_list;
+  size_t stack_frame_index;  /* Index of first frame of the trace in stack frames of error event */
+  size_t stack_frame_count;  /* Number of frames of the trace */
 } stack_trace_t;
 
 typedef struct
@@ -83,7 +96,8 @@ typedef struct
   int64_t timestamp_ms;
   int duration_ms;
   int error_stack_trace_index;
-  std::list<stack_trace_t> stack_trace_list;
+  std::vector<stack_trace_t> stack_traces;
+  std::vector<stack_frame_t> stack_frames;  /* Frames of all stack traces, stored one trace after another */
   data_t data;
 } error_event_t;
 
@@ -98,14 +112,40 @@ typedef struct
   std::string os_version;
 } device_cfg_t;
 
+/**
+ * @brief Events of a type serialized to JSON when they were added
+ */
+typedef struct
+{
+  std::string json;            /* Serialized events, separated by commas */
+  std::vector<size_t> ends;    /* Offset in json at which each serialized event ends */
+} serialized_events_t;
+
 typedef struct
 {
   device_cfg_t devcfg;
-  std::list<custom_event_t> custom_event_list;
-  std::list<network_request_event_t> network_request_event_list;
-  std::list<error_event_t> error_event_list;
+  /* Type of each event in the order events were added, across all types. Events of a type are held in
+   * the array of that type in the same order, so n-th event of a type in timeline is n-th in its array */
+  std::vector<event_type_t> timeline;
+  std::vector<custom_event_t> custom_events;
+  std::vector<network_request_event_t> network_request_events;
+  std::vector<error_event_t> error_events;
+  /* Events serialized when added, per event type. They are older than events of the same type in the
+   * arrays above, so n-th event of a type in timeline is serialized if n is less than their count */
+  serialized_events_t serialized_events[APPD_IOT_EVENT_TYPE_COUNT];
 } beacon_t;
 
+/**
+ * @brief Events held in memory, used to report SDK health
+ */
+typedef struct
+{
+  size_t custom_event_count;
+  size_t network_request_event_count;
+  size_t error_event_count;
+  size_t memory_bytes;   /* Estimated heap memory used by the events */
+} beacon_usage_t;
+
 /**
  * @brief Initializes Device Configuration <br>
  * It is madatory to set Device ID and Device Type.
@@ -115,28 +155,39 @@ typedef struct
 appd_iot_error_code_t appd_iot_init_device_config(appd_iot_device_config_t devcfg);
 
 
+/**
+ * @brief Prepares http request parameters which are the same for all beacons. <br>
+ * Must be called after collector url is configured, each time SDK is initialized.
+ * @return appd_iot_error_code_t indicating function execution status
+ */
+appd_iot_error_code_t appd_iot_prepare_beacon_http_req(void);
+
+
 /**
   * @brief Adds Custom Event to Beacon
-  * @param event contains custom event data to be sent to collector
+  * @param event contains custom event data to be sent to collector. On success, its content is
+  * moved into beacon without copying, or serialized if enabled in SDK config, and event is left empty.
   * @return appd_iot_error_code_t indicating function execution status
   */
-appd_iot_error_code_t appd_iot_add_custom_event_to_beacon(custom_event_t event);
+appd_iot_error_code_t appd_iot_add_custom_event_to_beacon(custom_event_t* event);
 
 
 /**
   * @brief Adds Network Request Event to Beacon
-  * @param event contains network request event data to be sent to collector
+  * @param event contains network request event data to be sent to collector. On success, its content is
+  * moved into beacon without copying, or serialized if enabled in SDK config, and event is left empty.
   * @return appd_iot_error_code_t indicating function execution status
   */
-appd_iot_error_code_t appd_iot_add_network_request_event_to_beacon(network_request_event_t event);
+appd_iot_error_code_t appd_iot_add_network_request_event_to_beacon(network_request_event_t* event);
 
 
 /**
   * @brief Adds Error Event to Beacon
-  * @param event contains error event data to be sent to collector
+  * @param event contains error event data to be sent to collector. On success, its content is
+  * moved into beacon without copying, or serialized if enabled in SDK config, and event is left empty.
   * @return appd_iot_error_code_t indicating function execution status
   */
-appd_iot_error_code_t appd_iot_add_error_event_to_beacon(error_event_t event);
+appd_iot_error_code_t appd_iot_add_error_event_to_beacon(error_event_t* event);
 
 
 /**
@@ -146,10 +197,26 @@ appd_iot_error_code_t appd_iot_add_error_event_to_beacon(error_event_t event);
 appd_iot_error_code_t appd_iot_send_all_beacons(void);
 
 
+/**
+  * @brief Sends Beacons in memory to collector, split into beacons of at most
+  * max_events_per_beacon events with several beacons in flight at once.
+  * @param max_events_per_beacon contains maximum number of events in a single beacon
+  * @return appd_iot_error_code_t indicating function execution status
+  */
+appd_iot_error_code_t appd_iot_drain_all_beacons(int max_events_per_beacon);
+
+
 /**
   * @brief Clears Beacons in memory
   * @return appd_iot_error_code_t indicating function execution status
   */
 appd_iot_error_code_t appd_iot_clear_all_beacons(void);
 
+
+/**
+ * @brief Get number of events held in memory per event type and estimate of memory used by them
+ * @param usage to which event counts and memory estimate are written
+ */
+void appd_iot_get_beacon_usage(beacon_usage_t* usage);
+
 #endif // _BEACON_HPP
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <time.h>
+#include <appd_iot_interface.h>
+#include "clock.hpp"
+
+/**
+ * @brief Decimal rendering of the last time formatted by a thread
+ */
+typedef struct
+{
+  int64_t time_ms;
+  size_t len;       /* 0 until first time is formatted */
+  char str[APPD_IOT_TIME_MS_STR_SIZE];
+} clock_str_cache_t;
+
+static __thread clock_str_cache_t thread_clock_str_cache;
+
+
+/**
+ * @brief Get current UTC time in milliseconds from coarse clock, read from vDSO without a system call.
+ * Resolution is a few milliseconds. Falls back to CLOCK_REALTIME where coarse clock is not supported.
+ * @return time in milliseconds since epoch
+ */
+int64_t appd_iot_clock_get_time_ms(void)
+{
+  struct timespec ts;
+
+  if (clock_gettime(CLOCK_REALTIME_COARSE, &ts) != 0)
+  {
+    clock_gettime(CLOCK_REALTIME, &ts);
+  }
+
+  return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+/**
+ * @brief Get time in milliseconds as decimal string. Rendering is cached per thread and reused
+ * while the time is unchanged, which is the case for most log lines written within a clock tick.
+ * @param time_ms contains time in milliseconds
+ * @param buf to which null terminated string is written
+ * @param buflen contains size of buf, at least APPD_IOT_TIME_MS_STR_SIZE to avoid truncation
+ * @return length of string written, excluding null char
+ */
+size_t appd_iot_clock_format_time_ms(int64_t time_ms, char* buf, size_t buflen)
+{
+  clock_str_cache_t* cache = &thread_clock_str_cache;
+
+  if (buflen == 0)
+  {
+    return 0;
+  }
+
+  if (cache->len == 0 || cache->time_ms != time_ms)
+  {
+    char digits[APPD_IOT_TIME_MS_STR_SIZE];
+    size_t ndigits = 0;
+    uint64_t value = (time_ms < 0) ? -(uint64_t)time_ms : (uint64_t)time_ms;
+
+    do
+    {
+      digits[ndigits++] = (char)('0' + value % 10);
+      value /= 10;
+    }
+    while (value > 0);
+
+    cache->len = 0;
+
+    if (time_ms < 0)
+    {
+      cache->str[cache->len++] = '-';
+    }
+
+    while (ndigits > 0)
+    {
+      cache->str[cache->len++] = digits[--ndigits];
+    }
+
+    cache->str[cache->len] = '\0';
+    cache->time_ms = time_ms;
+  }
+
+  size_t len = (cache->len < buflen) ? cache->len : buflen - 1;
+
+  memcpy(buf, cache->str, len);
+  buf[len] = '\0';
+
+  return len;
+}
+
+
+/**
+ * @brief Get current UTC time in milliseconds from a coarse clock, without a system call.
+ * @return time in milliseconds since epoch
+ */
+int64_t appd_iot_get_time_ms(void)
+{
+  return appd_iot_clock_get_time_ms();
+}
+
+
+/**
+ * @brief Writes current UTC time in milliseconds as decimal string.
+ * @param buf to which null terminated string is written
+ * @param buflen contains size of buf
+ * @return length of string written, excluding null char
+ */
+size_t appd_iot_get_time_ms_str(char* buf, size_t buflen)
+{
+  return appd_iot_clock_format_time_ms(appd_iot_clock_get_time_ms(), buf, buflen);
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _CLOCK_HPP
+#define _CLOCK_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+//Size of buffer holding time in milliseconds as decimal string, including null char
+#define APPD_IOT_TIME_MS_STR_SIZE 24
+
+/**
+ * @brief Get current UTC time in milliseconds from coarse clock, read from vDSO without a system call.
+ * Resolution is a few milliseconds.
+ * @return time in milliseconds since epoch
+ */
+int64_t appd_iot_clock_get_time_ms(void);
+
+/**
+ * @brief Get time in milliseconds as decimal string. Rendering is cached per thread and reused
+ * while the time is unchanged, which is the case for most log lines written within a clock tick.
+ * @param time_ms contains time in milliseconds
+ * @param buf to which null terminated string is written
+ * @param buflen contains size of buf, at least APPD_IOT_TIME_MS_STR_SIZE to avoid truncation
+ * @return length of string written, excluding null char
+ */
+size_t appd_iot_clock_format_time_ms(int64_t time_ms, char* buf, size_t buflen);
+
+#endif /* _CLOCK_HPP */
@@ -14,11 +14,32 @@
  * limitations under the License.
  */
 
+//Log statements in this file belong to config subsystem, unless redefined below
+#define APPD_IOT_LOG_SUBSYSTEM APPD_IOT_LOG_SUBSYSTEM_CONFIG
+
+#include <pthread.h>
+#include <string.h>
+#include <vector>
 #include "config.hpp"
 #include "beacon.hpp"
 #include "log.hpp"
+#include "log_async.hpp"
+#include "log_file.hpp"
+#include "atomic.hpp"
+#include "stats.hpp"
 
-static appd_sdk_config_t global_sdk_config;
+/*
+ * SDK config is published as an immutable snapshot. Readers load the current snapshot with a single
+ * acquire load and never lock. Writers copy the current snapshot, update the copy and publish it,
+ * serialized by global_sdk_config_lock. Readers do not announce when they are done with a snapshot,
+ * so a replaced snapshot is never freed: it is kept in retired_sdk_configs for the life of the process.
+ * Config is only replaced by SDK init and network interface registration, so memory kept grows
+ * with the number of those calls, not with the number of events or log messages.
+ */
+static appd_sdk_config_t default_sdk_config;
+static const appd_sdk_config_t* global_sdk_config = &default_sdk_config;
+static std::vector<const appd_sdk_config_t*> retired_sdk_configs;
+static pthread_mutex_t global_sdk_config_lock = PTHREAD_MUTEX_INITIALIZER;
 
 static std::string appd_iot_eum_collector_url_appkey_prefix = "eumcollector/iot/v1/application/";
 static std::string appd_iot_eum_collector_url_beacons_suffix = "/beacons";
@@ -34,6 +55,75 @@ static const appd_iot_data_t global_correlation_headers[APPD_IOT_NUM_SERVER_CORR
 
 static appd_iot_sdk_state_t global_sdk_state = APPD_IOT_SDK_UNINITIALIZED;
 
+
+/**
+ * @brief Get current SDK config snapshot
+ * @return config snapshot, valid for the life of the process
+ */
+static const appd_sdk_config_t* appd_iot_get_sdk_config(void)
+{
+  return appd_iot_atomic_load(&global_sdk_config);
+}
+
+
+/**
+ * @brief Starts an update of SDK config. Must be followed by appd_iot_publish_sdk_config()
+ * @return copy of current config snapshot to be updated
+ */
+static appd_sdk_config_t* appd_iot_begin_sdk_config_update(void)
+{
+  pthread_mutex_lock(&global_sdk_config_lock);
+
+  return new appd_sdk_config_t(*global_sdk_config);
+}
+
+
+/**
+ * @brief Publishes updated SDK config snapshot to readers and ends the update
+ * @param sdk_config contains updated copy returned by appd_iot_begin_sdk_config_update()
+ */
+static void appd_iot_publish_sdk_config(appd_sdk_config_t* sdk_config)
+{
+  const appd_sdk_config_t* prev_sdk_config = appd_iot_atomic_exchange(&global_sdk_config,
+      (const appd_sdk_config_t*)sdk_config);
+
+  //readers may still be using replaced snapshot, it is kept reachable instead of being freed
+  if (prev_sdk_config != &default_sdk_config)
+  {
+    retired_sdk_configs.push_back(prev_sdk_config);
+  }
+
+  pthread_mutex_unlock(&global_sdk_config_lock);
+}
+
+
+/**
+ * @brief Logs error of an SDK init which failed validation. As config of a failed init is not published,
+ * error is written with log write callback of that config if it logs errors, and logged with current
+ * config otherwise.
+ * @param sdkcfg contains sdk configuration passed to init
+ * @param message contains error message
+ */
+static void appd_iot_log_init_error(const appd_iot_sdk_config_t& sdkcfg, const char* message)
+{
+  appd_iot_log_level_t log_level = sdkcfg.subsystem_log_level[APPD_IOT_LOG_SUBSYSTEM_CONFIG];
+
+  if (log_level <= APPD_IOT_LOG_OFF || log_level > APPD_IOT_LOG_ALL)
+  {
+    log_level = sdkcfg.log_level;
+  }
+
+  if (sdkcfg.log_write_cb != NULL && log_level >= APPD_IOT_LOG_ERROR && log_level <= APPD_IOT_LOG_ALL)
+  {
+    appd_iot_log_write_to_cb(sdkcfg.log_write_cb, sdkcfg.log_format, APPD_IOT_LOG_ERROR,
+                             APPD_IOT_LOG_SUBSYSTEM, message);
+    return;
+  }
+
+  appd_iot_log(APPD_IOT_LOG_ERROR, "%s", message);
+}
+
+
 /**
  * @brief This method Initializes the SDK. <br>
  * This method should be called atleast once, early in your application's start up sequence.
@@ -47,45 +137,138 @@ appd_iot_error_code_t appd_iot_init_sdk(appd_iot_sdk_config_t sdkcfg,
 {
   std::string eum_collector_url;
   appd_iot_error_code_t retcode;
+  appd_sdk_config_t* sdk_config;
+
+  /* Validate config before any of it is applied, so that failed init leaves SDK config unchanged */
+  if (devcfg.device_type == NULL)
+  {
+    appd_iot_log_init_error(sdkcfg, "Device Type cannot be NULL");
+    return APPD_IOT_ERR_INVALID_INPUT;
+  }
+
+  if (sdkcfg.appkey == NULL)
+  {
+    appd_iot_log_init_error(sdkcfg, "AppKey cannot be NULL");
+    return APPD_IOT_ERR_INVALID_INPUT;
+  }
+
+  /* Build new config in a single snapshot, published once so that readers see all of it or none of it */
+  sdk_config = appd_iot_begin_sdk_config_update();
 
   /* Process Log Config */
+
   if (sdkcfg.log_level >= APPD_IOT_LOG_OFF && sdkcfg.log_level <= APPD_IOT_LOG_ALL)
   {
-    global_sdk_config.log_level = sdkcfg.log_level;
+    sdk_config->log_level = sdkcfg.log_level;
   }
   else
   {
-    global_sdk_config.log_level = APPD_IOT_LOG_ERROR;
+    sdk_config->log_level = APPD_IOT_LOG_ERROR;
   }
 
-  if (global_sdk_config.log_level != APPD_IOT_LOG_OFF)
+  /* Subsystems without a log level of their own use the global log level */
+  appd_iot_log_level_t max_log_level = sdk_config->log_level;
+
+  for (int i = 0; i < APPD_IOT_MAX_LOG_SUBSYSTEMS; i++)
   {
-    global_sdk_config.log_write_cb = sdkcfg.log_write_cb;
+    appd_iot_log_level_t subsystem_log_level = sdkcfg.subsystem_log_level[i];
+
+    if (subsystem_log_level > APPD_IOT_LOG_OFF && subsystem_log_level <= APPD_IOT_LOG_ALL)
+    {
+      sdk_config->subsystem_log_level[i] = subsystem_log_level;
+    }
+    else
+    {
+      sdk_config->subsystem_log_level[i] = sdk_config->log_level;
+    }
+
+    if (sdk_config->subsystem_log_level[i] > max_log_level)
+    {
+      max_log_level = sdk_config->subsystem_log_level[i];
+    }
   }
 
-  /* Process Device Config */
-  retcode = appd_iot_init_device_config(devcfg);
+  if (sdkcfg.log_rate_limit > APPD_IOT_LOG_MAX_RATE_LIMIT)
+  {
+    sdk_config->log_rate_limit = APPD_IOT_LOG_MAX_RATE_LIMIT;
+  }
+  else
+  {
+    sdk_config->log_rate_limit = (sdkcfg.log_rate_limit > 0) ? sdkcfg.log_rate_limit : 0;
+  }
 
-  if (retcode != APPD_IOT_SUCCESS)
+  if (max_log_level != APPD_IOT_LOG_OFF)
   {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Device Config Initialization Failed");
-    return retcode;
+    sdk_config->log_write_cb = sdkcfg.log_write_cb;
   }
 
-  /* Process SDK Config */
-  if (sdkcfg.appkey == NULL)
+  if (sdkcfg.log_format > APPD_IOT_LOG_FORMAT_TEXT && sdkcfg.log_format < APPD_IOT_MAX_LOG_FORMATS)
   {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "AppKey cannot be NULL");
-    return APPD_IOT_ERR_INVALID_INPUT;
+    sdk_config->log_format = sdkcfg.log_format;
   }
+  else
+  {
+    sdk_config->log_format = APPD_IOT_LOG_FORMAT_TEXT;
+  }
+
+  sdk_config->send_timing_events = sdkcfg.send_timing_events;
+  sdk_config->serialize_on_add = sdkcfg.serialize_on_add;
+  sdk_config->health_event_interval_ms = (sdkcfg.health_event_interval_ms > 0) ?
+                                         sdkcfg.health_event_interval_ms : 0;
 
-  global_sdk_config.appkey = sdkcfg.appkey;
+  bool log_async_failed = false;
+  bool log_binary_file_failed = false;
+  bool log_mode_async = (sdkcfg.log_mode == APPD_IOT_LOG_MODE_ASYNC || sdkcfg.log_mode == APPD_IOT_LOG_MODE_BINARY);
 
+  sdk_config->log_mode = APPD_IOT_LOG_MODE_SYNC;
+
+  if (log_mode_async && max_log_level != APPD_IOT_LOG_OFF)
+  {
+    if (appd_iot_log_async_start() == APPD_IOT_SUCCESS)
+    {
+      sdk_config->log_mode = sdkcfg.log_mode;
+    }
+    else
+    {
+      log_async_failed = true;
+    }
+  }
+
+  if (sdk_config->log_mode == APPD_IOT_LOG_MODE_BINARY)
+  {
+    log_binary_file_failed = (appd_iot_log_async_set_binary_file(sdkcfg.log_binary_file) != APPD_IOT_SUCCESS);
+  }
+  else
+  {
+    appd_iot_log_async_set_binary_file(NULL);
+  }
+
+  bool log_file_failed = false;
+
+  if (sdkcfg.log_file != NULL && max_log_level != APPD_IOT_LOG_OFF && sdkcfg.log_write_cb == NULL)
+  {
+    int log_file_max_size_kb = (sdkcfg.log_file_max_size_kb > 0) ?
+                               sdkcfg.log_file_max_size_kb : APPD_IOT_LOG_FILE_DEFAULT_MAX_SIZE_KB;
+    int log_file_max_count = (sdkcfg.log_file_max_count > 0) ?
+                             sdkcfg.log_file_max_count : APPD_IOT_LOG_FILE_DEFAULT_MAX_COUNT;
+
+    if (log_file_max_count > APPD_IOT_LOG_FILE_MAX_COUNT)
+    {
+      log_file_max_count = APPD_IOT_LOG_FILE_MAX_COUNT;
+    }
+
+    log_file_failed = (appd_iot_log_file_open(sdkcfg.log_file, log_file_max_size_kb,
+                                              log_file_max_count) != APPD_IOT_SUCCESS);
+  }
+  else
+  {
+    appd_iot_log_file_open(NULL, 0, 0);
+  }
+
+  /* Process SDK Config */
   if (sdkcfg.eum_collector_url == NULL)
   {
     eum_collector_url = default_eum_collector_url;
-    appd_iot_log(APPD_IOT_LOG_ERROR, "EUM collector URL is NULL, setting to default:%s",
-                 default_eum_collector_url.c_str());
   }
   else
   {
@@ -97,22 +280,58 @@ appd_iot_error_code_t appd_iot_init_sdk(appd_iot_sdk_config_t sdkcfg,
     eum_collector_url = eum_collector_url + "/";
   }
 
-  global_sdk_config.eum_collector_url =
+  sdk_config->appkey = sdkcfg.appkey;
+
+  sdk_config->eum_collector_url =
     eum_collector_url + appd_iot_eum_collector_url_appkey_prefix +
-    global_sdk_config.appkey + appd_iot_eum_collector_url_beacons_suffix;
+    sdk_config->appkey + appd_iot_eum_collector_url_beacons_suffix;
 
-  global_sdk_config.eum_appkey_enabled_url =
+  sdk_config->eum_appkey_enabled_url =
     eum_collector_url + appd_iot_eum_collector_url_appkey_prefix +
-    global_sdk_config.appkey + appd_iot_eum_collector_url_enabled_suffix;
+    sdk_config->appkey + appd_iot_eum_collector_url_enabled_suffix;
 
-  appd_iot_log(APPD_IOT_LOG_INFO, "EUM Collector URL %s", global_sdk_config.eum_collector_url.c_str());
+  if (sdkcfg.sdk_state_change_cb != NULL)
+  {
+    sdk_config->sdk_state_change_cb = sdkcfg.sdk_state_change_cb;
+  }
 
+  appd_iot_publish_sdk_config(sdk_config);
 
-  if (sdkcfg.sdk_state_change_cb != NULL)
+  if (log_file_failed)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Failed to Open Log File:%s, Log Messages Written to stderr", sdkcfg.log_file);
+  }
+
+  if (log_async_failed)
   {
-    global_sdk_config.sdk_state_change_cb = sdkcfg.sdk_state_change_cb;
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Failed to Start Async Log Thread, Logging in Sync Mode");
   }
 
+  if (log_binary_file_failed)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Failed to Open Binary Log File:%s, Log Messages Formatted by Log Thread",
+                 sdkcfg.log_binary_file);
+  }
+
+  if (sdkcfg.eum_collector_url == NULL)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "EUM collector URL is NULL, setting to default:%s",
+                 default_eum_collector_url.c_str());
+  }
+
+  /* Process Device Config */
+  retcode = appd_iot_init_device_config(devcfg);
+
+  if (retcode != APPD_IOT_SUCCESS)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Device Config Initialization Failed");
+    return retcode;
+  }
+
+  appd_iot_log(APPD_IOT_LOG_INFO, "EUM Collector URL %s", appd_iot_get_eum_collector_url().c_str());
+
+  appd_iot_prepare_beacon_http_req();
+
   appd_iot_set_sdk_state(APPD_IOT_SDK_ENABLED);
 
   return APPD_IOT_SUCCESS;
@@ -143,8 +362,48 @@ appd_iot_error_code_t appd_iot_register_network_interface(appd_iot_http_cb_t htt
     return APPD_IOT_ERR_INVALID_INPUT;
   }
 
-  global_sdk_config.http_cb.http_req_send_cb = http_cb.http_req_send_cb;
-  global_sdk_config.http_cb.http_resp_done_cb = http_cb.http_resp_done_cb;
+  appd_sdk_config_t* sdk_config = appd_iot_begin_sdk_config_update();
+
+  sdk_config->http_cb.http_req_send_cb = http_cb.http_req_send_cb;
+  sdk_config->http_cb.http_resp_done_cb = http_cb.http_resp_done_cb;
+
+  appd_iot_publish_sdk_config(sdk_config);
+
+  return APPD_IOT_SUCCESS;
+}
+
+/**
+ * @brief This method registers network interface used to send beacons concurrently
+ * @param pipeline_cb contains function pointers for http batch send and http response done callbacks <br>
+ * and the maximum number of requests to be in flight at once.
+ * @return appd_iot_error_code_t Error code indicating if the function call is a success or fail.
+ * Error code returned provides more details on the type of error occurred.
+ */
+appd_iot_error_code_t appd_iot_register_network_pipeline_interface(appd_iot_http_pipeline_cb_t pipeline_cb)
+{
+  if (pipeline_cb.http_req_send_batch_cb == NULL)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "http_req_send_batch_cb is NULL");
+    return APPD_IOT_ERR_INVALID_INPUT;
+  }
+
+  if (pipeline_cb.http_resp_done_cb == NULL)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "http_resp_done_cb is NULL");
+    return APPD_IOT_ERR_INVALID_INPUT;
+  }
+
+  if (pipeline_cb.max_requests_in_flight <= 0)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Invalid max requests in flight:%d", pipeline_cb.max_requests_in_flight);
+    return APPD_IOT_ERR_INVALID_INPUT;
+  }
+
+  appd_sdk_config_t* sdk_config = appd_iot_begin_sdk_config_update();
+
+  sdk_config->http_pipeline_cb = pipeline_cb;
+
+  appd_iot_publish_sdk_config(sdk_config);
 
   return APPD_IOT_SUCCESS;
 }
@@ -155,7 +414,7 @@ appd_iot_error_code_t appd_iot_register_network_interface(appd_iot_http_cb_t htt
  */
 appd_iot_http_req_send_cb_t appd_iot_get_http_req_send_cb(void)
 {
-  return global_sdk_config.http_cb.http_req_send_cb;
+  return appd_iot_get_sdk_config()->http_cb.http_req_send_cb;
 }
 
 /**
@@ -164,7 +423,16 @@ appd_iot_http_req_send_cb_t appd_iot_get_http_req_send_cb(void)
  */
 appd_iot_http_resp_done_cb_t appd_iot_get_http_resp_done_cb(void)
 {
-  return global_sdk_config.http_cb.http_resp_done_cb;
+  return appd_iot_get_sdk_config()->http_cb.http_resp_done_cb;
+}
+
+/**
+ * @brief Get http pipeline callbacks used to send beacons concurrently
+ * @return http pipeline callbacks. Callback function pointers are NULL if not registered.
+ */
+appd_iot_http_pipeline_cb_t appd_iot_get_http_pipeline_cb(void)
+{
+  return appd_iot_get_sdk_config()->http_pipeline_cb;
 }
 
 /**
@@ -173,7 +441,28 @@ appd_iot_http_resp_done_cb_t appd_iot_get_http_resp_done_cb(void)
   */
 appd_iot_log_level_t appd_iot_get_log_level(void)
 {
-  return global_sdk_config.log_level;
+  return appd_iot_get_sdk_config()->log_level;
+}
+
+
+/**
+  * @brief Get Log Level of a subsystem, configured as part of SDK Initialization
+  * @param subsystem contains log subsystem enum
+  * @return appd_iot_log_level_t contains log level enum
+  */
+appd_iot_log_level_t appd_iot_get_subsystem_log_level(appd_iot_log_subsystem_t subsystem)
+{
+  return appd_iot_get_sdk_config()->subsystem_log_level[subsystem];
+}
+
+
+/**
+  * @brief Get Log Rate Limit configured as part of SDK Initialization
+  * @return max messages per second per log statement, 0 for no limit
+  */
+int appd_iot_get_log_rate_limit(void)
+{
+  return appd_iot_get_sdk_config()->log_rate_limit;
 }
 
 
@@ -183,16 +472,71 @@ appd_iot_log_level_t appd_iot_get_log_level(void)
  */
 appd_iot_log_write_cb_t appd_iot_get_log_write_cb(void)
 {
-  return global_sdk_config.log_write_cb;
+  return appd_iot_get_sdk_config()->log_write_cb;
+}
+
+/**
+  * @brief Get Log Mode configured as part of SDK Initialization
+  * @return appd_iot_log_mode_t contains log mode enum
+  */
+appd_iot_log_mode_t appd_iot_get_log_mode(void)
+{
+  return appd_iot_get_sdk_config()->log_mode;
+}
+
+/**
+  * @brief Get Log Format configured as part of SDK Initialization
+  * @return appd_iot_log_format_t contains log format enum
+  */
+appd_iot_log_format_t appd_iot_get_log_format(void)
+{
+  return appd_iot_get_sdk_config()->log_format;
+}
+
+/**
+  * @brief Check if send timing custom events are enabled as part of SDK Initialization
+  * @return true if a send timing custom event is added after each successful send
+  */
+bool appd_iot_get_send_timing_events(void)
+{
+  return appd_iot_get_sdk_config()->send_timing_events;
+}
+
+/**
+  * @brief Check if events are serialized when added as part of SDK Initialization
+  * @return true if each event is serialized to JSON when it is added instead of when it is sent
+  */
+bool appd_iot_get_serialize_on_add(void)
+{
+  return appd_iot_get_sdk_config()->serialize_on_add;
+}
+
+/**
+  * @brief Get interval of SDK health custom events configured as part of SDK Initialization
+  * @return minimum interval in milliseconds between health events, 0 if disabled
+  */
+int appd_iot_get_health_event_interval_ms(void)
+{
+  return appd_iot_get_sdk_config()->health_event_interval_ms;
 }
 
 /**
  * @brief Get Configured EUM Collector URL
- * @return URL in string format
+ * @return copy of URL
  */
-const char* appd_iot_get_eum_collector_url(void)
+std::string appd_iot_get_eum_collector_url(void)
 {
-  return global_sdk_config.eum_collector_url.c_str();
+  return appd_iot_get_sdk_config()->eum_collector_url;
+}
+
+/**
+ * @brief Check if Configured EUM Collector URL starts with given url, without copying it
+ * @param url contains url to be checked
+ * @return true if EUM Collector URL starts with url
+ */
+bool appd_iot_eum_collector_url_starts_with(const char* url)
+{
+  return (strncmp(url, appd_iot_get_sdk_config()->eum_collector_url.c_str(), strlen(url)) == 0);
 }
 
 /**
@@ -212,20 +556,24 @@ const appd_iot_data_t* appd_iot_get_server_correlation_headers(void)
  */
 void appd_iot_set_sdk_state(appd_iot_sdk_state_t new_state)
 {
-  if (global_sdk_state == new_state)
+  appd_iot_sdk_state_t prev_state = appd_iot_atomic_exchange(&global_sdk_state, new_state);
+
+  if (prev_state == new_state)
   {
     appd_iot_log(APPD_IOT_LOG_WARN, "SDK state update with same state as current:%s",
-                 appd_iot_sdk_state_to_str(global_sdk_state));
+                 appd_iot_sdk_state_to_str(new_state));
     return;
   }
 
-  global_sdk_state = new_state;
+  appd_iot_log(APPD_IOT_LOG_INFO, "New SDK state :%s", appd_iot_sdk_state_to_str(new_state));
+
+  appd_iot_stats_sdk_state_changed(prev_state, new_state);
 
-  appd_iot_log(APPD_IOT_LOG_INFO, "New SDK state :%s", appd_iot_sdk_state_to_str(global_sdk_state));
+  appd_iot_sdk_state_change_cb_t sdk_state_change_cb = appd_iot_get_sdk_config()->sdk_state_change_cb;
 
-  if (global_sdk_config.sdk_state_change_cb != NULL)
+  if (sdk_state_change_cb != NULL)
   {
-    global_sdk_config.sdk_state_change_cb(global_sdk_state);
+    sdk_state_change_cb(new_state);
   }
 }
 
@@ -235,7 +583,7 @@ void appd_iot_set_sdk_state(appd_iot_sdk_state_t new_state)
  */
 appd_iot_sdk_state_t appd_iot_get_sdk_state(void)
 {
-  return global_sdk_state;
+  return appd_iot_atomic_load(&global_sdk_state);
 }
 
 /**
@@ -246,28 +594,36 @@ void appd_iot_disable_sdk(int http_resp_code)
 {
   if (http_resp_code == 403)
   {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Resp Code:%d Application on Controller is Disabled",
-                 http_resp_code);
+    appd_iot_log_with_fields(APPD_IOT_LOG_ERROR, appd_iot_log_resp_code_field(http_resp_code),
+                             "Resp Code:%d Application on Controller is Disabled", http_resp_code);
     appd_iot_set_sdk_state(APPD_IOT_SDK_DISABLED_KILL_SWITCH);
   }
   else if (http_resp_code == 429)
   {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Resp Code:%d Application Data Limit Exceeded", http_resp_code);
+    appd_iot_log_with_fields(APPD_IOT_LOG_ERROR, appd_iot_log_resp_code_field(http_resp_code),
+                             "Resp Code:%d Application Data Limit Exceeded", http_resp_code);
     appd_iot_set_sdk_state(APPD_IOT_SDK_DISABLED_DATA_LIMIT_EXCEEDED);
   }
   else if (http_resp_code == 402)
   {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Resp Code:%d Application License Expired", http_resp_code);
+    appd_iot_log_with_fields(APPD_IOT_LOG_ERROR, appd_iot_log_resp_code_field(http_resp_code),
+                             "Resp Code:%d Application License Expired", http_resp_code);
     appd_iot_set_sdk_state(APPD_IOT_SDK_DISABLED_LICENSE_EXPIRED);
   }
   else
   {
-    appd_iot_log(APPD_IOT_LOG_INFO, "Resp Code:%d not supported to disable SDK", http_resp_code);
+    appd_iot_log_with_fields(APPD_IOT_LOG_INFO, appd_iot_log_resp_code_field(http_resp_code),
+                             "Resp Code:%d not supported to disable SDK", http_resp_code);
   }
 }
 
 
 
+//Functions below check application status with collector
+#undef APPD_IOT_LOG_SUBSYSTEM
+#define APPD_IOT_LOG_SUBSYSTEM APPD_IOT_LOG_SUBSYSTEM_TRANSPORT
+
+
 /**
  * @brief Use this API to check with AppDynamics Collector on the status of IoT Application on
  * AppDynamics Controller, whether instrumentation is enabled or not. If the Collector returns Success, SDK
@@ -303,7 +659,10 @@ appd_iot_error_code_t appd_iot_check_app_status(void)
   appd_iot_init_to_zero(&http_req, sizeof(http_req));
 
   http_req.type = "GET";
-  http_req.url = global_sdk_config.eum_appkey_enabled_url.c_str();
+  //url is copied, as config snapshot may be replaced while request is in flight
+  std::string eum_appkey_enabled_url = appd_iot_get_sdk_config()->eum_appkey_enabled_url;
+
+  http_req.url = eum_appkey_enabled_url.c_str();
 
   http_resp = http_req_send_cb(&http_req);
 
@@ -321,7 +680,8 @@ appd_iot_error_code_t appd_iot_check_app_status(void)
   /* Return if there is an error executing http req */
   if (retcode != APPD_IOT_SUCCESS)
   {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Error Executing HTTP Request, ErrorCode:%d", retcode);
+    appd_iot_log_with_fields(APPD_IOT_LOG_ERROR, appd_iot_log_error_code_field(retcode),
+                             "Error Executing HTTP Request, ErrorCode:%d", retcode);
 
     if (http_resp_done_cb != NULL)
     {
@@ -334,7 +694,8 @@ appd_iot_error_code_t appd_iot_check_app_status(void)
   if (http_resp->resp_code >= 200 && http_resp->resp_code < 300)
   {
     appd_iot_set_sdk_state(APPD_IOT_SDK_ENABLED);
-    appd_iot_log(APPD_IOT_LOG_INFO, "RespCode:%d Application is Enabled on Controller", http_resp->resp_code);
+    appd_iot_log_with_fields(APPD_IOT_LOG_INFO, appd_iot_log_resp_code_field(http_resp->resp_code),
+                             "RespCode:%d Application is Enabled on Controller", http_resp->resp_code);
     retcode = APPD_IOT_SUCCESS;
   }
   else if ((http_resp->resp_code == 402) ||
@@ -346,8 +707,8 @@ appd_iot_error_code_t appd_iot_check_app_status(void)
   }
   else
   {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "Resp Code:%d Network Request to Check App Status Failed",
-                 http_resp->resp_code);
+    appd_iot_log_with_fields(APPD_IOT_LOG_ERROR, appd_iot_log_resp_code_field(http_resp->resp_code),
+                             "Resp Code:%d Network Request to Check App Status Failed", http_resp->resp_code);
     retcode = APPD_IOT_ERR_NETWORK_ERROR;
   }
 
@@ -28,8 +28,16 @@ typedef struct
   appd_iot_log_write_cb_t log_write_cb; /* Callback function to write log messages */
   appd_iot_sdk_state_change_cb_t sdk_state_change_cb; /* Callback function to indicate sdk is disabled */
   appd_iot_log_level_t log_level; /* Set Log Level */
+  appd_iot_log_mode_t log_mode;   /* Set Log Mode, sync or async */
+  appd_iot_log_level_t subsystem_log_level[APPD_IOT_MAX_LOG_SUBSYSTEMS]; /* Log Level per subsystem */
+  int log_rate_limit;             /* Max messages per second per log statement, 0 for no limit */
+  appd_iot_log_format_t log_format; /* Set Log Format, text or json */
+  bool send_timing_events;        /* Add custom event with time of each send phase after each send */
+  int health_event_interval_ms;   /* Min interval between SDK health custom events, 0 if disabled */
+  bool serialize_on_add;          /* Serialize each event to JSON when it is added instead of when it is sent */
   bool initialized;               /* Indicates if config is valid and initialized */
   appd_iot_http_cb_t http_cb;     /* Callback function pointers used to send http req */
+  appd_iot_http_pipeline_cb_t http_pipeline_cb; /* Callback function pointers used to send http req batch */
 } appd_sdk_config_t;
 
 /**
@@ -57,11 +65,69 @@ void appd_iot_disable_sdk(int http_resp_code);
 appd_iot_log_level_t appd_iot_get_log_level(void);
 
 
+/**
+  * @brief Get Log Level of a subsystem, configured as part of SDK Initialization
+  * @param subsystem contains log subsystem enum
+  * @return appd_iot_log_level_t contains log level enum
+  */
+appd_iot_log_level_t appd_iot_get_subsystem_log_level(appd_iot_log_subsystem_t subsystem);
+
+
+/**
+  * @brief Get Log Rate Limit configured as part of SDK Initialization
+  * @return max messages per second per log statement, 0 for no limit
+  */
+int appd_iot_get_log_rate_limit(void);
+
+
+/**
+  * @brief Get configured Log Mode as part of SDK Initialization
+  * @return appd_iot_log_mode_t contains log mode enum
+  */
+appd_iot_log_mode_t appd_iot_get_log_mode(void);
+
+
+/**
+  * @brief Get configured Log Format as part of SDK Initialization
+  * @return appd_iot_log_format_t contains log format enum
+  */
+appd_iot_log_format_t appd_iot_get_log_format(void);
+
+
+/**
+  * @brief Check if send timing custom events are enabled as part of SDK Initialization
+  * @return true if a send timing custom event is added after each successful send
+  */
+bool appd_iot_get_send_timing_events(void);
+
+
+/**
+  * @brief Check if events are serialized when added as part of SDK Initialization
+  * @return true if each event is serialized to JSON when it is added instead of when it is sent
+  */
+bool appd_iot_get_serialize_on_add(void);
+
+
+/**
+  * @brief Get interval of SDK health custom events configured as part of SDK Initialization
+  * @return minimum interval in milliseconds between health events, 0 if disabled
+  */
+int appd_iot_get_health_event_interval_ms(void);
+
+
 /**
   * @brief Get Configured EUM Collector URL
-  * @return URL in string format
+  * @return copy of URL
+  */
+std::string appd_iot_get_eum_collector_url(void);
+
+
+/**
+  * @brief Check if Configured EUM Collector URL starts with given url, without copying it
+  * @param url contains url to be checked
+  * @return true if EUM Collector URL starts with url
   */
-const char* appd_iot_get_eum_collector_url(void);
+bool appd_iot_eum_collector_url_starts_with(const char* url);
 
 
 /**
@@ -85,4 +151,11 @@ appd_iot_http_req_send_cb_t appd_iot_get_http_req_send_cb(void);
 appd_iot_http_resp_done_cb_t appd_iot_get_http_resp_done_cb(void);
 
 
+/**
+ * @brief Get http pipeline callbacks used to send beacons concurrently
+ * @return http pipeline callbacks. Callback function pointers are NULL if not registered.
+ */
+appd_iot_http_pipeline_cb_t appd_iot_get_http_pipeline_cb(void);
+
+
 #endif // _CONFIG_HPP_
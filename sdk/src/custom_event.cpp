@@ -14,11 +14,22 @@
  * limitations under the License.
  */
 
+//Log statements in this file belong to events subsystem
+#define APPD_IOT_LOG_SUBSYSTEM APPD_IOT_LOG_SUBSYSTEM_EVENTS
+
 #include <string.h>
 #include "custom_event.hpp"
 #include "log.hpp"
 #include "config.hpp"
+#include "clock.hpp"
 #include "utils.hpp"
+#include "stats.hpp"
+
+//Type of the custom event reporting SDK health, added when enabled in SDK config
+#define APPD_IOT_HEALTH_EVENT_TYPE "AppDynamicsSDKHealth"
+
+//Time at which last health event was added
+static int64_t global_last_health_event_ms = 0;
 
 /**
   * @brief converts custom event data to beacon format and adds to beacon
@@ -57,7 +68,8 @@ appd_iot_error_code_t appd_iot_add_custom_event(appd_iot_custom_event_t custom_e
     appd_iot_log(APPD_IOT_LOG_WARN, "Custom Event Summary is NULL");
   }
 
-  event.timestamp_ms = custom_event.timestamp_ms;
+  //timestamp_ms of 0 means the caller did not time the event, use time of add
+  event.timestamp_ms = (custom_event.timestamp_ms != 0) ? custom_event.timestamp_ms : appd_iot_clock_get_time_ms();
   event.duration_ms = custom_event.duration_ms;
   retcode = APPD_IOT_SUCCESS;
 
@@ -68,16 +80,17 @@ appd_iot_error_code_t appd_iot_add_custom_event(appd_iot_custom_event_t custom_e
 
     if (retcode != APPD_IOT_SUCCESS)
     {
-      appd_iot_log(APPD_IOT_LOG_WARN, "Failed to parse custom event data, error:%s",
-                   appd_iot_error_code_to_str(retcode));
+      appd_iot_log_with_fields(APPD_IOT_LOG_WARN, appd_iot_log_error_code_field(retcode),
+                               "Failed to parse custom event data, error:%s", appd_iot_error_code_to_str(retcode));
 
       appd_iot_clear_event_data(&event.data);
     }
   }
 
-  appd_iot_log(APPD_IOT_LOG_INFO, "Adding Custom Event with Type:%s", event.type.c_str());
+  appd_iot_log_with_fields(APPD_IOT_LOG_INFO, appd_iot_log_event_type_field(event.type.c_str()),
+                           "Adding Custom Event with Type:%s", event.type.c_str());
 
-  retcode = appd_iot_add_custom_event_to_beacon(event);
+  retcode = appd_iot_add_custom_event_to_beacon(&event);
 
   return retcode;
 }
@@ -191,6 +204,59 @@ appd_iot_error_code_t appd_iot_copy_event_data
 }
 
 
+/**
+  * @brief Adds custom event reporting SDK health to the events to be sent, if enabled in SDK config
+  * and health event interval has passed since last health event was added
+  */
+static void appd_iot_add_health_event_if_due(void)
+{
+  int interval_ms = appd_iot_get_health_event_interval_ms();
+
+  if (interval_ms <= 0)
+  {
+    return;
+  }
+
+  int64_t now_ms = appd_iot_clock_get_time_ms();
+
+  //clock going back, e.g. on time sync, also makes health event due
+  if (global_last_health_event_ms != 0 && now_ms >= global_last_health_event_ms &&
+      now_ms - global_last_health_event_ms < interval_ms)
+  {
+    return;
+  }
+
+  global_last_health_event_ms = now_ms;
+
+  appd_iot_stats_t stats;
+  beacon_usage_t usage;
+  custom_event_t event;
+
+  appd_iot_get_stats(&stats);
+  appd_iot_get_beacon_usage(&usage);
+
+  event.type = APPD_IOT_HEALTH_EVENT_TYPE;
+  event.summary = "AppDynamics IoT SDK Health";
+  event.timestamp_ms = now_ms;
+  event.duration_ms = 0;
+
+  event.data.integermap["Custom Events Buffered"] = usage.custom_event_count;
+  event.data.integermap["Network Events Buffered"] = usage.network_request_event_count;
+  event.data.integermap["Error Events Buffered"] = usage.error_event_count;
+  event.data.integermap["Buffer Memory Bytes"] = usage.memory_bytes;
+  event.data.integermap["Events Dropped"] = stats.custom_events_dropped + stats.network_events_dropped +
+      stats.error_events_dropped;
+  event.data.integermap["Bytes Sent"] = stats.bytes_sent;
+  event.data.integermap["Send Failures"] = stats.beacon_send_failures;
+  event.data.integermap["Avg Serialize Time us"] = (stats.serialize_latency.count > 0) ?
+      stats.serialize_latency.sum_us / stats.serialize_latency.count : 0;
+
+  appd_iot_log(APPD_IOT_LOG_INFO, "Adding SDK Health Event");
+
+  appd_iot_add_custom_event_to_beacon(&event);
+}
+
+
 /**
   * @brief send all events to collector
   * @return appd_iot_error_code_t indicating function execution status
@@ -207,10 +273,41 @@ appd_iot_error_code_t appd_iot_send_all_events(void)
     return APPD_IOT_ERR_SDK_NOT_ENABLED;
   }
 
+  appd_iot_add_health_event_if_due();
+
   return appd_iot_send_all_beacons();
 }
 
 
+/**
+  * @brief send all events to collector as several beacons in flight at once
+  * @param max_events_per_beacon contains maximum number of events in a single beacon
+  * @return appd_iot_error_code_t indicating function execution status
+  */
+appd_iot_error_code_t appd_iot_drain_all_events(int max_events_per_beacon)
+{
+  appd_iot_sdk_state_t sdk_state;
+
+  if ((sdk_state = appd_iot_get_sdk_state()) != APPD_IOT_SDK_ENABLED)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Drain All Events Failed. SDK Not in Enabled State:%s",
+                 appd_iot_sdk_state_to_str(sdk_state));
+
+    return APPD_IOT_ERR_SDK_NOT_ENABLED;
+  }
+
+  if (max_events_per_beacon <= 0)
+  {
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Invalid max events per beacon:%d", max_events_per_beacon);
+    return APPD_IOT_ERR_INVALID_INPUT;
+  }
+
+  appd_iot_add_health_event_if_due();
+
+  return appd_iot_drain_all_beacons(max_events_per_beacon);
+}
+
+
 /**
   * @brief Clear all events to collector
   * @return appd_iot_error_code_t indicating function execution status
@@ -14,16 +14,19 @@
  * limitations under the License.
  */
 
+//Log statements in this file belong to events subsystem
+#define APPD_IOT_LOG_SUBSYSTEM APPD_IOT_LOG_SUBSYSTEM_EVENTS
+
 #include "beacon.hpp"
 #include "log.hpp"
 #include "config.hpp"
+#include "clock.hpp"
 #include "custom_event.hpp"
 
 static const char* severity_str[APPD_IOT_ERR_MAX_SEVERITY_LEVELS] = {"alert", "critical", "fatal"};
 
 static appd_iot_error_code_t appd_iot_copy_stack_trace
-(std::list<stack_trace_t>* dest_stack_trace_list, appd_iot_stack_trace_t* src_stack_trace,
- int src_stack_trace_count);
+(error_event_t* dest_event, appd_iot_stack_trace_t* src_stack_trace, int src_stack_trace_count);
 
 /**
   * @brief converts error event data to beacon format and adds to beacon
@@ -45,7 +48,7 @@ appd_iot_error_code_t appd_iot_add_error_event(appd_iot_error_event_t error_even
   }
 
   retcode = APPD_IOT_SUCCESS;
-  event.timestamp_ms = error_event.timestamp_ms;
+  event.timestamp_ms = (error_event.timestamp_ms != 0) ? error_event.timestamp_ms : appd_iot_clock_get_time_ms();
   event.duration_ms = error_event.duration_ms;
 
   if (error_event.name != NULL)
@@ -84,16 +87,17 @@ appd_iot_error_code_t appd_iot_add_error_event(appd_iot_error_event_t error_even
       event.error_stack_trace_index = error_event.error_stack_trace_index;
     }
 
-    retcode = appd_iot_copy_stack_trace(&event.stack_trace_list,
+    retcode = appd_iot_copy_stack_trace(&event,
                                         error_event.stack_trace,
                                         error_event.stack_trace_count);
 
     if (retcode != APPD_IOT_SUCCESS)
     {
-      appd_iot_log(APPD_IOT_LOG_ERROR, "Failed to parse stack traces, error:%s",
-                   appd_iot_error_code_to_str(retcode));
+      appd_iot_log_with_fields(APPD_IOT_LOG_ERROR, appd_iot_log_error_code_field(retcode),
+                               "Failed to parse stack traces, error:%s", appd_iot_error_code_to_str(retcode));
 
-      event.stack_trace_list.clear();
+      event.stack_traces.clear();
+      event.stack_frames.clear();
     }
   }
   else
@@ -108,8 +112,8 @@ appd_iot_error_code_t appd_iot_add_error_event(appd_iot_error_event_t error_even
 
     if (retcode != APPD_IOT_SUCCESS)
     {
-      appd_iot_log(APPD_IOT_LOG_ERROR, "Failed to parse error event data, error:%s",
-                   appd_iot_error_code_to_str(retcode));
+      appd_iot_log_with_fields(APPD_IOT_LOG_ERROR, appd_iot_log_error_code_field(retcode),
+                               "Failed to parse error event data, error:%s", appd_iot_error_code_to_str(retcode));
 
       appd_iot_clear_event_data(&event.data);
     }
@@ -117,26 +121,26 @@ appd_iot_error_code_t appd_iot_add_error_event(appd_iot_error_event_t error_even
 
   appd_iot_log(APPD_IOT_LOG_INFO, "Adding Error Event with name:%s", error_event.name);
 
-  retcode = appd_iot_add_error_event_to_beacon(event);
+  retcode = appd_iot_add_error_event_to_beacon(&event);
 
   return retcode;
 }
 
 /**
- * @brief Copies User Defined Stack Trace to SDK Defined Stack Trace
- * @param dest_stack_trace_list contains stack trace list to be copied to
+ * @brief Copies User Defined Stack Trace to SDK Defined Stack Trace. Frames of all stack traces
+ * are copied into a single array of the event, each stack trace holds index and count of its frames.
+ * @param dest_event contains error event to which stack traces are copied to
  * @param src_stack_trace contains stack trace list to be copied from
  * @param src_stack_trace_count contains number of stack traces
  * @return appd_iot_error_code_t indicating function execution status
  */
 static appd_iot_error_code_t appd_iot_copy_stack_trace
-(std::list<stack_trace_t>* dest_stack_trace_list, appd_iot_stack_trace_t* src_stack_trace,
- int src_stack_trace_count)
+(error_event_t* dest_event, appd_iot_stack_trace_t* src_stack_trace, int src_stack_trace_count)
 {
 
-  if (dest_stack_trace_list == NULL)
+  if (dest_event == NULL)
   {
-    appd_iot_log(APPD_IOT_LOG_ERROR, "List to copy stack trace is NULL");
+    appd_iot_log(APPD_IOT_LOG_ERROR, "Event to copy stack trace is NULL");
     return APPD_IOT_ERR_INTERNAL;
   }
 
@@ -146,29 +150,53 @@ static appd_iot_error_code_t appd_iot_copy_stack_trace
     return APPD_IOT_ERR_NULL_PTR;
   }
 
+  size_t frame_count = 0;
+
+  for (int i = 0; i < src_stack_trace_count; i++)
+  {
+    if (src_stack_trace[i].stack_frame_count > 0)
+    {
+      frame_count += src_stack_trace[i].stack_frame_count;
+    }
+  }
+
+  //arrays are sized upfront, so that references to their elements stay valid while they are filled
+  dest_event->stack_traces.reserve(src_stack_trace_count);
+  dest_event->stack_frames.reserve(frame_count);
+
   for (int i = 0; i < src_stack_trace_count; i++)
   {
-    stack_trace_t dest_stack_trace;
+    const appd_iot_stack_trace_t& src_trace = src_stack_trace[i];
+
+    //stack trace and its frames are constructed in place in the event, so that they are copied only once
+    dest_event->stack_traces.push_back(stack_trace_t());
+
+    stack_trace_t& dest_stack_trace = dest_event->stack_traces.back();
 
     dest_stack_trace.runtime = "native";
+    dest_stack_trace.stack_frame_index = dest_event->stack_frames.size();
+    dest_stack_trace.stack_frame_count = 0;
 
     //dest_stack_trace has default values as empty strings
-    if (src_stack_trace->thread != NULL)
+    if (src_trace.thread != NULL)
     {
-      dest_stack_trace.thread = src_stack_trace->thread;
+      dest_stack_trace.thread = src_trace.thread;
     }
 
-    for (int j = 0; j < src_stack_trace->stack_frame_count; j++)
+    for (int j = 0; j < src_trace.stack_frame_count; j++)
     {
-      stack_frame_t dest_stack_frame;
-
-      if ((src_stack_trace->stack_frame + j) == NULL)
+      if ((src_trace.stack_frame + j) == NULL)
       {
         appd_iot_log(APPD_IOT_LOG_ERROR, "NULL stack frame found inside stack trace");
         return APPD_IOT_ERR_NULL_PTR;
       }
 
-      appd_iot_stack_frame_t src_stack_frame = src_stack_trace->stack_frame[j];
+      const appd_iot_stack_frame_t& src_stack_frame = src_trace.stack_frame[j];
+
+      dest_event->stack_frames.push_back(stack_frame_t());
+      dest_stack_trace.stack_frame_count++;
+
+      stack_frame_t& dest_stack_frame = dest_event->stack_frames.back();
 
       //dest_stack_frame has default values as empty strings
       if (src_stack_frame.symbol_name != NULL)
@@ -190,11 +218,7 @@ static appd_iot_error_code_t appd_iot_copy_stack_trace
       dest_stack_frame.absolute_addr = src_stack_frame.absolute_addr;
       dest_stack_frame.image_offset = src_stack_frame.image_offset;
       dest_stack_frame.symbol_offset = src_stack_frame.symbol_offset;
-
-      dest_stack_trace.stack_frame_list.push_back(dest_stack_frame);
     }
-
-    dest_stack_trace_list->push_back(dest_stack_trace);
   }
 
   return APPD_IOT_SUCCESS;
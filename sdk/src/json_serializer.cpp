@@ -14,12 +14,16 @@
  * limitations under the License.
  */
 
+//Log statements in this file belong to serializer subsystem
+#define APPD_IOT_LOG_SUBSYSTEM APPD_IOT_LOG_SUBSYSTEM_SERIALIZER
+
 //To enable format macros like PRId64
 #ifndef __STDC_FORMAT_MACROS
 #define __STDC_FORMAT_MACROS
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 #include <string>
 #include <inttypes.h>
 #include "json_serializer.hpp"
@@ -31,6 +35,9 @@
 #define END_OBJECT_CHAR '}'
 #define END_ARRAY_CHAR ']'
 #define JSON_DELIMITER ','
+#define APPD_IOT_JSON_MAX_ESCAPED_CHAR_LEN 6
+//%f of the largest double has 309 integer digits, a sign, a decimal point and 6 decimals
+#define APPD_IOT_JSON_MAX_NUMBER_LEN 320
 
 static appd_iot_error_code_t appd_iot_check_and_expand_json_buf_size(json_t* json, size_t len);
 static appd_iot_error_code_t appd_iot_json_start(json_t* json, char begin, const char* name);
@@ -39,6 +46,7 @@ static appd_iot_error_code_t appd_iot_json_add_key_value(json_t* json,
     const char* key, const void* value, appd_iot_data_types_t type);
 static appd_iot_error_code_t appd_iot_json_add_value(json_t* json, const void* value,
     appd_iot_data_types_t type);
+std::string appd_iot_add_escape_char(const void* value);
 
 static const char* comma = ",";
 
@@ -93,10 +101,12 @@ static appd_iot_error_code_t appd_iot_json_start(json_t* json, char begin, const
 
   size_t len = 1; //there will be atleast 1 char and a terminating null character
   const char* eol = &comma[1]; //initialized to null character '/0'
+  std::string escaped_name;
 
   if (name != NULL)
   {
-    len = len + strlen(name) + 3; //2 double quotes and 1 colon "name:"begin
+    escaped_name = appd_iot_add_escape_char(name);
+    len = len + escaped_name.length() + 3; //2 double quotes and 1 colon "name:"begin
   }
 
   //add comma at the end if last operation is not start
@@ -115,7 +125,7 @@ static appd_iot_error_code_t appd_iot_json_start(json_t* json, char begin, const
 
   if (name != NULL)
   {
-    snprintf(json->buf + json->len, len + 1, "%s\"%s\":%c", eol, name, begin);
+    snprintf(json->buf + json->len, len + 1, "%s\"%s\":%c", eol, escaped_name.c_str(), begin);
   }
   else
   {
@@ -189,6 +199,7 @@ static appd_iot_error_code_t appd_iot_json_end(json_t* json, char end)
 
   json->buf[json->len] = end;
   json->len++;
+  json->buf[json->len] = '\0';
 
   if (end == END_OBJECT_CHAR)
   {
@@ -224,22 +235,21 @@ appd_iot_error_code_t appd_iot_json_end_array(json_t* json)
 
 /**
  * @brief adds escape character to the string if applicable.
- * Unicode characters are currently not handled.
+ * Control characters without a short escape sequence are escaped as \u00XX. Bytes of
+ * multi-byte UTF-8 characters are copied as is.
  * @param value is the string which is to be escaped.
  * @return std::string contains modified string with escape characters included
  */
 std::string appd_iot_add_escape_char(const void* value)
 {
-  char* temp = (char*)value;
-  std::string s = "";
+  const char* temp = (const char*)value;
+  std::string s;
 
+  s.reserve(strlen(temp));
 
-  for (size_t i = 0; i < strlen(temp); i++)
+  for (const char* c = temp; *c != '\0'; c++)
   {
-    //Reading only 0 to 127 ascii values. unicode characters are not handled.
-    unsigned char t = (temp[i] & 0x7F);
-
-    switch (t)
+    switch (*c)
     {
       case '\b':
         s += "\\b";
@@ -274,8 +284,19 @@ std::string appd_iot_add_escape_char(const void* value)
         break;
 
       default:
-        //if escape sequence not detected, retain the original character
-        s.push_back(temp[i]);
+        if ((unsigned char)*c < 0x20)
+        {
+          char escaped[8];
+
+          snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int)(unsigned char)*c);
+          s += escaped;
+        }
+        else
+        {
+          //if escape sequence not detected, retain the original character
+          s.push_back(*c);
+        }
+
         break;
     }
   }
@@ -310,9 +331,22 @@ appd_iot_error_code_t appd_iot_convert_to_string
       break;
 
     case APPD_IOT_DOUBLE:
-      snprintf(buf, bufsize, "%f", *(double*)value);
+    {
+      double doubleval = *(double*)value;
+
+      //nan and infinity are not valid json numbers
+      if (doubleval - doubleval == 0)
+      {
+        snprintf(buf, bufsize, "%f", doubleval);
+      }
+      else
+      {
+        snprintf(buf, bufsize, "null");
+      }
+
       buf[bufsize - 1] = '\0';
       break;
+    }
 
     case APPD_IOT_BOOLEAN:
       snprintf(buf, bufsize, "%s", *(bool*)value ? "true" : "false");
@@ -344,12 +378,12 @@ static appd_iot_error_code_t appd_iot_json_add_key_value
   }
 
   char* strval;
-  size_t value_size = 256; //default size for integer, double and boolean types
+  size_t value_size = APPD_IOT_JSON_MAX_NUMBER_LEN; //default size for integer, double and boolean types
 
-  //for string, set size to twice the original length to accomodate any escape characters.
+  //for string, set size to six times the original length to accomodate escape sequences up to \u00XX
   if (type == APPD_IOT_STRING)
   {
-    value_size = 2 * strlen((char*)value);
+    value_size = APPD_IOT_JSON_MAX_ESCAPED_CHAR_LEN * strlen((char*)value) + 1;
   }
 
   strval = (char*)calloc(1, value_size);
@@ -368,7 +402,8 @@ static appd_iot_error_code_t appd_iot_json_add_key_value
     return retcode;
   }
 
-  size_t len = strlen(key) + strlen(strval);
+  std::string escaped_key = appd_iot_add_escape_char(key);
+  size_t len = escaped_key.length() + strlen(strval);
 
   //add space for extra characters doublequote(") and colon(:)
   if (type == APPD_IOT_STRING)
@@ -401,13 +436,13 @@ static appd_iot_error_code_t appd_iot_json_add_key_value
   {
     case APPD_IOT_STRING:
       //snprintf copies string of size 'len' into buffer
-      snprintf(json->buf + json->len, len + 1, "%s\"%s\":\"%s\"", eol, key, strval);
+      snprintf(json->buf + json->len, len + 1, "%s\"%s\":\"%s\"", eol, escaped_key.c_str(), strval);
       break;
 
     case APPD_IOT_INTEGER:
     case APPD_IOT_DOUBLE:
     case APPD_IOT_BOOLEAN:
-      snprintf(json->buf + json->len, len + 1, "%s\"%s\":%s", eol, key, strval);
+      snprintf(json->buf + json->len, len + 1, "%s\"%s\":%s", eol, escaped_key.c_str(), strval);
       break;
 
     default:
@@ -491,12 +526,12 @@ static appd_iot_error_code_t appd_iot_json_add_value
   }
 
   char* strval;
-  size_t value_size = 256; //default size for integer, double and boolean types
+  size_t value_size = APPD_IOT_JSON_MAX_NUMBER_LEN; //default size for integer, double and boolean types
 
-  //for string, set size to twice the original length to accomodate any escape characters.
+  //for string, set size to six times the original length to accomodate escape sequences up to \u00XX
   if (type == APPD_IOT_STRING)
   {
-    value_size = 2 * strlen((char*)value);
+    value_size = APPD_IOT_JSON_MAX_ESCAPED_CHAR_LEN * strlen((char*)value) + 1;
   }
 
   strval = (char*)calloc(1, value_size);
@@ -616,6 +651,47 @@ appd_iot_error_code_t appd_iot_json_add_boolean_value(json_t* json, bool boolval
   return appd_iot_json_add_value(json, (void*)(&boolval), APPD_IOT_BOOLEAN);
 }
 
+/**
+ * @brief adds values which are already serialized to json array, such as events serialized in another
+ * json struct. Values are copied as is, they must be valid JSON separated by commas.
+ * @param json struct which contains the json buf
+ * @param value contains serialized JSON values
+ * @param value_len contains length of value
+ * @return appd_iot_error_code_t indicating function execution status
+ */
+appd_iot_error_code_t appd_iot_json_add_json_value(json_t* json, const char* value, size_t value_len)
+{
+  if (json == NULL || value == NULL)
+  {
+    return APPD_IOT_ERR_NULL_PTR;
+  }
+
+  bool add_comma = (json->last_op != START_OBJECT && json->last_op != START_ARRAY && json->last_op != INIT);
+  size_t len = add_comma ? value_len + 1 : value_len;
+
+  appd_iot_error_code_t retcode = appd_iot_check_and_expand_json_buf_size(json, len);
+
+  if (retcode != APPD_IOT_SUCCESS)
+  {
+    return retcode;
+  }
+
+  char* buf = json->buf + json->len;
+
+  if (add_comma)
+  {
+    *buf++ = JSON_DELIMITER;
+  }
+
+  memcpy(buf, value, value_len);
+
+  json->len = json->len + len;
+  json->buf[json->len] = '\0';
+  json->last_op = ADD_DATA;
+
+  return APPD_IOT_SUCCESS;
+}
+
 /**
  * @brief returns the json string constructed so far.
  * @param json struct which contains the json buf
@@ -724,6 +800,22 @@ const char* appd_iot_json_pretty_print(json_t* json)
   return json->printbuf;
 }
 
+/**
+ * @brief discards json string constructed so far, keeping the buffer for reuse
+ * @param json struct which contains the json buf
+ */
+void appd_iot_json_reset(json_t* json)
+{
+  if (json == NULL)
+  {
+    return;
+  }
+
+  json->len = 0;
+  json->buf[0] = '\0';
+  json->last_op = INIT;
+}
+
 /**
  * @brief frees json structure
  * @param json struct which contains the json buf
@@ -153,6 +153,16 @@ appd_iot_error_code_t appd_iot_json_add_double_value(json_t* json, double double
  */
 appd_iot_error_code_t appd_iot_json_add_boolean_value(json_t* json, bool boolval);
 
+/**
+ * @brief adds values which are already serialized to json array, such as events serialized in another
+ * json struct. Values are copied as is, they must be valid JSON separated by commas.
+ * @param json struct which contains the json buf
+ * @param value contains serialized JSON values
+ * @param value_len contains length of value
+ * @return appd_iot_error_code_t indicating function execution status
+ */
+appd_iot_error_code_t appd_iot_json_add_json_value(json_t* json, const char* value, size_t value_len);
+
 /**
  * @brief returns the json string constructed so far.
  * @param json struct which contains the json buf
@@ -167,6 +177,12 @@ const char* appd_iot_json_get_string(json_t* json);
  */
 const char* appd_iot_json_pretty_print(json_t* json);
 
+/**
+ * @brief discards json string constructed so far, keeping the buffer for reuse
+ * @param json struct which contains the json buf
+ */
+void appd_iot_json_reset(json_t* json);
+
 /**
  * @brief frees json structure
  * @param json struct which contains the json buf
@@ -19,26 +19,47 @@
 #define __STDC_FORMAT_MACROS
 #endif
 
+#include <time.h>
 #include <unistd.h>
 #include <sys/uio.h>
 #include <string.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include "log.hpp"
+#include "log_async.hpp"
+#include "log_binary.hpp"
+#include "log_file.hpp"
 #include "config.hpp"
+#include "atomic.hpp"
+#include "clock.hpp"
+#include "json_serializer.hpp"
 
 //This includes both log header and log message
 #define LOG_MAX_SIZE 2048
 
-//Default Log Header. First Character represents log level as given in loglevel_str[]
-#define LOG_HEADER "E/APPDYNAMICS: "
-#define LOG_HEADER_LEN (sizeof(LOG_HEADER) - 1)
-
 #define ERROR_LOG_MSG "<NULL Log Message>"
 
+//A message in log rate limiter token bucket, which holds tokens in 1/1000th of a message
+#define LOG_RATE_TOKEN 1000ULL
+#define LOG_RATE_TOKEN_BITS 20
+
 static char loglevel_c[APPD_IOT_MAX_LOG_LEVELS] = {'O', 'E', 'W', 'I', 'D', 'V', 'A'};
 
-static void log_write_to_stderr(const char* logmsg, size_t logmsg_len);
+//Values of level and subsystem fields in JSON log messages
+static const char* loglevel_str[APPD_IOT_MAX_LOG_LEVELS] = {"OFF", "ERROR", "WARN", "INFO", "DEBUG", "VERBOSE", "ALL"};
+static const char* logsubsystem_str[APPD_IOT_MAX_LOG_SUBSYSTEMS] = {"beacon", "serializer", "transport", "config", "events"};
+
+/* JSON writer of each thread, reused for every JSON log message and freed on thread exit */
+static __thread json_t* thread_log_json = NULL;
+static __thread bool thread_log_json_busy = false;
+
+/* fields of the next message logged by the thread, set by appd_iot_log_with_fields() */
+static __thread const appd_iot_log_fields_t* thread_log_fields = NULL;
+static pthread_key_t log_json_key;
+static pthread_once_t log_json_key_once = PTHREAD_ONCE_INIT;
+
+static void log_write_to_stderr(const char* logmsg, size_t logmsg_len, int64_t timestamp_ms);
 
 static const char* error_code_to_str[APPD_IOT_MAX_ERROR_CODES] =
 {
@@ -82,31 +103,182 @@ static const char* sdk_state_to_str[APPD_IOT_MAX_SDK_STATES] =
 };
 
 /**
- * @brief Reads log message, appends log header and triggers log write callback function
- * @param log_level indicates log level listed in log_detail_t
- * @param format Printf Format String
+ * @brief Frees JSON writer of an exiting thread
+ */
+static void log_json_free(void* json)
+{
+  appd_iot_json_free((json_t*)json);
+}
+
+
+/**
+ * @brief Creates key used to free JSON writer on thread exit
+ */
+static void log_json_key_create(void)
+{
+  pthread_key_create(&log_json_key, &log_json_free);
+}
+
+
+/**
+ * @brief Sets fields of the next message logged by the calling thread
+ * @param fields contains fields of the next message, must be valid until message is logged
  */
-void appd_iot_log(appd_iot_log_level_t log_level, const char* format, ...)
+void appd_iot_log_set_fields(const appd_iot_log_fields_t* fields)
 {
-  //check for log level
-  appd_iot_log_level_t configlog_level = appd_iot_get_log_level();
+  thread_log_fields = fields;
+}
+
 
-  if (log_level > configlog_level)
+/**
+ * @brief Formats log message as a single line JSON object with fields ts, level, subsystem and message,
+ * followed by fields set in appd_iot_log_fields_t, using a JSON writer owned by the calling thread.
+ * @param log_level indicates log level listed in appd_iot_log_level_t
+ * @param subsystem indicates log subsystem listed in appd_iot_log_subsystem_t
+ * @param timestamp_ms contains time at which message was logged
+ * @param message contains null terminated log message without log header
+ * @param fields contains fields of the log statement, NULL if it has none
+ * @param json_len is set to length of JSON object
+ * @return JSON object, valid until next call on the calling thread. NULL on failure
+ */
+const char* appd_iot_log_format_json(appd_iot_log_level_t log_level, appd_iot_log_subsystem_t subsystem,
+                                     int64_t timestamp_ms, const char* message,
+                                     const appd_iot_log_fields_t* fields, size_t* json_len)
+{
+  //JSON writer logs its own errors, which are written as text
+  if (thread_log_json_busy)
   {
-    return;
+    return NULL;
   }
 
+  if (thread_log_json == NULL)
+  {
+    thread_log_json = appd_iot_json_init();
+
+    if (thread_log_json == NULL)
+    {
+      return NULL;
+    }
+
+    pthread_once(&log_json_key_once, &log_json_key_create);
+    pthread_setspecific(log_json_key, thread_log_json);
+  }
+
+  json_t* json = thread_log_json;
+  appd_iot_error_code_t retcode;
+
+  thread_log_json_busy = true;
+  appd_iot_json_reset(json);
+
+  retcode = appd_iot_json_start_object(json, NULL);
+
+  if (retcode == APPD_IOT_SUCCESS)
+  {
+    retcode = appd_iot_json_add_integer_key_value(json, "ts", timestamp_ms);
+  }
+
+  if (retcode == APPD_IOT_SUCCESS)
+  {
+    retcode = appd_iot_json_add_string_key_value(json, "level", loglevel_str[log_level]);
+  }
+
+  if (retcode == APPD_IOT_SUCCESS)
+  {
+    retcode = appd_iot_json_add_string_key_value(json, "subsystem", logsubsystem_str[subsystem]);
+  }
+
+  if (retcode == APPD_IOT_SUCCESS)
+  {
+    retcode = appd_iot_json_add_string_key_value(json, "message", message);
+  }
+
+  if (fields != NULL)
+  {
+    if (retcode == APPD_IOT_SUCCESS && fields->event_type != NULL)
+    {
+      retcode = appd_iot_json_add_string_key_value(json, "event_type", fields->event_type);
+    }
+
+    if (retcode == APPD_IOT_SUCCESS && fields->resp_code != APPD_IOT_LOG_NO_RESP_CODE)
+    {
+      retcode = appd_iot_json_add_integer_key_value(json, "resp_code", fields->resp_code);
+    }
+
+    if (retcode == APPD_IOT_SUCCESS && fields->error_code != APPD_IOT_LOG_NO_ERROR_CODE)
+    {
+      retcode = appd_iot_json_add_string_key_value(json, "error_code",
+                appd_iot_error_code_to_str((appd_iot_error_code_t)fields->error_code));
+    }
+  }
+
+  if (retcode == APPD_IOT_SUCCESS)
+  {
+    retcode = appd_iot_json_end_object(json);
+  }
+
+  thread_log_json_busy = false;
+
+  if (retcode != APPD_IOT_SUCCESS)
+  {
+    return NULL;
+  }
+
+  *json_len = json->len;
+
+  return appd_iot_json_get_string(json);
+}
+
+
+/**
+ * @brief Reads log message, appends log header or formats it as JSON, and triggers log write
+ * callback function
+ * @param log_level indicates log level listed in appd_iot_log_level_t
+ * @param subsystem indicates log subsystem listed in appd_iot_log_subsystem_t
+ * @param format Printf Format String
+ */
+void appd_iot_log_message(appd_iot_log_level_t log_level, appd_iot_log_subsystem_t subsystem,
+                          const char* format, ...)
+{
+  //cleared before formatting, so that messages logged while formatting this one do not carry them
+  const appd_iot_log_fields_t* fields = thread_log_fields;
+
+  thread_log_fields = NULL;
+
+  //log level is checked by appd_iot_log()
   if (log_level >= APPD_IOT_MAX_LOG_LEVELS)
   {
     log_level = APPD_IOT_LOG_ERROR;
   }
 
-  //check for log write cb
-  appd_iot_log_write_cb_t log_write_cb = appd_iot_get_log_write_cb();
+  if (subsystem >= APPD_IOT_MAX_LOG_SUBSYSTEMS)
+  {
+    subsystem = APPD_IOT_LOG_SUBSYSTEM_CONFIG;
+  }
+
+  appd_iot_log_mode_t log_mode = appd_iot_get_log_mode();
+  bool structured = (appd_iot_get_log_format() == APPD_IOT_LOG_FORMAT_JSON);
+  va_list args;
 
-  if (log_write_cb == NULL)
+  //queue raw args to be formatted by background thread or log decoder
+  if (log_mode == APPD_IOT_LOG_MODE_BINARY && !structured)
   {
-    log_write_cb = &log_write_to_stderr;
+    const log_binary_args_t* format_args;
+    uint16_t format_id = appd_iot_log_binary_get_format_id(format, &format_args);
+
+    if (format_id != 0)
+    {
+      char payload[LOG_MAX_SIZE];
+
+      va_start(args, format);
+      int payload_len = log_binary_encode(format_args, args, payload, sizeof(payload));
+      va_end(args);
+
+      if (payload_len >= 0)
+      {
+        appd_iot_log_async_write_binary(log_level, format_id, payload, payload_len);
+        return;
+      }
+    }
   }
 
   //initilize logbuf with log header
@@ -116,8 +288,6 @@ void appd_iot_log(appd_iot_log_level_t log_level, const char* format, ...)
   //update log level in the log header
   logbuf[0] = loglevel_c[log_level];
 
-  va_list args;
-
   //read log message
   va_start(args, format);
   int nchar = vsnprintf(logbuf + LOG_HEADER_LEN, (LOG_MAX_SIZE - LOG_HEADER_LEN), format, args);
@@ -138,16 +308,162 @@ void appd_iot_log(appd_iot_log_level_t log_level, const char* format, ...)
     logmsg_len = LOG_HEADER_LEN + nchar;
   }
 
-  //trigger callback to write log msg
-  log_write_cb(logbuf, logmsg_len);
+  const char* logmsg = logbuf;
+  int64_t timestamp_ms = appd_iot_clock_get_time_ms();
+
+  //JSON message carries its own timestamp, it is written as text if it cannot be formatted
+  if (structured)
+  {
+    size_t json_len;
+    const char* json = appd_iot_log_format_json(log_level, subsystem, timestamp_ms, logbuf + LOG_HEADER_LEN,
+                                                fields, &json_len);
+
+    if (json != NULL)
+    {
+      logmsg = json;
+      logmsg_len = json_len;
+      timestamp_ms = APPD_IOT_LOG_NO_TIMESTAMP;
+    }
+    else
+    {
+      structured = false;
+    }
+  }
+
+  //queue log msg to be written by background thread
+  if (log_mode != APPD_IOT_LOG_MODE_SYNC)
+  {
+    appd_iot_log_async_write(log_level, logmsg, logmsg_len, structured);
+    return;
+  }
+
+  //check for log write cb
+  appd_iot_log_write_cb_t log_write_cb = appd_iot_get_log_write_cb();
+
+  if (log_write_cb != NULL)
+  {
+    //trigger callback to write log msg
+    log_write_cb(logmsg, logmsg_len);
+  }
+  else if (!appd_iot_log_file_write(log_level, logmsg, logmsg_len, timestamp_ms))
+  {
+    log_write_to_stderr(logmsg, logmsg_len, timestamp_ms);
+  }
+}
+
+/**
+ * @brief Writes log message with given log write callback and log format instead of those in SDK config.
+ * Used to report errors of SDK init which fails before its config is published.
+ * @param log_write_cb contains callback to which log message is written
+ * @param log_format indicates if log message is written as text or JSON
+ * @param log_level indicates log level listed in appd_iot_log_level_t
+ * @param subsystem indicates log subsystem listed in appd_iot_log_subsystem_t
+ * @param message contains null terminated log message without log header
+ */
+void appd_iot_log_write_to_cb(appd_iot_log_write_cb_t log_write_cb, appd_iot_log_format_t log_format,
+                              appd_iot_log_level_t log_level, appd_iot_log_subsystem_t subsystem,
+                              const char* message)
+{
+  if (log_write_cb == NULL || log_level >= APPD_IOT_MAX_LOG_LEVELS || subsystem >= APPD_IOT_MAX_LOG_SUBSYSTEMS)
+  {
+    return;
+  }
+
+  if (log_format == APPD_IOT_LOG_FORMAT_JSON)
+  {
+    size_t json_len;
+    const char* json = appd_iot_log_format_json(log_level, subsystem, appd_iot_clock_get_time_ms(), message,
+                                                NULL, &json_len);
+
+    if (json != NULL)
+    {
+      log_write_cb(json, json_len);
+      return;
+    }
+  }
+
+  char logbuf[LOG_MAX_SIZE];
+  int nchar = snprintf(logbuf, sizeof(logbuf), "%c%s%s", loglevel_c[log_level], LOG_HEADER + 1, message);
+
+  if (nchar >= 0)
+  {
+    log_write_cb(logbuf, ((size_t)nchar < sizeof(logbuf)) ? (size_t)nchar : sizeof(logbuf) - 1);
+  }
+}
+
+/**
+ * @brief Takes a token from rate limiter of a log statement. If a message is logged after messages
+ * were suppressed, logs the number of suppressed messages first.
+ * @param site contains rate limiter state of the log statement
+ * @param log_level indicates log level of the message
+ * @param subsystem indicates log subsystem of the log statement
+ * @return true if message is to be logged, false if it is over rate limit
+ */
+bool appd_iot_log_rate_limit_acquire(appd_iot_log_site_t* site, appd_iot_log_level_t log_level,
+                                     appd_iot_log_subsystem_t subsystem)
+{
+  int rate_limit = appd_iot_get_log_rate_limit();
+
+  if (rate_limit <= 0)
+  {
+    return true;
+  }
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+
+  //token bucket holding up to rate_limit messages, refilled at rate_limit messages per second
+  uint64_t now_ms = (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000 + 1;
+  uint64_t capacity = (uint64_t)rate_limit * LOG_RATE_TOKEN;
+  uint64_t bucket = appd_iot_atomic_load(&site->bucket);
+  uint64_t new_bucket;
+  bool acquired;
+
+  do
+  {
+    uint64_t last_ms = bucket >> LOG_RATE_TOKEN_BITS;
+    uint64_t tokens = bucket & ((1ULL << LOG_RATE_TOKEN_BITS) - 1);
+
+    if (bucket == 0 || now_ms < last_ms)
+    {
+      tokens = capacity;
+    }
+    else
+    {
+      tokens += (now_ms - last_ms) * rate_limit;
+    }
+
+    tokens = (tokens < capacity) ? tokens : capacity;
+    acquired = (tokens >= LOG_RATE_TOKEN);
+    tokens -= acquired ? LOG_RATE_TOKEN : 0;
+    new_bucket = (now_ms << LOG_RATE_TOKEN_BITS) | tokens;
+  }
+  while (!appd_iot_atomic_compare_exchange(&site->bucket, &bucket, new_bucket));
+
+  if (!acquired)
+  {
+    appd_iot_atomic_fetch_add(&site->suppressed, (uint32_t)1);
+    return false;
+  }
+
+  uint32_t suppressed = appd_iot_atomic_exchange(&site->suppressed, (uint32_t)0);
+
+  if (suppressed > 0)
+  {
+    appd_iot_log_message(log_level, subsystem, "Suppressed %u Similar Log Messages", suppressed);
+  }
+
+  return true;
 }
 
 /**
  * @brief Prefixes Log Message with timestamp and writes to stderr. <br>
  * @param logmsg contains the log message without the newline char at the end
  * @param logmsg_len contains the length of log message
+ * @param timestamp_ms contains time at which message was logged, APPD_IOT_LOG_NO_TIMESTAMP for none
  */
-static void log_write_to_stderr(const char* logmsg, size_t logmsg_len)
+static void log_write_to_stderr(const char* logmsg, size_t logmsg_len, int64_t timestamp_ms)
 {
   if (logmsg == NULL)
   {
@@ -156,19 +472,15 @@ static void log_write_to_stderr(const char* logmsg, size_t logmsg_len)
 
   int iovcnt;
   struct iovec iov[3];
-  char timestamp[32];
+  char timestamp[APPD_IOT_TIME_MS_STR_SIZE + 1];
   char eol = '\n';
 
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
+  size_t timestamp_len = 0;
 
-  int64_t time_in_ms = (int64_t)tv.tv_sec * 1000 + (int64_t)tv.tv_usec / 1000;
-  size_t timestamp_len = snprintf(timestamp, sizeof(timestamp), "%" PRId64 " ", time_in_ms);
-
-  if (timestamp_len >= sizeof(timestamp))
+  if (timestamp_ms != APPD_IOT_LOG_NO_TIMESTAMP)
   {
-    timestamp_len = sizeof(timestamp) - 1;
-    timestamp[timestamp_len] = '\0';
+    timestamp_len = appd_iot_clock_format_time_ms(timestamp_ms, timestamp, sizeof(timestamp) - 1);
+    timestamp[timestamp_len++] = ' ';
   }
 
   iov[0].iov_base = (void*)timestamp;
@@ -185,6 +497,21 @@ static void log_write_to_stderr(const char* logmsg, size_t logmsg_len)
   writev(STDERR_FILENO, iov, iovcnt);
 }
 
+/**
+ * @brief Get character representing log level in log header
+ * @param log_level indicates log level listed in appd_iot_log_level_t
+ * @return log level character, 'E' for invalid log level
+ */
+char appd_iot_log_level_to_char(appd_iot_log_level_t log_level)
+{
+  if (log_level >= APPD_IOT_MAX_LOG_LEVELS)
+  {
+    return loglevel_c[APPD_IOT_LOG_ERROR];
+  }
+
+  return loglevel_c[log_level];
+}
+
 /**
  * @brief Convert error code to string
  * @param error_code that is to be converted to string
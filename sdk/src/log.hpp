@@ -19,15 +19,204 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <sys/time.h>
 #include <appd_iot_interface.h>
+#include "config.hpp"
+
+//Default Log Header. First Character represents log level as given in loglevel_c[]
+#define LOG_HEADER "E/APPDYNAMICS: "
+#define LOG_HEADER_LEN (sizeof(LOG_HEADER) - 1)
+
+/*
+ * Log statements above this level are compiled out, without evaluating their arguments.
+ * Set with cmake option -DAPPD_IOT_LOG_COMPILE_LEVEL=<OFF|ERROR|WARN|INFO|DEBUG|VERBOSE|ALL>
+ */
+#ifndef APPD_IOT_LOG_COMPILE_LEVEL
+#define APPD_IOT_LOG_COMPILE_LEVEL APPD_IOT_LOG_ALL
+#endif
+
+/*
+ * Subsystem of log statements in a source file. Define before including this header,
+ * or redefine before a group of functions which belong to another subsystem.
+ */
+#ifndef APPD_IOT_LOG_SUBSYSTEM
+#define APPD_IOT_LOG_SUBSYSTEM APPD_IOT_LOG_SUBSYSTEM_CONFIG
+#endif
+
+//Timestamp of log messages which carry their own timestamp, as JSON log messages do.
+//Log writers do not prefix such messages with timestamp.
+#define APPD_IOT_LOG_NO_TIMESTAMP -1
+
+//Maximum value of log rate limit, in messages per second
+#define APPD_IOT_LOG_MAX_RATE_LIMIT 1000
+
+/**
+ * @brief Rate limiter state of a single log statement. Zero initialized.
+ */
+typedef struct
+{
+  uint64_t bucket;      /* time of last refill in ms and tokens in 1/1000th of a message, packed */
+  uint32_t suppressed;  /* messages dropped since last message logged */
+} appd_iot_log_site_t;
+
+//Values of unset fields in appd_iot_log_fields_t
+#define APPD_IOT_LOG_NO_RESP_CODE 0
+#define APPD_IOT_LOG_NO_ERROR_CODE -1
 
 /**
- * @brief Reads log message, appends log header and triggers log write callback function
- * @param log_level indicates log level listed in log_detail_t
+ * @brief Values a log statement carries besides its message. In APPD_IOT_LOG_FORMAT_JSON they are
+ * written as separate keys event_type, resp_code and error_code, so that log lines can be filtered
+ * without parsing message. Unset fields are omitted. Text log messages carry them in message only.
+ */
+typedef struct
+{
+  const char* event_type;  /* type of custom event, NULL if not set */
+  int resp_code;           /* http response code, APPD_IOT_LOG_NO_RESP_CODE if not set */
+  int error_code;          /* appd_iot_error_code_t, APPD_IOT_LOG_NO_ERROR_CODE if not set */
+} appd_iot_log_fields_t;
+
+/**
+ * @brief Logs message if log_level is enabled at compile time and for the subsystem in SDK config,
+ * and log statement is within log rate limit. <br>
+ * Arguments are evaluated only if the message is logged.
+ * @param log_level indicates log level listed in appd_iot_log_level_t
+ * @param ... Printf Format String followed by its arguments
+ */
+#define appd_iot_log(log_level, ...) \
+  do \
+  { \
+    if ((log_level) <= APPD_IOT_LOG_COMPILE_LEVEL && \
+        (log_level) <= appd_iot_get_subsystem_log_level(APPD_IOT_LOG_SUBSYSTEM)) \
+    { \
+      static appd_iot_log_site_t appd_iot_log_site; \
+      if (appd_iot_log_rate_limit_acquire(&appd_iot_log_site, (log_level), APPD_IOT_LOG_SUBSYSTEM)) \
+      { \
+        appd_iot_log_message((log_level), APPD_IOT_LOG_SUBSYSTEM, __VA_ARGS__); \
+      } \
+    } \
+  } while (0)
+
+/**
+ * @brief Same as appd_iot_log(), with fields written as separate keys of JSON log message
+ * @param log_level indicates log level listed in appd_iot_log_level_t
+ * @param fields contains appd_iot_log_fields_t of the log statement, evaluated only if message is logged
+ * @param ... Printf Format String followed by its arguments
+ */
+#define appd_iot_log_with_fields(log_level, fields, ...) \
+  do \
+  { \
+    if ((log_level) <= APPD_IOT_LOG_COMPILE_LEVEL && \
+        (log_level) <= appd_iot_get_subsystem_log_level(APPD_IOT_LOG_SUBSYSTEM)) \
+    { \
+      static appd_iot_log_site_t appd_iot_log_site; \
+      if (appd_iot_log_rate_limit_acquire(&appd_iot_log_site, (log_level), APPD_IOT_LOG_SUBSYSTEM)) \
+      { \
+        appd_iot_log_fields_t appd_iot_log_fields_value = (fields); \
+        appd_iot_log_set_fields(&appd_iot_log_fields_value); \
+        appd_iot_log_message((log_level), APPD_IOT_LOG_SUBSYSTEM, __VA_ARGS__); \
+      } \
+    } \
+  } while (0)
+
+/**
+ * @brief Get log fields with only event type set
+ * @param event_type contains type of custom event
+ * @return appd_iot_log_fields_t
+ */
+inline appd_iot_log_fields_t appd_iot_log_event_type_field(const char* event_type)
+{
+  appd_iot_log_fields_t fields = {event_type, APPD_IOT_LOG_NO_RESP_CODE, APPD_IOT_LOG_NO_ERROR_CODE};
+
+  return fields;
+}
+
+/**
+ * @brief Get log fields with only http response code set
+ * @param resp_code contains http response code
+ * @return appd_iot_log_fields_t
+ */
+inline appd_iot_log_fields_t appd_iot_log_resp_code_field(int resp_code)
+{
+  appd_iot_log_fields_t fields = {NULL, resp_code, APPD_IOT_LOG_NO_ERROR_CODE};
+
+  return fields;
+}
+
+/**
+ * @brief Get log fields with only error code set
+ * @param error_code contains error code listed in appd_iot_error_code_t
+ * @return appd_iot_log_fields_t
+ */
+inline appd_iot_log_fields_t appd_iot_log_error_code_field(appd_iot_error_code_t error_code)
+{
+  appd_iot_log_fields_t fields = {NULL, APPD_IOT_LOG_NO_RESP_CODE, (int)error_code};
+
+  return fields;
+}
+
+/**
+ * @brief Sets fields of the next message logged by the calling thread. Fields are cleared once
+ * message is logged. Use appd_iot_log_with_fields() instead of calling it directly.
+ * @param fields contains fields of the next message, must be valid until message is logged
+ */
+void appd_iot_log_set_fields(const appd_iot_log_fields_t* fields);
+
+/**
+ * @brief Takes a token from rate limiter of a log statement. If a message is logged after messages
+ * were suppressed, logs the number of suppressed messages first.
+ * @param site contains rate limiter state of the log statement
+ * @param log_level indicates log level of the message
+ * @param subsystem indicates log subsystem of the log statement
+ * @return true if message is to be logged, false if it is over rate limit
+ */
+bool appd_iot_log_rate_limit_acquire(appd_iot_log_site_t* site, appd_iot_log_level_t log_level,
+                                     appd_iot_log_subsystem_t subsystem);
+
+/**
+ * @brief Reads log message, appends log header or formats it as JSON, and triggers log write callback
+ * function. <br>
+ * Use appd_iot_log() so that disabled log statements are skipped without evaluating arguments.
+ * @param log_level indicates log level listed in appd_iot_log_level_t
+ * @param subsystem indicates log subsystem listed in appd_iot_log_subsystem_t
  * @param format Printf Format String
  */
-void appd_iot_log (appd_iot_log_level_t log_level,
-                   const char* format, ...) __attribute__((format(printf, 2, 3)));
+void appd_iot_log_message(appd_iot_log_level_t log_level, appd_iot_log_subsystem_t subsystem,
+                          const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief Formats log message as a single line JSON object with fields ts, level, subsystem and message,
+ * followed by fields set in appd_iot_log_fields_t, using a JSON writer owned by the calling thread.
+ * @param log_level indicates log level listed in appd_iot_log_level_t
+ * @param subsystem indicates log subsystem listed in appd_iot_log_subsystem_t
+ * @param timestamp_ms contains time at which message was logged
+ * @param message contains null terminated log message without log header
+ * @param fields contains fields of the log statement, NULL if it has none
+ * @param json_len is set to length of JSON object
+ * @return JSON object, valid until next call on the calling thread. NULL on failure
+ */
+const char* appd_iot_log_format_json(appd_iot_log_level_t log_level, appd_iot_log_subsystem_t subsystem,
+                                     int64_t timestamp_ms, const char* message,
+                                     const appd_iot_log_fields_t* fields, size_t* json_len);
+
+/**
+ * @brief Writes log message with given log write callback and log format instead of those in SDK config.
+ * Used to report errors of SDK init which fails before its config is published.
+ * @param log_write_cb contains callback to which log message is written
+ * @param log_format indicates if log message is written as text or JSON
+ * @param log_level indicates log level listed in appd_iot_log_level_t
+ * @param subsystem indicates log subsystem listed in appd_iot_log_subsystem_t
+ * @param message contains null terminated log message without log header
+ */
+void appd_iot_log_write_to_cb(appd_iot_log_write_cb_t log_write_cb, appd_iot_log_format_t log_format,
+                              appd_iot_log_level_t log_level, appd_iot_log_subsystem_t subsystem,
+                              const char* message);
+
+/**
+ * @brief Get character representing log level in log header
+ * @param log_level indicates log level listed in appd_iot_log_level_t
+ * @return log level character, 'E' for invalid log level
+ */
+char appd_iot_log_level_to_char(appd_iot_log_level_t log_level);
 
 #endif // _LOG_H
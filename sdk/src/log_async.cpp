@@ -0,0 +1,887 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <pthread.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/uio.h>
+#include "log.hpp"
+#include "log_async.hpp"
+#include "log_binary.hpp"
+#include "log_file.hpp"
+#include "config.hpp"
+#include "atomic.hpp"
+#include "clock.hpp"
+
+//Size of log ring per thread in bytes. Must be a power of 2
+#define LOG_RING_SIZE (64 * 1024)
+
+//Maximum number of log messages written with a single writev()
+#define LOG_MAX_BATCH 64
+
+//Maximum number of iovecs written with a single writev()
+#define LOG_MAX_IOV (LOG_MAX_BATCH * 3)
+
+//Time for which background thread lets log messages gather after being woken up
+#define LOG_FLUSH_INTERVAL_MS 10
+
+//Fill level of a ring at which background thread is woken up to write without waiting for more messages
+#define LOG_RING_WAKEUP_THRESHOLD (LOG_RING_SIZE / 2)
+
+#define LOG_CACHE_LINE 64
+
+//Size of buffer used to copy out or decode a single message
+#define LOG_MSG_MAX_SIZE 4096
+
+//Size of buffer holding binary log messages decoded for a single writev()
+#define LOG_DECODE_BUF_SIZE (16 * 1024)
+
+/**
+ * @brief Single producer, single consumer ring of log records owned by a thread. <br>
+ * Rings are never freed. Ring of a thread that exits is reused by the next thread which logs.
+ */
+typedef struct log_ring
+{
+  char data[LOG_RING_SIZE];
+  uint64_t head __attribute__((aligned(LOG_CACHE_LINE)));  /* bytes published, written by producer */
+  uint64_t tail __attribute__((aligned(LOG_CACHE_LINE)));  /* bytes consumed, written by consumer */
+  uint32_t dropped;      /* messages dropped as ring was full, since last write by consumer */
+  int in_use;            /* 1 while ring is owned by a thread */
+  struct log_ring* next; /* next ring in list of all rings */
+} log_ring_t;
+
+/**
+ * @brief Batch of log messages written to stderr or binary log file with a single writev(). <br>
+ * Only used by consumer, with consumer lock held.
+ */
+typedef struct
+{
+  struct iovec iov[LOG_MAX_IOV];
+  int iovcnt;
+  char timestamps[LOG_MAX_BATCH][APPD_IOT_TIME_MS_STR_SIZE + 1];
+  log_record_header_t format_headers[LOG_MAX_BATCH];
+  int count;
+  char decoded[LOG_DECODE_BUF_SIZE];
+  size_t decoded_len;
+} log_batch_t;
+
+/**
+ * @brief State of background thread, read by producers to decide if it has to be woken up
+ */
+typedef enum
+{
+  LOG_CONSUMER_IDLE,      /* blocked until any message is queued */
+  LOG_CONSUMER_BATCHING,  /* waiting for messages to gather, until interval expires or a ring fills up */
+  LOG_CONSUMER_DRAINING   /* writing queued messages, or not started. Producers do not wake it up */
+} log_consumer_state_t;
+
+static log_ring_t* global_log_rings = NULL;
+static __thread log_ring_t* thread_log_ring = NULL;
+static pthread_key_t log_ring_key;
+static pthread_once_t log_ring_key_once = PTHREAD_ONCE_INIT;
+
+/* serializes consumers: background thread and appd_iot_flush_log() */
+static pthread_mutex_t log_consumer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t log_thread_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool log_thread_started = false;
+
+/* background thread blocks on condition until woken up by producers */
+static pthread_mutex_t log_wakeup_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_wakeup_cond;
+static int log_consumer_state = LOG_CONSUMER_DRAINING;
+
+/* state below is protected by consumer lock */
+static log_batch_t log_batch;
+static int log_binary_fd = -1;
+static bool log_binary_format_written[LOG_BINARY_MAX_FORMATS + 1];
+
+static const char log_record_padding[LOG_RECORD_ALIGN] = {0};
+static const char log_dropped_format[] = "W/APPDYNAMICS: Dropped %u Log Messages, Log Ring Full";
+
+
+/**
+ * @brief Releases ring of an exiting thread, so that it can be reused by another thread. <br>
+ * Thread pointer is cleared first, so that messages logged by destructors which run later take over
+ * a ring again instead of writing to one owned by another thread.
+ * @param ring owned by exiting thread
+ */
+static void log_ring_release(void* ring)
+{
+  thread_log_ring = NULL;
+  appd_iot_atomic_store(&((log_ring_t*)ring)->in_use, 0);
+}
+
+
+/**
+ * @brief Creates key used to release ring on thread exit
+ */
+static void log_ring_key_create(void)
+{
+  pthread_key_create(&log_ring_key, &log_ring_release);
+}
+
+
+/**
+ * @brief Get ring of the calling thread, taking over a released ring or allocating a new one
+ * @return ring of calling thread, NULL on failure to allocate memory
+ */
+static log_ring_t* log_ring_get(void)
+{
+  if (thread_log_ring != NULL)
+  {
+    return thread_log_ring;
+  }
+
+  log_ring_t* ring;
+
+  for (ring = appd_iot_atomic_load(&global_log_rings); ring != NULL; ring = ring->next)
+  {
+    int in_use = 0;
+
+    if (appd_iot_atomic_compare_exchange(&ring->in_use, &in_use, 1))
+    {
+      break;
+    }
+  }
+
+  if (ring == NULL)
+  {
+    ring = (log_ring_t*)calloc(1, sizeof(log_ring_t));
+
+    if (ring == NULL)
+    {
+      return NULL;
+    }
+
+    ring->in_use = 1;
+    ring->next = appd_iot_atomic_load(&global_log_rings);
+
+    while (!appd_iot_atomic_compare_exchange(&global_log_rings, &ring->next, ring));
+  }
+
+  pthread_once(&log_ring_key_once, &log_ring_key_create);
+  pthread_setspecific(log_ring_key, ring);
+
+  thread_log_ring = ring;
+
+  return ring;
+}
+
+
+/**
+ * @brief Copies data into ring at given position, wrapping around the end of ring
+ */
+static void log_ring_copy_in(log_ring_t* ring, uint64_t pos, const void* src, size_t len)
+{
+  size_t offset = pos & (LOG_RING_SIZE - 1);
+  size_t first = (len < LOG_RING_SIZE - offset) ? len : LOG_RING_SIZE - offset;
+
+  memcpy(ring->data + offset, src, first);
+  memcpy(ring->data, (const char*)src + first, len - first);
+}
+
+
+/**
+ * @brief Copies data out of ring from given position, wrapping around the end of ring
+ */
+static void log_ring_copy_out(const log_ring_t* ring, uint64_t pos, void* dest, size_t len)
+{
+  size_t offset = pos & (LOG_RING_SIZE - 1);
+  size_t first = (len < LOG_RING_SIZE - offset) ? len : LOG_RING_SIZE - offset;
+
+  memcpy(dest, ring->data + offset, first);
+  memcpy((char*)dest + first, ring->data, len - first);
+}
+
+
+/**
+ * @brief Wakes up background thread if it is blocked with no queued messages, or if it is waiting
+ * for messages to gather and a ring just crossed the wakeup threshold. Must be called after
+ * publishing a record.
+ * @param threshold_crossed is true if ring fill level just crossed LOG_RING_WAKEUP_THRESHOLD
+ */
+static void log_wakeup_consumer(bool threshold_crossed)
+{
+  //pairs with the fence in log_thread_wait_for_records(), either this thread sees the consumer
+  //idle or the consumer sees the record just published
+  appd_iot_atomic_fence();
+
+  int state = appd_iot_atomic_load_relaxed(&log_consumer_state);
+
+  if (state == LOG_CONSUMER_DRAINING || (state == LOG_CONSUMER_BATCHING && !threshold_crossed))
+  {
+    return;
+  }
+
+  int next_state = threshold_crossed ? LOG_CONSUMER_DRAINING : LOG_CONSUMER_BATCHING;
+
+  //only the producer changing the state signals, others return
+  if (appd_iot_atomic_compare_exchange(&log_consumer_state, &state, next_state))
+  {
+    pthread_mutex_lock(&log_wakeup_lock);
+    pthread_cond_signal(&log_wakeup_cond);
+    pthread_mutex_unlock(&log_wakeup_lock);
+  }
+}
+
+
+/**
+ * @brief Queues log record in the ring of the calling thread. Payload is followed by a null char.
+ * @param header contains record type, format id and log level
+ * @param payload contains record payload
+ * @param payload_len contains length of payload
+ */
+static void log_ring_write(log_record_header_t* header, const char* payload, size_t payload_len)
+{
+  log_ring_t* ring = log_ring_get();
+
+  if (ring == NULL)
+  {
+    return;
+  }
+
+  size_t record_len = sizeof(*header) + payload_len + 1;
+
+  record_len = (record_len + LOG_RECORD_ALIGN - 1) & ~((size_t)LOG_RECORD_ALIGN - 1);
+
+  header->payload_len = (uint32_t)payload_len;
+  header->record_len = (uint32_t)record_len;
+  header->timestamp_ms = appd_iot_clock_get_time_ms();
+  header->reserved = 0;
+
+  uint64_t head = ring->head;
+  uint64_t used = head - appd_iot_atomic_load(&ring->tail);
+
+  if (used + record_len > LOG_RING_SIZE)
+  {
+    appd_iot_atomic_fetch_add(&ring->dropped, (uint32_t)1);
+    return;
+  }
+
+  log_ring_copy_in(ring, head, header, sizeof(*header));
+  log_ring_copy_in(ring, head + sizeof(*header), payload, payload_len);
+  log_ring_copy_in(ring, head + sizeof(*header) + payload_len, "", 1);
+
+  appd_iot_atomic_store(&ring->head, head + record_len);
+
+  log_wakeup_consumer(used < LOG_RING_WAKEUP_THRESHOLD && used + record_len >= LOG_RING_WAKEUP_THRESHOLD);
+}
+
+
+/**
+ * @brief Queues log message in the ring of the calling thread.
+ * @param log_level contains log level of the message
+ * @param logmsg contains log message including log header, or JSON log message
+ * @param logmsg_len contains length of log message
+ * @param structured is true for JSON log message, which is written without timestamp prefix
+ */
+void appd_iot_log_async_write(appd_iot_log_level_t log_level, const char* logmsg, size_t logmsg_len,
+                              bool structured)
+{
+  log_record_header_t header;
+
+  header.format_id = 0;
+  header.type = structured ? LOG_RECORD_JSON : LOG_RECORD_TEXT;
+  header.log_level = (uint8_t)log_level;
+
+  log_ring_write(&header, logmsg, logmsg_len);
+}
+
+
+/**
+ * @brief Queues raw arguments of a log call in the ring of the calling thread.
+ * @param log_level contains log level of the log call
+ * @param format_id contains id of format string
+ * @param payload contains raw arguments, as encoded by log_binary_encode()
+ * @param payload_len contains length of payload
+ */
+void appd_iot_log_async_write_binary(appd_iot_log_level_t log_level, uint16_t format_id,
+                                     const char* payload, size_t payload_len)
+{
+  log_record_header_t header;
+
+  header.format_id = format_id;
+  header.type = LOG_RECORD_BINARY;
+  header.log_level = (uint8_t)log_level;
+
+  log_ring_write(&header, payload, payload_len);
+}
+
+
+/**
+ * @brief Writes log messages in batch to stderr, or to binary log file if one is open
+ */
+static void log_batch_flush(log_batch_t* batch)
+{
+  int fd = (log_binary_fd >= 0) ? log_binary_fd : STDERR_FILENO;
+
+  if (batch->iovcnt > 0)
+  {
+    writev(fd, batch->iov, batch->iovcnt);
+  }
+
+  batch->iovcnt = 0;
+  batch->count = 0;
+  batch->decoded_len = 0;
+}
+
+
+/**
+ * @brief Adds buffer to batch
+ */
+static void log_batch_add_iov(log_batch_t* batch, const void* base, size_t len)
+{
+  batch->iov[batch->iovcnt].iov_base = (void*)base;
+  batch->iov[batch->iovcnt].iov_len = len;
+  batch->iovcnt++;
+}
+
+
+/**
+ * @brief Get space in batch to decode a message into, flushing batch if there is not enough space
+ */
+static char* log_batch_get_decode_buf(log_batch_t* batch)
+{
+  if (batch->decoded_len + LOG_MSG_MAX_SIZE > sizeof(batch->decoded))
+  {
+    log_batch_flush(batch);
+  }
+
+  return batch->decoded + batch->decoded_len;
+}
+
+
+/**
+ * @brief Writes log message using log write callback or to log file, or adds it to batch written to stderr
+ * @param batch to which message is added if there is no log write callback
+ * @param log_write_cb contains log write callback
+ * @param log_level contains log level of the message
+ * @param logmsg contains log message. Must remain valid until batch is flushed.
+ * @param logmsg_len contains length of log message
+ * @param timestamp_ms contains time at which message was logged, APPD_IOT_LOG_NO_TIMESTAMP for none
+ */
+static void log_emit(log_batch_t* batch, appd_iot_log_write_cb_t log_write_cb, appd_iot_log_level_t log_level,
+                     const char* logmsg, size_t logmsg_len, int64_t timestamp_ms)
+{
+  static const char eol = '\n';
+
+  if (log_write_cb != NULL)
+  {
+    log_write_cb(logmsg, logmsg_len);
+    return;
+  }
+
+  if (appd_iot_log_file_write(log_level, logmsg, logmsg_len, timestamp_ms))
+  {
+    return;
+  }
+
+  if (timestamp_ms != APPD_IOT_LOG_NO_TIMESTAMP)
+  {
+    int i = batch->count;
+    size_t timestamp_len = appd_iot_clock_format_time_ms(timestamp_ms, batch->timestamps[i],
+                                                         sizeof(batch->timestamps[i]) - 1);
+
+    batch->timestamps[i][timestamp_len++] = ' ';
+
+    log_batch_add_iov(batch, batch->timestamps[i], timestamp_len);
+  }
+
+  log_batch_add_iov(batch, logmsg, logmsg_len);
+  log_batch_add_iov(batch, &eol, sizeof(eol));
+
+  if (++batch->count == LOG_MAX_BATCH)
+  {
+    log_batch_flush(batch);
+  }
+}
+
+
+/**
+ * @brief Adds record in ring to batch written to binary log file, preceded by its format string
+ * if that has not been written to the file yet.
+ * @param batch to which record is added
+ * @param ring containing the record
+ * @param pos contains position of record in ring
+ * @param header contains header of the record
+ */
+static void log_emit_record(log_batch_t* batch, const log_ring_t* ring, uint64_t pos,
+                            const log_record_header_t* header)
+{
+  const char* format = appd_iot_log_binary_get_format(header->format_id);
+
+  if (batch->count == LOG_MAX_BATCH || batch->iovcnt + 5 > LOG_MAX_IOV)
+  {
+    log_batch_flush(batch);
+  }
+
+  if (header->type == LOG_RECORD_BINARY && format != NULL && !log_binary_format_written[header->format_id])
+  {
+    log_record_header_t* format_header = &batch->format_headers[batch->count];
+    size_t format_len = strlen(format);
+    size_t record_len = (sizeof(*format_header) + format_len + LOG_RECORD_ALIGN - 1) &
+                        ~((size_t)LOG_RECORD_ALIGN - 1);
+
+    memset(format_header, 0, sizeof(*format_header));
+    format_header->payload_len = (uint32_t)format_len;
+    format_header->record_len = (uint32_t)record_len;
+    format_header->format_id = header->format_id;
+    format_header->type = LOG_RECORD_FORMAT;
+
+    log_batch_add_iov(batch, format_header, sizeof(*format_header));
+    log_batch_add_iov(batch, format, format_len);
+    log_batch_add_iov(batch, log_record_padding, record_len - sizeof(*format_header) - format_len);
+
+    log_binary_format_written[header->format_id] = true;
+  }
+
+  size_t offset = pos & (LOG_RING_SIZE - 1);
+  size_t first = (header->record_len < LOG_RING_SIZE - offset) ? header->record_len : LOG_RING_SIZE - offset;
+
+  log_batch_add_iov(batch, ring->data + offset, first);
+
+  if (first < header->record_len)
+  {
+    log_batch_add_iov(batch, ring->data, header->record_len - first);
+  }
+
+  batch->count++;
+}
+
+
+/**
+ * @brief Formats binary log record as text
+ * @param header contains header of the record
+ * @param payload contains raw arguments
+ * @param buf to which message is written, including log header
+ * @param buflen contains size of buf
+ * @return length of message
+ */
+static size_t log_decode_record(const log_record_header_t* header, const char* payload, char* buf, size_t buflen)
+{
+  const char* format = appd_iot_log_binary_get_format(header->format_id);
+
+  memcpy(buf, LOG_HEADER, LOG_HEADER_LEN);
+  buf[0] = appd_iot_log_level_to_char((appd_iot_log_level_t)header->log_level);
+
+  int nchar = (format != NULL) ?
+              log_binary_format(format, payload, header->payload_len, buf + LOG_HEADER_LEN, buflen - LOG_HEADER_LEN) : -1;
+
+  if (nchar < 0)
+  {
+    return LOG_HEADER_LEN + snprintf(buf + LOG_HEADER_LEN, buflen - LOG_HEADER_LEN,
+                                     "<Malformed Binary Log Record, Format Id:%u>", (unsigned int)header->format_id);
+  }
+
+  return LOG_HEADER_LEN + nchar;
+}
+
+
+/**
+ * @brief Writes out all log records queued in ring. Must be called with consumer lock held. <br>
+ * Records are written as is to binary log file if one is open, else binary records are decoded
+ * and written as text.
+ * @param ring containing queued log records
+ * @param log_write_cb contains log write callback, NULL to write to stderr
+ */
+static void log_ring_drain(log_ring_t* ring, appd_iot_log_write_cb_t log_write_cb)
+{
+  log_batch_t* batch = &log_batch;
+  char logbuf[LOG_MSG_MAX_SIZE];
+
+  uint64_t tail = ring->tail;
+  uint64_t head = appd_iot_atomic_load(&ring->head);
+
+  while (tail < head)
+  {
+    log_record_header_t header;
+
+    log_ring_copy_out(ring, tail, &header, sizeof(header));
+
+    uint64_t payload_pos = tail + sizeof(header);
+    size_t offset = payload_pos & (LOG_RING_SIZE - 1);
+    bool contiguous = (offset + header.payload_len < LOG_RING_SIZE);
+    const char* payload = ring->data + offset;
+
+    if (log_binary_fd >= 0)
+    {
+      log_emit_record(batch, ring, tail, &header);
+    }
+    else
+    {
+      if (!contiguous)
+      {
+        /* payload wraps around the end of ring, write pending batch and copy payload out */
+        size_t payload_len = (header.payload_len < sizeof(logbuf)) ? header.payload_len : sizeof(logbuf) - 1;
+
+        log_batch_flush(batch);
+        log_ring_copy_out(ring, payload_pos, logbuf, payload_len);
+        logbuf[payload_len] = '\0';
+        header.payload_len = payload_len;
+        payload = logbuf;
+      }
+
+      if (header.type == LOG_RECORD_BINARY)
+      {
+        char* decoded = log_batch_get_decode_buf(batch);
+        size_t decoded_len = log_decode_record(&header, payload, decoded, LOG_MSG_MAX_SIZE);
+
+        batch->decoded_len += decoded_len + 1;
+        log_emit(batch, log_write_cb, (appd_iot_log_level_t)header.log_level, decoded, decoded_len,
+                 header.timestamp_ms);
+      }
+      else
+      {
+        /* text message is null terminated in ring, write it from there */
+        log_emit(batch, log_write_cb, (appd_iot_log_level_t)header.log_level, payload, header.payload_len,
+                 (header.type == LOG_RECORD_JSON) ? APPD_IOT_LOG_NO_TIMESTAMP : header.timestamp_ms);
+      }
+
+      if (!contiguous)
+      {
+        log_batch_flush(batch);
+      }
+    }
+
+    tail += header.record_len;
+
+    /* batch refers to records in ring, release them to producer only once written */
+    if (batch->iovcnt == 0)
+    {
+      appd_iot_atomic_store(&ring->tail, tail);
+    }
+  }
+
+  log_batch_flush(batch);
+  appd_iot_atomic_store(&ring->tail, tail);
+
+  uint32_t dropped = appd_iot_atomic_exchange(&ring->dropped, (uint32_t)0);
+
+  if (dropped > 0)
+  {
+    log_record_header_t header;
+    int64_t timestamp_ms = appd_iot_clock_get_time_ms();
+    int logmsg_len = snprintf(logbuf, sizeof(logbuf), log_dropped_format, dropped);
+    uint8_t type = LOG_RECORD_TEXT;
+
+    if (appd_iot_get_log_format() == APPD_IOT_LOG_FORMAT_JSON)
+    {
+      size_t json_len;
+      const char* json = appd_iot_log_format_json(APPD_IOT_LOG_WARN, APPD_IOT_LOG_SUBSYSTEM_CONFIG, timestamp_ms,
+                                                  logbuf + LOG_HEADER_LEN, NULL, &json_len);
+
+      if (json != NULL && json_len < sizeof(logbuf) - LOG_RECORD_ALIGN)
+      {
+        memcpy(logbuf, json, json_len);
+        logmsg_len = json_len;
+        type = LOG_RECORD_JSON;
+      }
+    }
+
+    if (log_binary_fd >= 0)
+    {
+      size_t record_len = (sizeof(header) + logmsg_len + 1 + LOG_RECORD_ALIGN - 1) & ~((size_t)LOG_RECORD_ALIGN - 1);
+
+      memset(&header, 0, sizeof(header));
+      header.payload_len = logmsg_len;
+      header.record_len = record_len;
+      header.timestamp_ms = timestamp_ms;
+      header.type = type;
+
+      memset(logbuf + logmsg_len, 0, record_len - sizeof(header) - logmsg_len);
+      log_batch_add_iov(batch, &header, sizeof(header));
+      log_batch_add_iov(batch, logbuf, record_len - sizeof(header));
+    }
+    else
+    {
+      log_emit(batch, log_write_cb, APPD_IOT_LOG_WARN, logbuf, logmsg_len,
+               (type == LOG_RECORD_JSON) ? APPD_IOT_LOG_NO_TIMESTAMP : timestamp_ms);
+    }
+
+    log_batch_flush(batch);
+  }
+}
+
+
+/**
+ * @brief Writes out log messages queued in all rings
+ */
+static void log_drain_all(void)
+{
+  appd_iot_log_write_cb_t log_write_cb = appd_iot_get_log_write_cb();
+
+  pthread_mutex_lock(&log_consumer_lock);
+
+  for (log_ring_t* ring = appd_iot_atomic_load(&global_log_rings); ring != NULL; ring = ring->next)
+  {
+    log_ring_drain(ring, log_write_cb);
+  }
+
+  pthread_mutex_unlock(&log_consumer_lock);
+}
+
+
+/**
+ * @brief Checks if any ring has queued log messages
+ * @return true if log messages are queued
+ */
+static bool log_records_pending(void)
+{
+  for (log_ring_t* ring = appd_iot_atomic_load(&global_log_rings); ring != NULL; ring = ring->next)
+  {
+    if (appd_iot_atomic_load(&ring->head) != appd_iot_atomic_load(&ring->tail))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+/**
+ * @brief Blocks background thread until a log message is queued. Thread stays blocked as long as
+ * log mode is APPD_IOT_LOG_MODE_SYNC, as messages are then not queued.
+ */
+static void log_thread_wait_for_records(void)
+{
+  pthread_mutex_lock(&log_wakeup_lock);
+
+  appd_iot_atomic_store(&log_consumer_state, (int)LOG_CONSUMER_IDLE);
+
+  //pairs with the fence in log_wakeup_consumer()
+  appd_iot_atomic_fence();
+
+  while (appd_iot_atomic_load(&log_consumer_state) == LOG_CONSUMER_IDLE)
+  {
+    if (log_records_pending())
+    {
+      int state = LOG_CONSUMER_IDLE;
+
+      appd_iot_atomic_compare_exchange(&log_consumer_state, &state, (int)LOG_CONSUMER_BATCHING);
+      break;
+    }
+
+    pthread_cond_wait(&log_wakeup_cond, &log_wakeup_lock);
+  }
+
+  pthread_mutex_unlock(&log_wakeup_lock);
+}
+
+
+/**
+ * @brief Lets log messages gather for LOG_FLUSH_INTERVAL_MS so that they are written in batch,
+ * unless a ring crosses LOG_RING_WAKEUP_THRESHOLD before.
+ */
+static void log_thread_wait_for_batch(void)
+{
+  struct timespec deadline;
+
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+  deadline.tv_nsec += LOG_FLUSH_INTERVAL_MS * 1000000L;
+
+  if (deadline.tv_nsec >= 1000000000L)
+  {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000L;
+  }
+
+  pthread_mutex_lock(&log_wakeup_lock);
+
+  while (appd_iot_atomic_load(&log_consumer_state) == LOG_CONSUMER_BATCHING)
+  {
+    if (pthread_cond_timedwait(&log_wakeup_cond, &log_wakeup_lock, &deadline) == ETIMEDOUT)
+    {
+      break;
+    }
+  }
+
+  appd_iot_atomic_store(&log_consumer_state, (int)LOG_CONSUMER_DRAINING);
+
+  pthread_mutex_unlock(&log_wakeup_lock);
+}
+
+
+/**
+ * @brief Background thread writing queued log messages. Thread blocks while no messages are queued.
+ */
+static void* log_thread_main(void* arg)
+{
+  for (;;)
+  {
+    log_thread_wait_for_records();
+    log_thread_wait_for_batch();
+    log_drain_all();
+  }
+
+  return NULL;
+}
+
+
+/**
+ * @brief Initializes condition background thread blocks on. Timed waits use monotonic clock,
+ * so that batching is not affected by changes to wall clock time.
+ */
+static void log_wakeup_cond_init(void)
+{
+  pthread_condattr_t attr;
+
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&log_wakeup_cond, &attr);
+  pthread_condattr_destroy(&attr);
+}
+
+
+/**
+ * @brief Resets background thread state in child process after fork, as threads are not inherited
+ */
+static void log_thread_atfork_child(void)
+{
+  pthread_mutex_init(&log_consumer_lock, NULL);
+  pthread_mutex_init(&log_thread_lock, NULL);
+  pthread_mutex_init(&log_wakeup_lock, NULL);
+  log_wakeup_cond_init();
+  log_consumer_state = LOG_CONSUMER_DRAINING;
+  log_thread_started = false;
+}
+
+
+/**
+ * @brief Starts background thread writing log messages queued in async log mode.
+ * @return appd_iot_error_code_t indicating function execution status
+ */
+appd_iot_error_code_t appd_iot_log_async_start(void)
+{
+  appd_iot_error_code_t retcode = APPD_IOT_SUCCESS;
+
+  pthread_mutex_lock(&log_thread_lock);
+
+  if (!log_thread_started)
+  {
+    pthread_t log_thread;
+    pthread_attr_t attr;
+    static bool wakeup_cond_initialized = false;
+
+    if (!wakeup_cond_initialized)
+    {
+      log_wakeup_cond_init();
+      wakeup_cond_initialized = true;
+    }
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    if (pthread_create(&log_thread, &attr, &log_thread_main, NULL) == 0)
+    {
+      static bool atexit_registered = false;
+
+      if (!atexit_registered)
+      {
+        pthread_atfork(NULL, NULL, &log_thread_atfork_child);
+        atexit(&appd_iot_flush_log);
+        atexit_registered = true;
+      }
+
+      log_thread_started = true;
+    }
+    else
+    {
+      retcode = APPD_IOT_ERR_INTERNAL;
+    }
+
+    pthread_attr_destroy(&attr);
+  }
+
+  pthread_mutex_unlock(&log_thread_lock);
+
+  return retcode;
+}
+
+
+/**
+ * @brief Sets file to which records are written as is in binary log mode, closing previous file.
+ * @param path contains path of binary log file, appended to if it exists. NULL to decode
+ * binary records and write them as text.
+ * @return appd_iot_error_code_t indicating function execution status
+ */
+appd_iot_error_code_t appd_iot_log_async_set_binary_file(const char* path)
+{
+  appd_iot_error_code_t retcode = APPD_IOT_SUCCESS;
+
+  pthread_mutex_lock(&log_consumer_lock);
+
+  if (log_binary_fd >= 0)
+  {
+    close(log_binary_fd);
+    log_binary_fd = -1;
+  }
+
+  if (path != NULL)
+  {
+    log_binary_fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+    if (log_binary_fd >= 0)
+    {
+      log_binary_file_header_t file_header;
+
+      memset(&file_header, 0, sizeof(file_header));
+      memcpy(file_header.magic, LOG_BINARY_FILE_MAGIC, sizeof(LOG_BINARY_FILE_MAGIC));
+      file_header.version = LOG_BINARY_FILE_VERSION;
+      file_header.byte_order = LOG_BINARY_FILE_BYTE_ORDER;
+
+      //format strings are written again to each file before first use
+      memset(log_binary_format_written, 0, sizeof(log_binary_format_written));
+
+      if (write(log_binary_fd, &file_header, sizeof(file_header)) != (ssize_t)sizeof(file_header))
+      {
+        close(log_binary_fd);
+        log_binary_fd = -1;
+      }
+    }
+
+    if (log_binary_fd < 0)
+    {
+      retcode = APPD_IOT_ERR_INVALID_INPUT;
+    }
+  }
+
+  pthread_mutex_unlock(&log_consumer_lock);
+
+  return retcode;
+}
+
+
+/**
+ * @brief This method writes out log messages queued in APPD_IOT_LOG_MODE_ASYNC and
+ * APPD_IOT_LOG_MODE_BINARY, and log messages buffered for log file, on the calling thread.
+ */
+void appd_iot_flush_log(void)
+{
+  log_drain_all();
+  appd_iot_log_file_flush();
+}
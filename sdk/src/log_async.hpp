@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _LOG_ASYNC_HPP
+#define _LOG_ASYNC_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <appd_iot_interface.h>
+
+/**
+ * @brief Starts background thread writing log messages queued in async log mode. <br>
+ * Calling it again after the thread is started has no effect.
+ * @return appd_iot_error_code_t indicating function execution status
+ */
+appd_iot_error_code_t appd_iot_log_async_start(void);
+
+/**
+ * @brief Queues log message in the ring of the calling thread. Never blocks or makes a system call,
+ * except for allocating the ring on the first message logged by a thread. <br>
+ * Message is dropped if the ring is full.
+ * @param log_level contains log level of the message
+ * @param logmsg contains log message including log header, or JSON log message
+ * @param logmsg_len contains length of log message
+ * @param structured is true for JSON log message, which is written without timestamp prefix
+ */
+void appd_iot_log_async_write(appd_iot_log_level_t log_level, const char* logmsg, size_t logmsg_len,
+                              bool structured);
+
+/**
+ * @brief Queues raw arguments of a log call in the ring of the calling thread, to be formatted
+ * by background thread or by offline log decoder. <br>
+ * Record is dropped if the ring is full.
+ * @param log_level contains log level of the log call
+ * @param format_id contains id of format string
+ * @param payload contains raw arguments, as encoded by log_binary_encode()
+ * @param payload_len contains length of payload
+ */
+void appd_iot_log_async_write_binary(appd_iot_log_level_t log_level, uint16_t format_id,
+                                     const char* payload, size_t payload_len);
+
+/**
+ * @brief Sets file to which records are written as is in binary log mode, closing previous file.
+ * @param path contains path of binary log file, appended to if it exists. NULL to decode
+ * binary records and write them as text.
+ * @return appd_iot_error_code_t indicating function execution status
+ */
+appd_iot_error_code_t appd_iot_log_async_set_binary_file(const char* path);
+
+#endif /* _LOG_ASYNC_HPP */
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stddef.h>
+#include "log_binary.hpp"
+#include "atomic.hpp"
+
+typedef enum
+{
+  LOG_FORMAT_REGISTERING = 0,
+  LOG_FORMAT_READY,
+  LOG_FORMAT_UNSUPPORTED
+} log_format_state_t;
+
+/**
+ * @brief Format string registered for binary logging. Id of the format is its index in table + 1.
+ */
+typedef struct
+{
+  const char* format;
+  int state;               /* log_format_state_t */
+  log_binary_args_t args;
+} log_format_entry_t;
+
+/* open addressing hash table keyed by format string address, entries are never removed */
+static log_format_entry_t global_log_formats[LOG_BINARY_MAX_FORMATS];
+
+
+/**
+ * @brief Get id of format string, registering it on first use. <br>
+ * Format strings are identified by address, so they must be string literals.
+ * @param format contains printf format string
+ * @param args is set to argument types of format string
+ * @return id of format string, 0 if format string cannot be logged in binary
+ */
+uint16_t appd_iot_log_binary_get_format_id(const char* format, const log_binary_args_t** args)
+{
+  size_t index = (((uintptr_t)format >> 3) * 2654435761u) & (LOG_BINARY_MAX_FORMATS - 1);
+
+  for (int probes = 0; probes < LOG_BINARY_MAX_FORMATS; probes++)
+  {
+    log_format_entry_t* entry = &global_log_formats[index];
+    const char* entry_format = appd_iot_atomic_load(&entry->format);
+
+    if (entry_format == NULL)
+    {
+      if (!appd_iot_atomic_compare_exchange(&entry->format, &entry_format, format))
+      {
+        //lost the race for this slot, entry_format now holds the winner
+        if (entry_format != format)
+        {
+          index = (index + 1) & (LOG_BINARY_MAX_FORMATS - 1);
+          continue;
+        }
+      }
+      else
+      {
+        bool supported = log_binary_parse_format(format, &entry->args);
+
+        appd_iot_atomic_store(&entry->state, supported ? (int)LOG_FORMAT_READY : (int)LOG_FORMAT_UNSUPPORTED);
+      }
+
+      entry_format = format;
+    }
+
+    if (entry_format == format)
+    {
+      //format being registered by another thread is logged as text meanwhile
+      if (appd_iot_atomic_load(&entry->state) != LOG_FORMAT_READY)
+      {
+        return 0;
+      }
+
+      *args = &entry->args;
+
+      return (uint16_t)(index + 1);
+    }
+
+    index = (index + 1) & (LOG_BINARY_MAX_FORMATS - 1);
+  }
+
+  return 0;
+}
+
+
+/**
+ * @brief Get format string registered with given id
+ * @param format_id contains id returned by appd_iot_log_binary_get_format_id()
+ * @return format string, NULL if id is not registered
+ */
+const char* appd_iot_log_binary_get_format(uint16_t format_id)
+{
+  if (format_id == 0 || format_id > LOG_BINARY_MAX_FORMATS)
+  {
+    return NULL;
+  }
+
+  log_format_entry_t* entry = &global_log_formats[format_id - 1];
+
+  if (appd_iot_atomic_load(&entry->state) != LOG_FORMAT_READY)
+  {
+    return NULL;
+  }
+
+  return entry->format;
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _LOG_BINARY_HPP
+#define _LOG_BINARY_HPP
+
+#include <stdint.h>
+#include "log_binary_format.hpp"
+
+//Maximum number of distinct format strings logged in binary. Must be a power of 2
+#define LOG_BINARY_MAX_FORMATS 1024
+
+/**
+ * @brief Get id of format string, registering it on first use. <br>
+ * Format strings are identified by address, so they must be string literals.
+ * @param format contains printf format string
+ * @param args is set to argument types of format string
+ * @return id of format string, 0 if format string cannot be logged in binary
+ */
+uint16_t appd_iot_log_binary_get_format_id(const char* format, const log_binary_args_t** args);
+
+/**
+ * @brief Get format string registered with given id
+ * @param format_id contains id returned by appd_iot_log_binary_get_format_id()
+ * @return format string, NULL if id is not registered
+ */
+const char* appd_iot_log_binary_get_format(uint16_t format_id);
+
+#endif /* _LOG_BINARY_HPP */
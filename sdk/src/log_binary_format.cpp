@@ -0,0 +1,650 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include "log_binary_format.hpp"
+
+//Maximum length of a single conversion specification, such as "%-*.*lld"
+#define LOG_CONVERSION_MAX_LEN 32
+
+//Maximum length of a string argument formatted by decoder
+#define LOG_STRING_MAX_LEN 4096
+
+typedef enum
+{
+  LOG_LENGTH_NONE = 0,
+  LOG_LENGTH_HH,
+  LOG_LENGTH_H,
+  LOG_LENGTH_L,
+  LOG_LENGTH_LL,
+  LOG_LENGTH_J,
+  LOG_LENGTH_Z,
+  LOG_LENGTH_T,
+  LOG_LENGTH_LONG_DOUBLE
+} log_length_t;
+
+/**
+ * @brief Single conversion specification in a format string
+ */
+typedef struct
+{
+  size_t len;            /* length of specification, starting with '%' */
+  int nstars;            /* number of '*' width and precision args */
+  int precision;         /* precision given in format, -1 if none, -2 if given by arg */
+  log_length_t length;   /* length modifier */
+  char conversion;       /* conversion char */
+} log_conversion_t;
+
+
+/**
+ * @brief Parses conversion specification
+ * @param spec points to '%' starting the specification
+ * @param conv is populated with parsed specification
+ * @return true on success, false if conversion is not supported in binary log
+ */
+static bool log_parse_conversion(const char* spec, log_conversion_t* conv)
+{
+  const char* p = spec + 1;
+
+  conv->nstars = 0;
+  conv->precision = -1;
+  conv->length = LOG_LENGTH_NONE;
+
+  while (*p != '\0' && strchr("-+ #0'", *p) != NULL)
+  {
+    p++;
+  }
+
+  if (*p == '*')
+  {
+    conv->nstars++;
+    p++;
+  }
+  else
+  {
+    while (*p >= '0' && *p <= '9')
+    {
+      p++;
+    }
+  }
+
+  //positional arguments are not supported
+  if (*p == '$')
+  {
+    return false;
+  }
+
+  if (*p == '.')
+  {
+    p++;
+
+    if (*p == '*')
+    {
+      conv->nstars++;
+      conv->precision = -2;
+      p++;
+    }
+    else
+    {
+      conv->precision = 0;
+
+      while (*p >= '0' && *p <= '9')
+      {
+        conv->precision = conv->precision * 10 + (*p - '0');
+        p++;
+      }
+    }
+  }
+
+  switch (*p)
+  {
+    case 'h':
+      p++;
+      conv->length = (*p == 'h') ? LOG_LENGTH_HH : LOG_LENGTH_H;
+      p += (*p == 'h') ? 1 : 0;
+      break;
+
+    case 'l':
+      p++;
+      conv->length = (*p == 'l') ? LOG_LENGTH_LL : LOG_LENGTH_L;
+      p += (*p == 'l') ? 1 : 0;
+      break;
+
+    case 'q':
+      conv->length = LOG_LENGTH_LL;
+      p++;
+      break;
+
+    case 'j':
+      conv->length = LOG_LENGTH_J;
+      p++;
+      break;
+
+    case 'z':
+    case 'Z':
+      conv->length = LOG_LENGTH_Z;
+      p++;
+      break;
+
+    case 't':
+      conv->length = LOG_LENGTH_T;
+      p++;
+      break;
+
+    case 'L':
+      conv->length = LOG_LENGTH_LONG_DOUBLE;
+      p++;
+      break;
+  }
+
+  conv->conversion = *p;
+  conv->len = p + 1 - spec;
+
+  if (conv->len >= LOG_CONVERSION_MAX_LEN)
+  {
+    return false;
+  }
+
+  switch (conv->conversion)
+  {
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+      return (conv->length != LOG_LENGTH_LONG_DOUBLE);
+
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      return (conv->length == LOG_LENGTH_NONE || conv->length == LOG_LENGTH_L);
+
+    case 'c':
+    case 's':
+    case 'p':
+      return (conv->length == LOG_LENGTH_NONE);
+
+    default:
+      return false;
+  }
+}
+
+
+/**
+ * @brief Get type in which value of an integer conversion is passed
+ */
+static log_arg_type_t log_integer_arg_type(log_length_t length)
+{
+  switch (length)
+  {
+    case LOG_LENGTH_L:
+      return LOG_ARG_LONG;
+
+    case LOG_LENGTH_LL:
+      return LOG_ARG_LONG_LONG;
+
+    case LOG_LENGTH_J:
+      return LOG_ARG_INTMAX;
+
+    case LOG_LENGTH_Z:
+      return LOG_ARG_SIZE;
+
+    case LOG_LENGTH_T:
+      return LOG_ARG_PTRDIFF;
+
+    default:
+      return LOG_ARG_INT;
+  }
+}
+
+
+/**
+ * @brief Get type in which value of a conversion is passed
+ */
+static log_arg_type_t log_conversion_arg_type(const log_conversion_t* conv)
+{
+  switch (conv->conversion)
+  {
+    case 's':
+      return LOG_ARG_STRING;
+
+    case 'p':
+      return LOG_ARG_POINTER;
+
+    case 'c':
+      return LOG_ARG_INT;
+
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+      return log_integer_arg_type(conv->length);
+
+    default:
+      return LOG_ARG_DOUBLE;
+  }
+}
+
+
+/**
+ * @brief Parses format string and gets types of the arguments it consumes
+ * @param format contains printf format string
+ * @param args is populated with argument types
+ * @return true if format string can be logged in binary, false if it uses conversions
+ * that are not supported (%n, %m, long double, wide chars, positional args) or too many arguments
+ */
+bool log_binary_parse_format(const char* format, log_binary_args_t* args)
+{
+  args->nargs = 0;
+
+  for (const char* p = strchr(format, '%'); p != NULL; p = strchr(p, '%'))
+  {
+    if (p[1] == '%')
+    {
+      p += 2;
+      continue;
+    }
+
+    log_conversion_t conv;
+
+    if (!log_parse_conversion(p, &conv) || args->nargs + conv.nstars + 1 > LOG_BINARY_MAX_ARGS)
+    {
+      return false;
+    }
+
+    for (int i = 0; i < conv.nstars; i++)
+    {
+      args->arg_types[args->nargs] = LOG_ARG_INT;
+      args->precision[args->nargs] = -1;
+      args->nargs++;
+    }
+
+    args->arg_types[args->nargs] = log_conversion_arg_type(&conv);
+    args->precision[args->nargs] = conv.precision;
+    args->nargs++;
+
+    p += conv.len;
+  }
+
+  return true;
+}
+
+
+/**
+ * @brief Appends integer value to payload
+ * @return false if there is no space left in payload
+ */
+static bool log_put_int64(char* buf, size_t buflen, size_t* pos, int64_t value)
+{
+  if (*pos + sizeof(value) > buflen)
+  {
+    return false;
+  }
+
+  memcpy(buf + *pos, &value, sizeof(value));
+  *pos += sizeof(value);
+
+  return true;
+}
+
+
+/**
+ * @brief Copies raw arguments of a log call into binary log record payload
+ * @param args contains argument types as parsed from format string
+ * @param ap contains argument list of the log call
+ * @param buf to which payload is written
+ * @param buflen contains size of buf. Strings are truncated to fit.
+ * @return length of payload, -1 if arguments do not fit in buf
+ */
+int log_binary_encode(const log_binary_args_t* args, va_list ap, char* buf, size_t buflen)
+{
+  size_t pos = 0;
+  int64_t prev_value = 0;
+
+  for (int i = 0; i < args->nargs; i++)
+  {
+    int64_t value;
+    double dvalue;
+
+    switch (args->arg_types[i])
+    {
+      case LOG_ARG_INT:
+        value = va_arg(ap, int);
+        break;
+
+      case LOG_ARG_LONG:
+        value = va_arg(ap, long);
+        break;
+
+      case LOG_ARG_LONG_LONG:
+        value = va_arg(ap, long long);
+        break;
+
+      case LOG_ARG_INTMAX:
+        value = va_arg(ap, intmax_t);
+        break;
+
+      case LOG_ARG_SIZE:
+        value = (int64_t)va_arg(ap, size_t);
+        break;
+
+      case LOG_ARG_PTRDIFF:
+        value = va_arg(ap, ptrdiff_t);
+        break;
+
+      case LOG_ARG_POINTER:
+        value = (int64_t)(uintptr_t)va_arg(ap, void*);
+        break;
+
+      case LOG_ARG_DOUBLE:
+        dvalue = va_arg(ap, double);
+        memcpy(&value, &dvalue, sizeof(value));
+        break;
+
+      case LOG_ARG_STRING:
+      {
+        const char* str = va_arg(ap, const char*);
+        int precision = (args->precision[i] == -2) ? (int)prev_value : args->precision[i];
+        uint32_t len;
+
+        if (str == NULL)
+        {
+          str = "(null)";
+        }
+
+        //string need not be null terminated within precision
+        len = (precision >= 0) ? strnlen(str, precision) : strlen(str);
+
+        if (pos + sizeof(len) > buflen)
+        {
+          return -1;
+        }
+
+        if (len > buflen - pos - sizeof(len))
+        {
+          len = buflen - pos - sizeof(len);
+        }
+
+        memcpy(buf + pos, &len, sizeof(len));
+        memcpy(buf + pos + sizeof(len), str, len);
+        pos += sizeof(len) + len;
+        continue;
+      }
+
+      default:
+        return -1;
+    }
+
+    if (!log_put_int64(buf, buflen, &pos, value))
+    {
+      return -1;
+    }
+
+    prev_value = value;
+  }
+
+  return (int)pos;
+}
+
+
+/**
+ * @brief Formats a single value using the conversion specification and width/precision args
+ * @return number of chars that would have been written, as snprintf()
+ */
+template <typename T>
+static int log_format_value(char* buf, size_t buflen, const char* spec, int nstars, const int* stars, T value)
+{
+  switch (nstars)
+  {
+    case 0:
+      return snprintf(buf, buflen, spec, value);
+
+    case 1:
+      return snprintf(buf, buflen, spec, stars[0], value);
+
+    default:
+      return snprintf(buf, buflen, spec, stars[0], stars[1], value);
+  }
+}
+
+
+/**
+ * @brief Formats integer value, converting it to the type given by conversion and length modifier
+ */
+static int log_format_integer(char* buf, size_t buflen, const char* spec, const log_conversion_t* conv,
+                              const int* stars, int64_t value)
+{
+  bool is_signed = (conv->conversion == 'd' || conv->conversion == 'i');
+  int nstars = conv->nstars;
+
+  switch (conv->length)
+  {
+    case LOG_LENGTH_HH:
+      return is_signed ? log_format_value(buf, buflen, spec, nstars, stars, (int)(signed char)value) :
+             log_format_value(buf, buflen, spec, nstars, stars, (unsigned int)(unsigned char)value);
+
+    case LOG_LENGTH_H:
+      return is_signed ? log_format_value(buf, buflen, spec, nstars, stars, (int)(short)value) :
+             log_format_value(buf, buflen, spec, nstars, stars, (unsigned int)(unsigned short)value);
+
+    case LOG_LENGTH_L:
+      return is_signed ? log_format_value(buf, buflen, spec, nstars, stars, (long)value) :
+             log_format_value(buf, buflen, spec, nstars, stars, (unsigned long)value);
+
+    case LOG_LENGTH_LL:
+      return is_signed ? log_format_value(buf, buflen, spec, nstars, stars, (long long)value) :
+             log_format_value(buf, buflen, spec, nstars, stars, (unsigned long long)value);
+
+    case LOG_LENGTH_J:
+      return is_signed ? log_format_value(buf, buflen, spec, nstars, stars, (intmax_t)value) :
+             log_format_value(buf, buflen, spec, nstars, stars, (uintmax_t)value);
+
+    case LOG_LENGTH_Z:
+      return is_signed ? log_format_value(buf, buflen, spec, nstars, stars, (ssize_t)value) :
+             log_format_value(buf, buflen, spec, nstars, stars, (size_t)value);
+
+    case LOG_LENGTH_T:
+      return is_signed ? log_format_value(buf, buflen, spec, nstars, stars, (ptrdiff_t)value) :
+             log_format_value(buf, buflen, spec, nstars, stars, (size_t)value);
+
+    default:
+      return is_signed ? log_format_value(buf, buflen, spec, nstars, stars, (int)value) :
+             log_format_value(buf, buflen, spec, nstars, stars, (unsigned int)value);
+  }
+}
+
+
+/**
+ * @brief Reads integer value from payload
+ * @return false if payload is too short
+ */
+static bool log_get_int64(const char* payload, size_t payload_len, size_t* pos, int64_t* value)
+{
+  if (*pos + sizeof(*value) > payload_len)
+  {
+    return false;
+  }
+
+  memcpy(value, payload + *pos, sizeof(*value));
+  *pos += sizeof(*value);
+
+  return true;
+}
+
+
+/**
+ * @brief Formats binary log record payload as text, as vsnprintf() would have
+ * @param format contains format string of the record
+ * @param payload contains raw arguments
+ * @param payload_len contains length of payload
+ * @param buf to which formatted message is written, always null terminated
+ * @param buflen contains size of buf
+ * @return length of formatted message, excluding null char, truncated to buflen - 1. -1 on malformed payload
+ */
+int log_binary_format(const char* format, const char* payload, size_t payload_len, char* buf, size_t buflen)
+{
+  size_t len = 0;
+  size_t pos = 0;
+  const char* p = format;
+
+  if (buflen == 0)
+  {
+    return -1;
+  }
+
+  buf[0] = '\0';
+
+  while (*p != '\0')
+  {
+    const char* spec = strchr(p, '%');
+    size_t literal_len = (spec != NULL) ? (size_t)(spec - p) : strlen(p);
+
+    //copy literal text up to next conversion
+    if (len + literal_len >= buflen)
+    {
+      literal_len = buflen - len - 1;
+    }
+
+    memcpy(buf + len, p, literal_len);
+    len += literal_len;
+    buf[len] = '\0';
+
+    if (spec == NULL)
+    {
+      break;
+    }
+
+    if (spec[1] == '%')
+    {
+      if (len + 1 < buflen)
+      {
+        buf[len++] = '%';
+        buf[len] = '\0';
+      }
+
+      p = spec + 2;
+      continue;
+    }
+
+    log_conversion_t conv;
+    char specbuf[LOG_CONVERSION_MAX_LEN];
+    int stars[2];
+    int64_t value;
+    int nchar;
+
+    if (!log_parse_conversion(spec, &conv))
+    {
+      return -1;
+    }
+
+    memcpy(specbuf, spec, conv.len);
+    specbuf[conv.len] = '\0';
+
+    for (int i = 0; i < conv.nstars; i++)
+    {
+      if (!log_get_int64(payload, payload_len, &pos, &value))
+      {
+        return -1;
+      }
+
+      stars[i] = (int)value;
+    }
+
+    if (conv.conversion == 's')
+    {
+      uint32_t str_len;
+      char str[LOG_STRING_MAX_LEN];
+
+      if (pos + sizeof(str_len) > payload_len)
+      {
+        return -1;
+      }
+
+      memcpy(&str_len, payload + pos, sizeof(str_len));
+      pos += sizeof(str_len);
+
+      if (str_len > payload_len - pos)
+      {
+        return -1;
+      }
+
+      size_t copy_len = (str_len < sizeof(str)) ? str_len : sizeof(str) - 1;
+
+      memcpy(str, payload + pos, copy_len);
+      str[copy_len] = '\0';
+      pos += str_len;
+
+      nchar = log_format_value(buf + len, buflen - len, specbuf, conv.nstars, stars, (const char*)str);
+    }
+    else
+    {
+      if (!log_get_int64(payload, payload_len, &pos, &value))
+      {
+        return -1;
+      }
+
+      switch (conv.conversion)
+      {
+        case 'c':
+          nchar = log_format_value(buf + len, buflen - len, specbuf, conv.nstars, stars, (int)value);
+          break;
+
+        case 'p':
+          nchar = log_format_value(buf + len, buflen - len, specbuf, conv.nstars, stars,
+                                   (void*)(uintptr_t)value);
+          break;
+
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+          nchar = log_format_integer(buf + len, buflen - len, specbuf, &conv, stars, value);
+          break;
+
+        default:
+        {
+          double dvalue;
+
+          memcpy(&dvalue, &value, sizeof(dvalue));
+          nchar = log_format_value(buf + len, buflen - len, specbuf, conv.nstars, stars, dvalue);
+          break;
+        }
+      }
+    }
+
+    if (nchar < 0)
+    {
+      return -1;
+    }
+
+    len = (len + nchar < buflen) ? len + nchar : buflen - 1;
+    p = spec + conv.len;
+  }
+
+  return (int)len;
+}
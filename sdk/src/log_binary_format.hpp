@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _LOG_BINARY_FORMAT_HPP
+#define _LOG_BINARY_FORMAT_HPP
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary log records, shared by the SDK and the offline log decoder. <br>
+ * This file has no dependency on the rest of the SDK so that the decoder can be built from it alone.
+ *
+ * A binary log file starts with log_binary_file_header_t, followed by records. Each record starts
+ * with log_record_header_t and is padded to a multiple of LOG_RECORD_ALIGN bytes:
+ *   LOG_RECORD_TEXT   : payload is a formatted log message, including log header
+ *   LOG_RECORD_BINARY : payload is raw arguments of the format string with id format_id
+ *   LOG_RECORD_FORMAT : payload is the format string for format_id, written before first use
+ *   LOG_RECORD_JSON   : payload is a log message formatted as JSON object, which includes timestamp
+ *
+ * Arguments are stored in the order they are consumed by the format string. Integers, pointers
+ * and doubles take 8 bytes. Strings take a 4 byte length followed by the characters, without null.
+ * All values are in host byte order.
+ */
+
+//Records are aligned to this size
+#define LOG_RECORD_ALIGN 8
+
+//Maximum number of arguments, including '*' width and precision, in a binary log format string
+#define LOG_BINARY_MAX_ARGS 16
+
+#define LOG_BINARY_FILE_MAGIC "APPDLOG"
+#define LOG_BINARY_FILE_VERSION 1
+#define LOG_BINARY_FILE_BYTE_ORDER 0x01020304
+
+typedef enum
+{
+  LOG_RECORD_TEXT = 0,
+  LOG_RECORD_BINARY,
+  LOG_RECORD_FORMAT,
+  LOG_RECORD_JSON
+} log_record_type_t;
+
+/**
+ * @brief Header of a log record. Payload follows header.
+ */
+typedef struct
+{
+  uint32_t payload_len;  /* length of payload */
+  uint32_t record_len;   /* length of record including header and padding */
+  int64_t timestamp_ms;  /* time at which message was logged */
+  uint16_t format_id;    /* id of format string for binary and format records */
+  uint8_t type;          /* log_record_type_t */
+  uint8_t log_level;     /* appd_iot_log_level_t of binary records */
+  uint32_t reserved;
+} log_record_header_t;
+
+/**
+ * @brief Header of a binary log file
+ */
+typedef struct
+{
+  char magic[8];         /* LOG_BINARY_FILE_MAGIC */
+  uint32_t version;      /* LOG_BINARY_FILE_VERSION */
+  uint32_t byte_order;   /* LOG_BINARY_FILE_BYTE_ORDER as written by host */
+} log_binary_file_header_t;
+
+/**
+ * @brief Type in which an argument is read from the argument list of a log call
+ */
+typedef enum
+{
+  LOG_ARG_INT = 0,
+  LOG_ARG_LONG,
+  LOG_ARG_LONG_LONG,
+  LOG_ARG_INTMAX,
+  LOG_ARG_SIZE,
+  LOG_ARG_PTRDIFF,
+  LOG_ARG_DOUBLE,
+  LOG_ARG_STRING,
+  LOG_ARG_POINTER
+} log_arg_type_t;
+
+/**
+ * @brief Arguments consumed by a format string
+ */
+typedef struct
+{
+  int nargs;
+  uint8_t arg_types[LOG_BINARY_MAX_ARGS];  /* log_arg_type_t */
+  int16_t precision[LOG_BINARY_MAX_ARGS];  /* precision of string args. -1 if none, -2 if given by previous arg */
+} log_binary_args_t;
+
+/**
+ * @brief Parses format string and gets types of the arguments it consumes
+ * @param format contains printf format string
+ * @param args is populated with argument types
+ * @return true if format string can be logged in binary, false if it uses conversions
+ * that are not supported (%n, %m, long double, wide chars, positional args) or too many arguments
+ */
+bool log_binary_parse_format(const char* format, log_binary_args_t* args);
+
+/**
+ * @brief Copies raw arguments of a log call into binary log record payload
+ * @param args contains argument types as parsed from format string
+ * @param ap contains argument list of the log call
+ * @param buf to which payload is written
+ * @param buflen contains size of buf. Strings are truncated to fit.
+ * @return length of payload, -1 if arguments do not fit in buf
+ */
+int log_binary_encode(const log_binary_args_t* args, va_list ap, char* buf, size_t buflen);
+
+/**
+ * @brief Formats binary log record payload as text, as vsnprintf() would have
+ * @param format contains format string of the record
+ * @param payload contains raw arguments
+ * @param payload_len contains length of payload
+ * @param buf to which formatted message is written, always null terminated
+ * @param buflen contains size of buf
+ * @return length of formatted message, excluding null char, truncated to buflen - 1. -1 on malformed payload
+ */
+int log_binary_format(const char* format, const char* payload, size_t payload_len, char* buf, size_t buflen);
+
+#endif /* _LOG_BINARY_FORMAT_HPP */
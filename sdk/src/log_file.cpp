@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "log.hpp"
+#include "log_file.hpp"
+#include "atomic.hpp"
+#include "clock.hpp"
+
+//Size of each of the two log file buffers
+#define LOG_FILE_BUF_SIZE (16 * 1024)
+
+//Buffered messages are written out at least this often
+#define LOG_FILE_FLUSH_INTERVAL_MS 1000
+
+/**
+ * @brief Buffer of log lines waiting to be written to log file
+ */
+typedef struct
+{
+  char data[LOG_FILE_BUF_SIZE];
+  size_t len;
+} log_file_buf_t;
+
+/*
+ * Log lines are appended to the active buffer under log_file_buf_lock. Background thread swaps
+ * buffers under log_file_buf_lock and writes out the full one under log_file_io_lock only, so
+ * that logging threads never wait on write(), or on rename() during rotation. Lock order is
+ * log_file_io_lock, then log_file_buf_lock.
+ */
+static log_file_buf_t log_file_bufs[2];
+static log_file_buf_t* log_file_active_buf = &log_file_bufs[0];
+static bool log_file_flush_pending = false;
+static pthread_mutex_t log_file_buf_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_file_cond = PTHREAD_COND_INITIALIZER;
+
+/* set under both locks, read without lock to skip log file when none is open */
+static bool log_file_enabled = false;
+
+/* state below is protected by log_file_io_lock */
+static pthread_mutex_t log_file_io_lock = PTHREAD_MUTEX_INITIALIZER;
+static int log_file_fd = -1;
+static char log_file_path[PATH_MAX];
+static size_t log_file_size = 0;
+static size_t log_file_max_size = 0;
+static int log_file_max_count = 0;
+
+static pthread_mutex_t log_file_thread_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool log_file_thread_started = false;
+
+
+/**
+ * @brief Rotates log file: file.N-1 to file.N, ..., file to file.1, and opens a new file. <br>
+ * Oldest file is replaced by rename. Must be called with log_file_io_lock held.
+ */
+static void log_file_rotate(void)
+{
+  char from[PATH_MAX + 16];
+  char to[PATH_MAX + 16];
+
+  close(log_file_fd);
+
+  for (int i = log_file_max_count - 1; i >= 1; i--)
+  {
+    snprintf(from, sizeof(from), "%s.%d", log_file_path, i);
+    snprintf(to, sizeof(to), "%s.%d", log_file_path, i + 1);
+    rename(from, to);
+  }
+
+  snprintf(to, sizeof(to), "%s.1", log_file_path);
+  rename(log_file_path, to);
+
+  log_file_fd = open(log_file_path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+  log_file_size = 0;
+}
+
+
+/**
+ * @brief Writes log lines to log file, rotating it at a line boundary when it would exceed max size.
+ * A single line longer than max size is written to a file of its own. Lines that cannot be
+ * written are dropped. Must be called with log_file_io_lock held.
+ * @param data contains newline terminated log lines
+ * @param len contains length of data
+ */
+static void log_file_write_out(const char* data, size_t len)
+{
+  while (len > 0 && log_file_fd >= 0)
+  {
+    size_t chunk = len;
+
+    if (log_file_size + len > log_file_max_size)
+    {
+      size_t avail = (log_file_size < log_file_max_size) ? log_file_max_size - log_file_size : 0;
+      const char* eol = (avail > 0) ? (const char*)memrchr(data, '\n', avail) : NULL;
+
+      if (eol == NULL && log_file_size > 0)
+      {
+        log_file_rotate();
+        continue;
+      }
+
+      if (eol == NULL)
+      {
+        eol = (const char*)memchr(data, '\n', len);
+      }
+
+      chunk = (eol != NULL) ? (size_t)(eol - data) + 1 : len;
+    }
+
+    ssize_t nbytes = write(log_file_fd, data, chunk);
+
+    if (nbytes < 0 && errno == EINTR)
+    {
+      continue;
+    }
+
+    if (nbytes <= 0)
+    {
+      break;
+    }
+
+    data += nbytes;
+    len -= nbytes;
+    log_file_size += nbytes;
+  }
+}
+
+
+/**
+ * @brief Swaps buffers and writes out the one holding buffered lines.
+ * Must be called with log_file_io_lock held.
+ */
+static void log_file_flush_locked(void)
+{
+  pthread_mutex_lock(&log_file_buf_lock);
+
+  log_file_buf_t* buf = log_file_active_buf;
+
+  //buffer not active is always empty while io lock is held
+  log_file_active_buf = (buf == &log_file_bufs[0]) ? &log_file_bufs[1] : &log_file_bufs[0];
+  log_file_flush_pending = false;
+
+  pthread_mutex_unlock(&log_file_buf_lock);
+
+  log_file_write_out(buf->data, buf->len);
+  buf->len = 0;
+}
+
+
+/**
+ * @brief Writes out log messages buffered for log file on the calling thread
+ */
+void appd_iot_log_file_flush(void)
+{
+  if (!appd_iot_atomic_load(&log_file_enabled))
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&log_file_io_lock);
+  log_file_flush_locked();
+  pthread_mutex_unlock(&log_file_io_lock);
+}
+
+
+/**
+ * @brief Background thread writing buffered lines when buffer is half full, or at most
+ * LOG_FILE_FLUSH_INTERVAL_MS after a line is buffered. ERROR messages are written out by the logging thread.
+ */
+static void* log_file_thread_main(void* arg)
+{
+  pthread_mutex_lock(&log_file_buf_lock);
+
+  for (;;)
+  {
+    while (log_file_active_buf->len == 0)
+    {
+      pthread_cond_wait(&log_file_cond, &log_file_buf_lock);
+    }
+
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += LOG_FILE_FLUSH_INTERVAL_MS / 1000;
+    deadline.tv_nsec += (LOG_FILE_FLUSH_INTERVAL_MS % 1000) * 1000000L;
+
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+
+    while (!log_file_flush_pending && log_file_active_buf->len > 0)
+    {
+      if (pthread_cond_timedwait(&log_file_cond, &log_file_buf_lock, &deadline) == ETIMEDOUT)
+      {
+        break;
+      }
+    }
+
+    pthread_mutex_unlock(&log_file_buf_lock);
+    appd_iot_log_file_flush();
+    pthread_mutex_lock(&log_file_buf_lock);
+  }
+
+  return NULL;
+}
+
+
+/**
+ * @brief Writes out buffered log lines at exit
+ */
+static void log_file_flush_at_exit(void)
+{
+  appd_iot_log_file_flush();
+}
+
+
+/**
+ * @brief Resets locks and background thread state in child process after fork,
+ * as threads are not inherited
+ */
+static void log_file_thread_atfork_child(void)
+{
+  pthread_mutex_init(&log_file_buf_lock, NULL);
+  pthread_mutex_init(&log_file_io_lock, NULL);
+  pthread_mutex_init(&log_file_thread_lock, NULL);
+  pthread_cond_init(&log_file_cond, NULL);
+  log_file_thread_started = false;
+}
+
+
+/**
+ * @brief Starts background thread writing buffered log lines, if not started yet
+ * @return appd_iot_error_code_t indicating function execution status
+ */
+static appd_iot_error_code_t log_file_thread_start(void)
+{
+  appd_iot_error_code_t retcode = APPD_IOT_SUCCESS;
+
+  pthread_mutex_lock(&log_file_thread_lock);
+
+  if (!log_file_thread_started)
+  {
+    pthread_t log_file_thread;
+    pthread_attr_t attr;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    if (pthread_create(&log_file_thread, &attr, &log_file_thread_main, NULL) == 0)
+    {
+      static bool atexit_registered = false;
+
+      if (!atexit_registered)
+      {
+        pthread_atfork(NULL, NULL, &log_file_thread_atfork_child);
+        atexit(&log_file_flush_at_exit);
+        atexit_registered = true;
+      }
+
+      log_file_thread_started = true;
+    }
+    else
+    {
+      retcode = APPD_IOT_ERR_INTERNAL;
+    }
+
+    pthread_attr_destroy(&attr);
+  }
+
+  pthread_mutex_unlock(&log_file_thread_lock);
+
+  return retcode;
+}
+
+
+/**
+ * @brief Enables or disables writing to log file. Must be called with log_file_io_lock held.
+ */
+static void log_file_set_enabled(bool enabled)
+{
+  pthread_mutex_lock(&log_file_buf_lock);
+  appd_iot_atomic_store(&log_file_enabled, enabled);
+  pthread_mutex_unlock(&log_file_buf_lock);
+}
+
+
+/**
+ * @brief Opens file to which log messages are written, closing previous file after writing out
+ * messages buffered for it.
+ * @param path contains path of log file, appended to if it exists. NULL to close log file.
+ * @param max_size_kb contains size in KB at which file is rotated
+ * @param max_count contains number of rotated files kept
+ * @return appd_iot_error_code_t indicating function execution status
+ */
+appd_iot_error_code_t appd_iot_log_file_open(const char* path, int max_size_kb, int max_count)
+{
+  appd_iot_error_code_t retcode = APPD_IOT_SUCCESS;
+
+  pthread_mutex_lock(&log_file_io_lock);
+
+  if (log_file_fd >= 0)
+  {
+    log_file_flush_locked();
+    log_file_set_enabled(false);
+    close(log_file_fd);
+    log_file_fd = -1;
+  }
+
+  if (path != NULL)
+  {
+    struct stat st;
+
+    if (strlen(path) < sizeof(log_file_path))
+    {
+      log_file_fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    }
+
+    if (log_file_fd >= 0 && fstat(log_file_fd, &st) == 0)
+    {
+      strcpy(log_file_path, path);
+      log_file_size = st.st_size;
+      log_file_max_size = (size_t)max_size_kb * 1024;
+      log_file_max_count = max_count;
+      log_file_set_enabled(true);
+    }
+    else
+    {
+      if (log_file_fd >= 0)
+      {
+        close(log_file_fd);
+        log_file_fd = -1;
+      }
+
+      retcode = APPD_IOT_ERR_INVALID_INPUT;
+    }
+  }
+
+  pthread_mutex_unlock(&log_file_io_lock);
+
+  if (retcode == APPD_IOT_SUCCESS && path != NULL)
+  {
+    retcode = log_file_thread_start();
+  }
+
+  return retcode;
+}
+
+
+/**
+ * @brief Appends log message prefixed with timestamp to log file buffer.
+ * @param log_level contains log level of the message. ERROR messages are written out right away, along with
+ * lines buffered before them, on the calling thread.
+ * @param logmsg contains log message
+ * @param logmsg_len contains length of log message
+ * @param timestamp_ms contains time at which message was logged, APPD_IOT_LOG_NO_TIMESTAMP for none
+ * @return true if message is buffered, false if no log file is open
+ */
+bool appd_iot_log_file_write(appd_iot_log_level_t log_level, const char* logmsg, size_t logmsg_len,
+                             int64_t timestamp_ms)
+{
+  if (!appd_iot_atomic_load(&log_file_enabled))
+  {
+    return false;
+  }
+
+  char timestamp[APPD_IOT_TIME_MS_STR_SIZE + 1];
+  size_t timestamp_len = 0;
+
+  if (timestamp_ms != APPD_IOT_LOG_NO_TIMESTAMP)
+  {
+    timestamp_len = appd_iot_clock_format_time_ms(timestamp_ms, timestamp, sizeof(timestamp) - 1);
+    timestamp[timestamp_len++] = ' ';
+  }
+
+  if (timestamp_len + logmsg_len + 1 > LOG_FILE_BUF_SIZE)
+  {
+    logmsg_len = LOG_FILE_BUF_SIZE - timestamp_len - 1;
+  }
+
+  size_t line_len = timestamp_len + logmsg_len + 1;
+
+  pthread_mutex_lock(&log_file_buf_lock);
+
+  //background thread fell behind, write out buffer on calling thread
+  while (log_file_enabled && log_file_active_buf->len + line_len > LOG_FILE_BUF_SIZE)
+  {
+    pthread_mutex_unlock(&log_file_buf_lock);
+    appd_iot_log_file_flush();
+    pthread_mutex_lock(&log_file_buf_lock);
+  }
+
+  if (!log_file_enabled)
+  {
+    pthread_mutex_unlock(&log_file_buf_lock);
+    return false;
+  }
+
+  log_file_buf_t* buf = log_file_active_buf;
+  bool was_empty = (buf->len == 0);
+
+  memcpy(buf->data + buf->len, timestamp, timestamp_len);
+  memcpy(buf->data + buf->len + timestamp_len, logmsg, logmsg_len);
+  buf->data[buf->len + line_len - 1] = '\n';
+  buf->len += line_len;
+
+  bool flush = (buf->len >= LOG_FILE_BUF_SIZE / 2);
+
+  log_file_flush_pending = log_file_flush_pending || flush;
+
+  if (flush || was_empty)
+  {
+    pthread_cond_signal(&log_file_cond);
+  }
+
+  pthread_mutex_unlock(&log_file_buf_lock);
+
+  //errors are written out right away on the calling thread so that they are not lost on a crash
+  if (log_level == APPD_IOT_LOG_ERROR)
+  {
+    appd_iot_log_file_flush();
+  }
+
+  return true;
+}
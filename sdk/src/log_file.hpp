@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _LOG_FILE_HPP
+#define _LOG_FILE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <appd_iot_interface.h>
+
+//Default size at which log file is rotated
+#define APPD_IOT_LOG_FILE_DEFAULT_MAX_SIZE_KB 1024
+
+//Default and maximum number of rotated log files kept
+#define APPD_IOT_LOG_FILE_DEFAULT_MAX_COUNT 3
+#define APPD_IOT_LOG_FILE_MAX_COUNT 16
+
+/**
+ * @brief Opens file to which log messages are written, closing previous file after writing out
+ * messages buffered for it. Starts background thread writing buffered messages.
+ * @param path contains path of log file, appended to if it exists. NULL to close log file.
+ * @param max_size_kb contains size in KB at which file is rotated
+ * @param max_count contains number of rotated files kept
+ * @return appd_iot_error_code_t indicating function execution status
+ */
+appd_iot_error_code_t appd_iot_log_file_open(const char* path, int max_size_kb, int max_count);
+
+/**
+ * @brief Appends log message prefixed with timestamp to log file buffer. Never makes a system call,
+ * unless the message is an ERROR or the buffer is full because the background thread fell behind.
+ * @param log_level contains log level of the message. ERROR messages are written out right away, along with
+ * lines buffered before them, on the calling thread.
+ * @param logmsg contains log message
+ * @param logmsg_len contains length of log message
+ * @param timestamp_ms contains time at which message was logged, APPD_IOT_LOG_NO_TIMESTAMP for none
+ * @return true if message is buffered, false if no log file is open
+ */
+bool appd_iot_log_file_write(appd_iot_log_level_t log_level, const char* logmsg, size_t logmsg_len,
+                             int64_t timestamp_ms);
+
+/**
+ * @brief Writes out log messages buffered for log file on the calling thread
+ */
+void appd_iot_log_file_flush(void);
+
+#endif /* _LOG_FILE_HPP */
@@ -14,9 +14,13 @@
  * limitations under the License.
  */
 
+//Log statements in this file belong to events subsystem
+#define APPD_IOT_LOG_SUBSYSTEM APPD_IOT_LOG_SUBSYSTEM_EVENTS
+
 #include "custom_event.hpp"
 #include "log.hpp"
 #include "config.hpp"
+#include "clock.hpp"
 
 /**
  * @brief checks if http response code is valid
@@ -119,9 +123,7 @@ appd_iot_error_code_t appd_iot_add_network_request_event
     appd_iot_log(APPD_IOT_LOG_WARN, "Network Error or valid Response Code needs to be populated");
   }
 
-  if (strncmp(network_request_event.url,
-              appd_iot_get_eum_collector_url(),
-              strlen(network_request_event.url)) == 0)
+  if (appd_iot_eum_collector_url_starts_with(network_request_event.url))
   {
     appd_iot_log(APPD_IOT_LOG_WARN, "Skip Adding Network Event with Event URL same as APPD EUM Collector URL:%s",
                  network_request_event.url);
@@ -147,7 +149,9 @@ appd_iot_error_code_t appd_iot_add_network_request_event
 
   event.req_content_length = network_request_event.req_content_length;
   event.resp_content_length = network_request_event.resp_content_length;
-  event.timestamp_ms = network_request_event.timestamp_ms;
+  //request the caller did not time is reported at the time it is added
+  event.timestamp_ms = (network_request_event.timestamp_ms != 0) ? network_request_event.timestamp_ms :
+                       appd_iot_clock_get_time_ms();
   event.duration_ms = network_request_event.duration_ms;
 
   if (network_request_event.resp_headers_count > 0)
@@ -158,8 +162,9 @@ appd_iot_error_code_t appd_iot_add_network_request_event
 
     if (retcode != APPD_IOT_SUCCESS)
     {
-      appd_iot_log(APPD_IOT_LOG_ERROR, "Failed to parse network event response headers, error:%s",
-                   appd_iot_error_code_to_str(retcode));
+      appd_iot_log_with_fields(APPD_IOT_LOG_ERROR, appd_iot_log_error_code_field(retcode),
+                               "Failed to parse network event response headers, error:%s",
+                               appd_iot_error_code_to_str(retcode));
 
       appd_iot_clear_event_data(&event.resp_headers);
     }
@@ -172,8 +177,8 @@ appd_iot_error_code_t appd_iot_add_network_request_event
 
     if (retcode != APPD_IOT_SUCCESS)
     {
-      appd_iot_log(APPD_IOT_LOG_WARN, "Failed to parse Network event data, error:%s",
-                   appd_iot_error_code_to_str(retcode));
+      appd_iot_log_with_fields(APPD_IOT_LOG_WARN, appd_iot_log_error_code_field(retcode),
+                               "Failed to parse Network event data, error:%s", appd_iot_error_code_to_str(retcode));
 
       appd_iot_clear_event_data(&event.data);
     }
@@ -181,7 +186,7 @@ appd_iot_error_code_t appd_iot_add_network_request_event
 
   appd_iot_log(APPD_IOT_LOG_INFO, "Adding Network Event with URL:%s", event.url.c_str());
 
-  retcode = appd_iot_add_network_request_event_to_beacon(event);
+  retcode = appd_iot_add_network_request_event_to_beacon(&event);
 
   return retcode;
 }
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "stats.hpp"
+
+__thread appd_iot_stats_shard_t* appd_iot_thread_stats_shard = NULL;
+
+static appd_iot_stats_shard_t* global_stats_shards = NULL;
+static pthread_key_t stats_shard_key;
+static pthread_once_t stats_shard_key_once = PTHREAD_ONCE_INIT;
+
+/* time spent in disabled periods which ended, and start of current one, 0 if SDK is not disabled */
+static uint64_t global_time_disabled_ms = 0;
+static uint64_t global_disabled_since_ms = 0;
+
+
+/**
+ * @brief Releases shard of an exiting thread, so that it can be reused by another thread. <br>
+ * Thread pointer is cleared first, so that stats updated by destructors which run later take over
+ * a shard again instead of writing to one owned by another thread.
+ * @param shard owned by exiting thread
+ */
+static void stats_shard_release(void* shard)
+{
+  appd_iot_thread_stats_shard = NULL;
+  appd_iot_atomic_store(&((appd_iot_stats_shard_t*)shard)->in_use, 0);
+}
+
+
+/**
+ * @brief Creates key used to release shard on thread exit
+ */
+static void stats_shard_key_create(void)
+{
+  pthread_key_create(&stats_shard_key, &stats_shard_release);
+}
+
+
+/**
+ * @brief Get stats shard of the calling thread, taking over a released shard or allocating a new one
+ * @return shard of calling thread, NULL on failure to allocate memory
+ */
+appd_iot_stats_shard_t* appd_iot_stats_get_shard(void)
+{
+  if (appd_iot_thread_stats_shard != NULL)
+  {
+    return appd_iot_thread_stats_shard;
+  }
+
+  appd_iot_stats_shard_t* shard;
+
+  for (shard = appd_iot_atomic_load(&global_stats_shards); shard != NULL; shard = shard->next)
+  {
+    int in_use = 0;
+
+    if (appd_iot_atomic_compare_exchange(&shard->in_use, &in_use, 1))
+    {
+      break;
+    }
+  }
+
+  if (shard == NULL)
+  {
+    shard = (appd_iot_stats_shard_t*)calloc(1, sizeof(appd_iot_stats_shard_t));
+
+    if (shard == NULL)
+    {
+      return NULL;
+    }
+
+    shard->in_use = 1;
+    shard->next = appd_iot_atomic_load(&global_stats_shards);
+
+    while (!appd_iot_atomic_compare_exchange(&global_stats_shards, &shard->next, shard));
+  }
+
+  pthread_once(&stats_shard_key_once, &stats_shard_key_create);
+  pthread_setspecific(stats_shard_key, shard);
+
+  appd_iot_thread_stats_shard = shard;
+
+  return shard;
+}
+
+
+/**
+ * @brief Get monotonic time in microseconds, used to measure latency of SDK operations
+ * @return time in microseconds
+ */
+uint64_t appd_iot_stats_get_time_us(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+/**
+ * @brief Get monotonic time in milliseconds from coarse clock
+ */
+static uint64_t stats_get_coarse_time_ms(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+/**
+ * @brief Records latency of an operation in a histogram in the shard of the calling thread
+ * @param histogram identifies the histogram
+ * @param latency_us contains latency in microseconds
+ */
+void appd_iot_stats_record_latency(appd_iot_histogram_id_t histogram, uint64_t latency_us)
+{
+  appd_iot_stats_shard_t* shard = appd_iot_stats_get_shard();
+
+  if (shard == NULL)
+  {
+    return;
+  }
+
+  appd_iot_histogram_t* hist = &shard->histograms[histogram];
+  int bucket = 63 - __builtin_clzll(latency_us | 1);
+
+  if (bucket >= APPD_IOT_STATS_HISTOGRAM_BUCKETS)
+  {
+    bucket = APPD_IOT_STATS_HISTOGRAM_BUCKETS - 1;
+  }
+
+  appd_iot_atomic_store_relaxed(&hist->buckets[bucket], hist->buckets[bucket] + 1);
+  appd_iot_atomic_store_relaxed(&hist->count, hist->count + 1);
+  appd_iot_atomic_store_relaxed(&hist->sum_us, hist->sum_us + latency_us);
+
+  if (latency_us > hist->max_us)
+  {
+    appd_iot_atomic_store_relaxed(&hist->max_us, latency_us);
+  }
+}
+
+
+/**
+ * @brief Starts timing phases of a send
+ * @param timer to be started
+ */
+void appd_iot_send_timer_start(appd_iot_send_timer_t* timer)
+{
+  memset(timer, 0, sizeof(appd_iot_send_timer_t));
+  timer->mark_us = appd_iot_stats_get_time_us();
+}
+
+
+/**
+ * @brief Adds time since timer was started or previous part ended to a phase
+ * @param timer of the send
+ * @param phase which ended
+ */
+void appd_iot_send_timer_phase(appd_iot_send_timer_t* timer, appd_iot_histogram_id_t phase)
+{
+  uint64_t now_us = appd_iot_stats_get_time_us();
+
+  timer->phase_us[phase] += now_us - timer->mark_us;
+  timer->phases |= (1u << phase);
+  timer->mark_us = now_us;
+}
+
+
+/**
+ * @brief Records time of each phase that has been timed in its latency histogram
+ * @param timer of the send
+ */
+void appd_iot_send_timer_stop(const appd_iot_send_timer_t* timer)
+{
+  for (int i = 0; i < APPD_IOT_MAX_HISTOGRAMS; i++)
+  {
+    if (timer->phases & (1u << i))
+    {
+      appd_iot_stats_record_latency((appd_iot_histogram_id_t)i, timer->phase_us[i]);
+    }
+  }
+}
+
+
+/**
+ * @brief Checks if sdk state is one of the states in which collector has disabled SDK
+ */
+static bool stats_is_disabled_state(appd_iot_sdk_state_t sdk_state)
+{
+  return (sdk_state == APPD_IOT_SDK_DISABLED_KILL_SWITCH ||
+          sdk_state == APPD_IOT_SDK_DISABLED_LICENSE_EXPIRED ||
+          sdk_state == APPD_IOT_SDK_DISABLED_DATA_LIMIT_EXCEEDED);
+}
+
+
+/**
+ * @brief Tracks time SDK spends disabled by collector. Called on each SDK state change.
+ * @param prev_state contains previous sdk state
+ * @param new_state contains new sdk state
+ */
+void appd_iot_stats_sdk_state_changed(appd_iot_sdk_state_t prev_state, appd_iot_sdk_state_t new_state)
+{
+  bool was_disabled = stats_is_disabled_state(prev_state);
+  bool disabled = stats_is_disabled_state(new_state);
+
+  if (!was_disabled && disabled)
+  {
+    //0 is reserved for not disabled
+    uint64_t now_ms = stats_get_coarse_time_ms();
+
+    appd_iot_atomic_store(&global_disabled_since_ms, (now_ms > 0) ? now_ms : 1);
+  }
+  else if (was_disabled && !disabled)
+  {
+    uint64_t disabled_since_ms = appd_iot_atomic_exchange(&global_disabled_since_ms, (uint64_t)0);
+
+    if (disabled_since_ms != 0)
+    {
+      appd_iot_atomic_fetch_add(&global_time_disabled_ms, stats_get_coarse_time_ms() - disabled_since_ms);
+    }
+  }
+}
+
+
+/**
+ * @brief Adds histogram of a shard to histogram in snapshot
+ */
+static void stats_add_histogram(appd_iot_histogram_t* dest, const appd_iot_histogram_t* src)
+{
+  dest->count += appd_iot_atomic_load_relaxed(&src->count);
+  dest->sum_us += appd_iot_atomic_load_relaxed(&src->sum_us);
+
+  uint64_t max_us = appd_iot_atomic_load_relaxed(&src->max_us);
+
+  if (max_us > dest->max_us)
+  {
+    dest->max_us = max_us;
+  }
+
+  for (int i = 0; i < APPD_IOT_STATS_HISTOGRAM_BUCKETS; i++)
+  {
+    dest->buckets[i] += appd_iot_atomic_load_relaxed(&src->buckets[i]);
+  }
+}
+
+
+/**
+ * @brief Get snapshot of SDK self-telemetry counters and latency histograms.
+ * @param stats to which snapshot is written
+ * @return appd_iot_error_code_t Error code indicating if the function call is a success or fail.
+ */
+appd_iot_error_code_t appd_iot_get_stats(appd_iot_stats_t* stats)
+{
+  if (stats == NULL)
+  {
+    return APPD_IOT_ERR_NULL_PTR;
+  }
+
+  uint64_t counters[APPD_IOT_MAX_STATS] = {0};
+
+  memset(stats, 0, sizeof(appd_iot_stats_t));
+
+  for (appd_iot_stats_shard_t* shard = appd_iot_atomic_load(&global_stats_shards); shard != NULL;
+       shard = shard->next)
+  {
+    for (int i = 0; i < APPD_IOT_MAX_STATS; i++)
+    {
+      counters[i] += appd_iot_atomic_load_relaxed(&shard->counters[i]);
+    }
+
+    stats_add_histogram(&stats->snapshot_latency, &shard->histograms[APPD_IOT_HISTOGRAM_SNAPSHOT]);
+    stats_add_histogram(&stats->serialize_latency, &shard->histograms[APPD_IOT_HISTOGRAM_SERIALIZE]);
+    stats_add_histogram(&stats->transport_latency, &shard->histograms[APPD_IOT_HISTOGRAM_TRANSPORT]);
+    stats_add_histogram(&stats->response_latency, &shard->histograms[APPD_IOT_HISTOGRAM_RESPONSE]);
+    stats_add_histogram(&stats->clear_latency, &shard->histograms[APPD_IOT_HISTOGRAM_CLEAR]);
+  }
+
+  stats->custom_events_added = counters[APPD_IOT_STAT_CUSTOM_EVENTS_ADDED];
+  stats->network_events_added = counters[APPD_IOT_STAT_NETWORK_EVENTS_ADDED];
+  stats->error_events_added = counters[APPD_IOT_STAT_ERROR_EVENTS_ADDED];
+  stats->custom_events_dropped = counters[APPD_IOT_STAT_CUSTOM_EVENTS_DROPPED];
+  stats->network_events_dropped = counters[APPD_IOT_STAT_NETWORK_EVENTS_DROPPED];
+  stats->error_events_dropped = counters[APPD_IOT_STAT_ERROR_EVENTS_DROPPED];
+  stats->events_sent = counters[APPD_IOT_STAT_EVENTS_SENT];
+  stats->beacons_sent = counters[APPD_IOT_STAT_BEACONS_SENT];
+  stats->beacon_send_failures = counters[APPD_IOT_STAT_BEACON_SEND_FAILURES];
+  stats->events_requeued = counters[APPD_IOT_STAT_EVENTS_REQUEUED];
+  stats->bytes_serialized = counters[APPD_IOT_STAT_BYTES_SERIALIZED];
+  stats->bytes_sent = counters[APPD_IOT_STAT_BYTES_SENT];
+
+  stats->time_disabled_ms = appd_iot_atomic_load(&global_time_disabled_ms);
+
+  uint64_t disabled_since_ms = appd_iot_atomic_load(&global_disabled_since_ms);
+
+  if (disabled_since_ms != 0)
+  {
+    stats->time_disabled_ms += stats_get_coarse_time_ms() - disabled_since_ms;
+  }
+
+  return APPD_IOT_SUCCESS;
+}
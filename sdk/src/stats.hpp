@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STATS_HPP
+#define _STATS_HPP
+
+#include <stdint.h>
+#include <appd_iot_interface.h>
+#include "atomic.hpp"
+
+/**
+ * @brief SDK self-telemetry counters, in the order of the fields in appd_iot_stats_t
+ */
+typedef enum
+{
+  APPD_IOT_STAT_CUSTOM_EVENTS_ADDED,
+  APPD_IOT_STAT_NETWORK_EVENTS_ADDED,
+  APPD_IOT_STAT_ERROR_EVENTS_ADDED,
+  APPD_IOT_STAT_CUSTOM_EVENTS_DROPPED,
+  APPD_IOT_STAT_NETWORK_EVENTS_DROPPED,
+  APPD_IOT_STAT_ERROR_EVENTS_DROPPED,
+  APPD_IOT_STAT_EVENTS_SENT,
+  APPD_IOT_STAT_BEACONS_SENT,
+  APPD_IOT_STAT_BEACON_SEND_FAILURES,
+  APPD_IOT_STAT_EVENTS_REQUEUED,
+  APPD_IOT_STAT_BYTES_SERIALIZED,
+  APPD_IOT_STAT_BYTES_SENT,
+  APPD_IOT_MAX_STATS
+} appd_iot_stat_t;
+
+/**
+ * @brief SDK latency histograms, one per phase of sending events to collector
+ */
+typedef enum
+{
+  APPD_IOT_HISTOGRAM_SNAPSHOT,
+  APPD_IOT_HISTOGRAM_SERIALIZE,
+  APPD_IOT_HISTOGRAM_TRANSPORT,
+  APPD_IOT_HISTOGRAM_RESPONSE,
+  APPD_IOT_HISTOGRAM_CLEAR,
+  APPD_IOT_MAX_HISTOGRAMS
+} appd_iot_histogram_id_t;
+
+/**
+ * @brief Time spent in each phase of a send. A phase may be timed in several parts, which add up.
+ */
+typedef struct
+{
+  uint64_t mark_us;                             /* end of previous part */
+  uint64_t phase_us[APPD_IOT_MAX_HISTOGRAMS];   /* time spent per phase */
+  unsigned int phases;                          /* bit per phase which has been timed */
+} appd_iot_send_timer_t;
+
+/**
+ * @brief Counters and histograms updated by a single thread. Shards are never freed. Shard of
+ * a thread that exits is reused by the next thread which updates stats, keeping its counts.
+ */
+typedef struct appd_iot_stats_shard
+{
+  uint64_t counters[APPD_IOT_MAX_STATS];
+  appd_iot_histogram_t histograms[APPD_IOT_MAX_HISTOGRAMS];
+  int in_use;                         /* 1 while shard is owned by a thread */
+  struct appd_iot_stats_shard* next;  /* next shard in list of all shards */
+} appd_iot_stats_shard_t;
+
+extern __thread appd_iot_stats_shard_t* appd_iot_thread_stats_shard;
+
+/**
+ * @brief Get stats shard of the calling thread, taking over a released shard or allocating a new one
+ * @return shard of calling thread, NULL on failure to allocate memory
+ */
+appd_iot_stats_shard_t* appd_iot_stats_get_shard(void);
+
+/**
+ * @brief Adds to a counter in the shard of the calling thread. Only the owning thread writes
+ * a shard, so the counter is updated with a plain relaxed store, without a locked instruction.
+ * @param stat identifies the counter
+ * @param value to be added
+ */
+inline void appd_iot_stats_add(appd_iot_stat_t stat, uint64_t value)
+{
+  appd_iot_stats_shard_t* shard = appd_iot_thread_stats_shard;
+
+  if (shard == NULL && (shard = appd_iot_stats_get_shard()) == NULL)
+  {
+    return;
+  }
+
+  appd_iot_atomic_store_relaxed(&shard->counters[stat], shard->counters[stat] + value);
+}
+
+/**
+ * @brief Get monotonic time in microseconds, used to measure latency of SDK operations
+ * @return time in microseconds
+ */
+uint64_t appd_iot_stats_get_time_us(void);
+
+/**
+ * @brief Records latency of an operation in a histogram in the shard of the calling thread
+ * @param histogram identifies the histogram
+ * @param latency_us contains latency in microseconds
+ */
+void appd_iot_stats_record_latency(appd_iot_histogram_id_t histogram, uint64_t latency_us);
+
+/**
+ * @brief Starts timing phases of a send
+ * @param timer to be started
+ */
+void appd_iot_send_timer_start(appd_iot_send_timer_t* timer);
+
+/**
+ * @brief Adds time since timer was started or previous part ended to a phase
+ * @param timer of the send
+ * @param phase which ended
+ */
+void appd_iot_send_timer_phase(appd_iot_send_timer_t* timer, appd_iot_histogram_id_t phase);
+
+/**
+ * @brief Records time of each phase that has been timed in its latency histogram
+ * @param timer of the send
+ */
+void appd_iot_send_timer_stop(const appd_iot_send_timer_t* timer);
+
+/**
+ * @brief Tracks time SDK spends disabled by collector. Called on each SDK state change.
+ * @param prev_state contains previous sdk state
+ * @param new_state contains new sdk state
+ */
+void appd_iot_stats_sdk_state_changed(appd_iot_sdk_state_t prev_state, appd_iot_sdk_state_t new_state);
+
+#endif /* _STATS_HPP */
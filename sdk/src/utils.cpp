@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+//Log statements in this file belong to events subsystem
+#define APPD_IOT_LOG_SUBSYSTEM APPD_IOT_LOG_SUBSYSTEM_EVENTS
+
 #include "utils.hpp"
 #include "log.hpp"
 
@@ -0,0 +1,522 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _JSON_VALIDATOR_HPP
+#define _JSON_VALIDATOR_HPP
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/*
+ * Strict JSON validator shared by the loopback collector and the serializer fuzzer. <br>
+ * It has no dependency on the SDK, so that output of the SDK is checked by an independent parser.
+ */
+
+#define JSON_VALIDATOR_MAX_DEPTH 64
+
+
+/**
+ * @brief Validates JSON payload and counts events in beacons
+ */
+class json_validator
+{
+public:
+  json_validator(const char* buf, size_t len) : buf_(buf), len_(len), pos_(0), events_(0), strings_(NULL) { }
+
+  /**
+   * @brief Decoded keys and string values are appended to strings in document order by
+   * the next call to validate
+   */
+  void collect_strings(std::vector<std::string>* strings)
+  {
+    strings_ = strings;
+  }
+
+  /**
+   * @brief Validates payload is a JSON array of objects
+   * @return true if payload is valid
+   */
+  bool validate(void)
+  {
+    skip_ws();
+
+    if (pos_ >= len_ || buf_[pos_] != '[')
+    {
+      return false;
+    }
+
+    pos_++;
+    skip_ws();
+
+    if (peek() == ']')
+    {
+      pos_++;
+      return at_end();
+    }
+
+    for (;;)
+    {
+      skip_ws();
+
+      if (peek() != '{' || !parse_value(1, ""))
+      {
+        return false;
+      }
+
+      skip_ws();
+
+      if (peek() == ',')
+      {
+        pos_++;
+        continue;
+      }
+
+      if (peek() != ']')
+      {
+        return false;
+      }
+
+      pos_++;
+      return at_end();
+    }
+  }
+
+  /**
+   * @brief Validates payload is a single JSON value of any type
+   * @return true if payload is valid
+   */
+  bool validate_value(void)
+  {
+    return parse_value(1, "") && at_end();
+  }
+
+  /**
+   * @brief Get number of events in beacons of a valid payload
+   */
+  uint64_t events(void) const
+  {
+    return events_;
+  }
+
+private:
+  char peek(void) const
+  {
+    return (pos_ < len_) ? buf_[pos_] : '\0';
+  }
+
+  void skip_ws(void)
+  {
+    while (pos_ < len_ && (buf_[pos_] == ' ' || buf_[pos_] == '\t' || buf_[pos_] == '\n' || buf_[pos_] == '\r'))
+    {
+      pos_++;
+    }
+  }
+
+  bool at_end(void)
+  {
+    skip_ws();
+    return (pos_ == len_);
+  }
+
+  static int hex_value(char c)
+  {
+    if (c >= '0' && c <= '9')
+    {
+      return c - '0';
+    }
+
+    if (c >= 'a' && c <= 'f')
+    {
+      return c - 'a' + 10;
+    }
+
+    if (c >= 'A' && c <= 'F')
+    {
+      return c - 'A' + 10;
+    }
+
+    return -1;
+  }
+
+  /**
+   * @brief Appends code point of a \u escape to str as UTF-8
+   */
+  static void append_utf8(std::string* str, unsigned int cp)
+  {
+    if (cp < 0x80)
+    {
+      str->push_back((char)cp);
+    }
+    else if (cp < 0x800)
+    {
+      str->push_back((char)(0xC0 | (cp >> 6)));
+      str->push_back((char)(0x80 | (cp & 0x3F)));
+    }
+    else
+    {
+      str->push_back((char)(0xE0 | (cp >> 12)));
+      str->push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+      str->push_back((char)(0x80 | (cp & 0x3F)));
+    }
+  }
+
+  /**
+   * @brief Parses a JSON string
+   * @param str to which decoded string is written, can be NULL
+   */
+  bool parse_string(std::string* str)
+  {
+    if (peek() != '"')
+    {
+      return false;
+    }
+
+    pos_++;
+
+    if (str != NULL)
+    {
+      str->clear();
+    }
+
+    while (pos_ < len_ && buf_[pos_] != '"')
+    {
+      char c = buf_[pos_];
+
+      if ((unsigned char)c < 0x20)
+      {
+        return false;
+      }
+
+      if (c == '\\')
+      {
+        pos_++;
+
+        if (pos_ >= len_ || strchr("\"\\/bfnrtu", buf_[pos_]) == NULL)
+        {
+          return false;
+        }
+
+        switch (buf_[pos_])
+        {
+          case 'b':
+            c = '\b';
+            break;
+
+          case 'f':
+            c = '\f';
+            break;
+
+          case 'n':
+            c = '\n';
+            break;
+
+          case 'r':
+            c = '\r';
+            break;
+
+          case 't':
+            c = '\t';
+            break;
+
+          case 'u':
+          {
+            unsigned int cp = 0;
+
+            for (int i = 1; i <= 4; i++)
+            {
+              int digit = (pos_ + i < len_) ? hex_value(buf_[pos_ + i]) : -1;
+
+              if (digit < 0)
+              {
+                return false;
+              }
+
+              cp = (cp << 4) | (unsigned int)digit;
+            }
+
+            pos_ += 5;
+
+            if (str != NULL)
+            {
+              append_utf8(str, cp);
+            }
+
+            continue;
+          }
+
+          default:
+            c = buf_[pos_];
+            break;
+        }
+      }
+
+      if (str != NULL)
+      {
+        str->push_back(c);
+      }
+
+      pos_++;
+    }
+
+    if (pos_ >= len_)
+    {
+      return false;
+    }
+
+    pos_++;
+    return true;
+  }
+
+  /**
+   * @brief Parses a string and appends it to collected strings
+   */
+  bool parse_collected_string(std::string* str)
+  {
+    if (!parse_string(str))
+    {
+      return false;
+    }
+
+    if (strings_ != NULL)
+    {
+      strings_->push_back(*str);
+    }
+
+    return true;
+  }
+
+  bool parse_digits(void)
+  {
+    size_t start = pos_;
+
+    while (pos_ < len_ && buf_[pos_] >= '0' && buf_[pos_] <= '9')
+    {
+      pos_++;
+    }
+
+    return (pos_ > start);
+  }
+
+  /**
+   * @brief Parses number as per JSON grammar: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+   */
+  bool parse_number(void)
+  {
+    if (peek() == '-')
+    {
+      pos_++;
+    }
+
+    if (peek() == '0')
+    {
+      pos_++;
+    }
+    else if (!parse_digits())
+    {
+      return false;
+    }
+
+    if (peek() == '.')
+    {
+      pos_++;
+
+      if (!parse_digits())
+      {
+        return false;
+      }
+    }
+
+    if (peek() == 'e' || peek() == 'E')
+    {
+      pos_++;
+
+      if (peek() == '+' || peek() == '-')
+      {
+        pos_++;
+      }
+
+      if (!parse_digits())
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool parse_literal(const char* literal)
+  {
+    size_t len = strlen(literal);
+
+    if (pos_ + len > len_ || memcmp(buf_ + pos_, literal, len) != 0)
+    {
+      return false;
+    }
+
+    pos_ += len;
+    return true;
+  }
+
+  /**
+   * @brief Parses a JSON value. Elements of event arrays of a beacon object are counted as events.
+   * @param depth contains nesting depth of value, beacon objects are at depth 1
+   * @param key contains key of value in its parent object
+   */
+  bool parse_value(int depth, const std::string& key)
+  {
+    if (depth > JSON_VALIDATOR_MAX_DEPTH)
+    {
+      return false;
+    }
+
+    skip_ws();
+
+    switch (peek())
+    {
+      case '{':
+      {
+        pos_++;
+        skip_ws();
+
+        if (peek() == '}')
+        {
+          pos_++;
+          return true;
+        }
+
+        for (;;)
+        {
+          std::string member_key;
+
+          skip_ws();
+
+          if (!parse_collected_string(&member_key))
+          {
+            return false;
+          }
+
+          skip_ws();
+
+          if (peek() != ':')
+          {
+            return false;
+          }
+
+          pos_++;
+
+          if (!parse_value(depth + 1, member_key))
+          {
+            return false;
+          }
+
+          skip_ws();
+
+          if (peek() == ',')
+          {
+            pos_++;
+            continue;
+          }
+
+          if (peek() != '}')
+          {
+            return false;
+          }
+
+          pos_++;
+          return true;
+        }
+      }
+
+      case '[':
+      {
+        bool is_event_array = (depth == 2 && (key == "customEvents" || key == "networkRequestEvents" ||
+                                              key == "errorEvents"));
+
+        pos_++;
+        skip_ws();
+
+        if (peek() == ']')
+        {
+          pos_++;
+          return true;
+        }
+
+        for (;;)
+        {
+          if (!parse_value(depth + 1, ""))
+          {
+            return false;
+          }
+
+          if (is_event_array)
+          {
+            events_++;
+          }
+
+          skip_ws();
+
+          if (peek() == ',')
+          {
+            pos_++;
+            continue;
+          }
+
+          if (peek() != ']')
+          {
+            return false;
+          }
+
+          pos_++;
+          return true;
+        }
+      }
+
+      case '"':
+      {
+        if (strings_ == NULL)
+        {
+          return parse_string(NULL);
+        }
+
+        std::string value;
+
+        return parse_collected_string(&value);
+      }
+
+      case 't':
+        return parse_literal("true");
+
+      case 'f':
+        return parse_literal("false");
+
+      case 'n':
+        return parse_literal("null");
+
+      default:
+        return parse_number();
+    }
+  }
+
+  const char* buf_;
+  size_t len_;
+  size_t pos_;
+  uint64_t events_;
+  std::vector<std::string>* strings_;
+};
+
+#endif /* _JSON_VALIDATOR_HPP */
@@ -0,0 +1,574 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "json_serializer.hpp"
+#include "json_validator.hpp"
+
+/**
+ * Fuzz target for the JSON serializer. Input bytes are decoded into a sequence of
+ * appd_iot_json_start_*, add_* and end_* calls with random keys and string values. The output must
+ * parse as JSON and the keys and strings decoded from it must match the ones that were added.
+ * Any mismatch aborts.
+ *
+ * Built with -DAPPD_IOT_LIBFUZZER and -fsanitize=fuzzer (clang), it is a libFuzzer target.
+ * Otherwise it is a standalone driver which doubles as a throughput benchmark:
+ *
+ * Usage: json_serializer_fuzzer [options] [corpus file or directory ...]
+ *   -g <count>  also run given number of pseudo random inputs
+ *   -s <seed>   seed for pseudo random inputs, default 1
+ *   -n <count>  serialize corpus given number of times for throughput, default 1
+ *   -w <file>   write serialized output of each input to reference file
+ *   -c <file>   compare serialized output of each input with reference file, byte for byte
+ *
+ * Throughput of serialization, excluding the checks, is written to stdout as a JSON line. A reference
+ * file written by one serializer and compared by another validates a rewritten serializer against the
+ * current one.
+ */
+
+#define FUZZ_MAX_DEPTH 32
+#define FUZZ_MAX_OPS 4096
+#define FUZZ_RANDOM_INPUT_MAX_LEN 2048
+
+typedef enum
+{
+  FUZZ_OP_START_OBJECT = 0,
+  FUZZ_OP_START_ARRAY,
+  FUZZ_OP_END,
+  FUZZ_OP_STRING,
+  FUZZ_OP_INTEGER,
+  FUZZ_OP_DOUBLE,
+  FUZZ_OP_BOOLEAN,
+  FUZZ_OP_LONG_STRING,
+  FUZZ_OP_MAX
+} fuzz_op_t;
+
+
+/**
+ * @brief Reads fuzz input byte by byte. Reads past the end return zero.
+ */
+class fuzz_input
+{
+public:
+  fuzz_input(const uint8_t* data, size_t size) : data_(data), size_(size), pos_(0) { }
+
+  bool done(void) const
+  {
+    return (pos_ >= size_);
+  }
+
+  uint8_t next(void)
+  {
+    return (pos_ < size_) ? data_[pos_++] : 0;
+  }
+
+  /**
+   * @brief Reads a string of up to given length. String ends at the first null byte.
+   */
+  std::string next_string(size_t maxlen)
+  {
+    std::string str;
+
+    while (str.length() < maxlen && pos_ < size_)
+    {
+      char c = (char)data_[pos_++];
+
+      if (c == '\0')
+      {
+        break;
+      }
+
+      str.push_back(c);
+    }
+
+    return str;
+  }
+
+  void next_bytes(void* buf, size_t len)
+  {
+    memset(buf, 0, len);
+
+    size_t avail = std::min(len, size_ - std::min(pos_, size_));
+
+    memcpy(buf, data_ + pos_, avail);
+    pos_ += avail;
+  }
+
+private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t pos_;
+};
+
+
+/**
+ * @brief Checks return code of a serializer call, aborts on failure
+ */
+static void check(appd_iot_error_code_t retcode, const char* call)
+{
+  if (retcode != APPD_IOT_SUCCESS)
+  {
+    fprintf(stderr, "%s failed with %d\n", call, (int)retcode);
+    abort();
+  }
+}
+
+
+/**
+ * @brief Serializes calls decoded from fuzz input to json
+ * @param json to which calls are applied, reset before use
+ * @param expected to which keys and string values are written in the order they are added
+ * @return serialized output
+ */
+static const char* serialize(json_t* json, const uint8_t* data, size_t size, std::vector<std::string>* expected)
+{
+  fuzz_input in(data, size);
+  std::vector<bool> in_object;
+
+  expected->clear();
+  appd_iot_json_reset(json);
+
+  //root is always a container so that output is a single json value
+  if (in.next() & 1)
+  {
+    check(appd_iot_json_start_array(json, NULL), "start_array");
+    in_object.push_back(false);
+  }
+  else
+  {
+    check(appd_iot_json_start_object(json, NULL), "start_object");
+    in_object.push_back(true);
+  }
+
+  for (int ops = 0; !in.done() && !in_object.empty() && ops < FUZZ_MAX_OPS; ops++)
+  {
+    int op = in.next() % FUZZ_OP_MAX;
+    bool object = in_object.back();
+    std::string key;
+
+    if (object && op != FUZZ_OP_END)
+    {
+      key = in.next_string(in.next() % 32);
+      expected->push_back(key);
+    }
+
+    const char* name = object ? key.c_str() : NULL;
+
+    switch (op)
+    {
+      case FUZZ_OP_START_OBJECT:
+      case FUZZ_OP_START_ARRAY:
+        if (in_object.size() >= FUZZ_MAX_DEPTH)
+        {
+          check(object ? appd_iot_json_add_boolean_key_value(json, name, true) :
+                appd_iot_json_add_boolean_value(json, true), "add_boolean");
+          break;
+        }
+
+        if (op == FUZZ_OP_START_OBJECT)
+        {
+          check(appd_iot_json_start_object(json, name), "start_object");
+        }
+        else
+        {
+          check(appd_iot_json_start_array(json, name), "start_array");
+        }
+
+        in_object.push_back(op == FUZZ_OP_START_OBJECT);
+        break;
+
+      case FUZZ_OP_END:
+        check(object ? appd_iot_json_end_object(json) : appd_iot_json_end_array(json), "end");
+        in_object.pop_back();
+        break;
+
+      case FUZZ_OP_STRING:
+      case FUZZ_OP_LONG_STRING:
+      {
+        size_t maxlen = (op == FUZZ_OP_LONG_STRING) ? 64 * (size_t)in.next() : in.next() % 64;
+        std::string value = in.next_string(maxlen);
+
+        expected->push_back(value);
+        check(object ? appd_iot_json_add_string_key_value(json, name, value.c_str()) :
+              appd_iot_json_add_string_value(json, value.c_str()), "add_string");
+        break;
+      }
+
+      case FUZZ_OP_INTEGER:
+      {
+        int64_t intval;
+
+        in.next_bytes(&intval, sizeof(intval));
+        check(object ? appd_iot_json_add_integer_key_value(json, name, intval) :
+              appd_iot_json_add_integer_value(json, intval), "add_integer");
+        break;
+      }
+
+      case FUZZ_OP_DOUBLE:
+      {
+        double doubleval;
+
+        in.next_bytes(&doubleval, sizeof(doubleval));
+        check(object ? appd_iot_json_add_double_key_value(json, name, doubleval) :
+              appd_iot_json_add_double_value(json, doubleval), "add_double");
+        break;
+      }
+
+      case FUZZ_OP_BOOLEAN:
+      {
+        bool boolval = (in.next() & 1);
+
+        check(object ? appd_iot_json_add_boolean_key_value(json, name, boolval) :
+              appd_iot_json_add_boolean_value(json, boolval), "add_boolean");
+        break;
+      }
+    }
+  }
+
+  while (!in_object.empty())
+  {
+    check(in_object.back() ? appd_iot_json_end_object(json) : appd_iot_json_end_array(json), "end");
+    in_object.pop_back();
+  }
+
+  return appd_iot_json_get_string(json);
+}
+
+
+/**
+ * @brief Checks output parses as json and strings decoded from it are the expected ones. Aborts otherwise.
+ */
+static void verify(const char* output, const std::vector<std::string>& expected)
+{
+  std::vector<std::string> decoded;
+  json_validator validator(output, strlen(output));
+
+  validator.collect_strings(&decoded);
+
+  if (!validator.validate_value())
+  {
+    fprintf(stderr, "invalid json: %s\n", output);
+    abort();
+  }
+
+  if (decoded != expected)
+  {
+    fprintf(stderr, "decoded strings do not match strings added: %s\n", output);
+    abort();
+  }
+}
+
+
+#ifdef APPD_IOT_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  static json_t* json = appd_iot_json_init();
+  std::vector<std::string> expected;
+
+  verify(serialize(json, data, size, &expected), expected);
+
+  return 0;
+}
+
+#else
+
+/**
+ * @brief Get monotonic time in nanoseconds
+ */
+static long long get_time_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/**
+ * @brief Reads entire file into buffer
+ * @return true on success
+ */
+static bool read_file(const char* path, std::vector<uint8_t>& buf)
+{
+  FILE* fp = fopen(path, "rb");
+  uint8_t chunk[64 * 1024];
+  size_t len;
+
+  if (fp == NULL)
+  {
+    return false;
+  }
+
+  while ((len = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+  {
+    buf.insert(buf.end(), chunk, chunk + len);
+  }
+
+  bool success = (ferror(fp) == 0);
+
+  fclose(fp);
+
+  return success;
+}
+
+
+/**
+ * @brief Adds file, or files in directory, to corpus. Directory entries are added in name order.
+ * @return true on success
+ */
+static bool add_to_corpus(const char* path, std::vector<std::vector<uint8_t> >& corpus)
+{
+  struct stat st;
+
+  if (stat(path, &st) != 0)
+  {
+    fprintf(stderr, "%s: not found\n", path);
+    return false;
+  }
+
+  if (!S_ISDIR(st.st_mode))
+  {
+    corpus.push_back(std::vector<uint8_t>());
+
+    if (!read_file(path, corpus.back()))
+    {
+      fprintf(stderr, "%s: failed to read\n", path);
+      return false;
+    }
+
+    return true;
+  }
+
+  DIR* dir = opendir(path);
+  std::vector<std::string> names;
+  struct dirent* entry;
+
+  if (dir == NULL)
+  {
+    fprintf(stderr, "%s: failed to open\n", path);
+    return false;
+  }
+
+  while ((entry = readdir(dir)) != NULL)
+  {
+    if (entry->d_name[0] != '.')
+    {
+      names.push_back(std::string(path) + "/" + entry->d_name);
+    }
+  }
+
+  closedir(dir);
+  std::sort(names.begin(), names.end());
+
+  for (size_t i = 0; i < names.size(); i++)
+  {
+    if (!add_to_corpus(names[i].c_str(), corpus))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+/**
+ * @brief Writes output of an input to reference file as 4 byte length followed by output
+ */
+static bool write_reference(FILE* fp, const char* output)
+{
+  uint32_t len = (uint32_t)strlen(output);
+
+  return (fwrite(&len, sizeof(len), 1, fp) == 1 && fwrite(output, 1, len, fp) == len);
+}
+
+
+/**
+ * @brief Compares output of an input with the next one in reference file
+ */
+static bool compare_reference(FILE* fp, const char* output)
+{
+  uint32_t len = 0;
+  std::string reference;
+
+  if (fread(&len, sizeof(len), 1, fp) != 1)
+  {
+    return false;
+  }
+
+  reference.resize(len);
+
+  if (len > 0 && fread(&reference[0], 1, len, fp) != len)
+  {
+    return false;
+  }
+
+  return (reference == output);
+}
+
+
+static void print_usage(void)
+{
+  fprintf(stderr, "Usage: json_serializer_fuzzer [-g count] [-s seed] [-n count] [-w file | -c file] "
+          "[corpus file or directory ...]\n");
+}
+
+
+int main(int argc, char* argv[])
+{
+  std::vector<std::vector<uint8_t> > corpus;
+  const char* write_path = NULL;
+  const char* compare_path = NULL;
+  unsigned long random_inputs = 0;
+  unsigned int seed = 1;
+  int repeat = 1;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "g:s:n:w:c:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'g':
+        random_inputs = strtoul(optarg, NULL, 10);
+        break;
+
+      case 's':
+        seed = (unsigned int)strtoul(optarg, NULL, 10);
+        break;
+
+      case 'n':
+        repeat = std::max(1, atoi(optarg));
+        break;
+
+      case 'w':
+        write_path = optarg;
+        break;
+
+      case 'c':
+        compare_path = optarg;
+        break;
+
+      default:
+        print_usage();
+        return 1;
+    }
+  }
+
+  for (int i = optind; i < argc; i++)
+  {
+    if (!add_to_corpus(argv[i], corpus))
+    {
+      return 1;
+    }
+  }
+
+  //random inputs are deterministic for a seed so that they can be compared with a reference file
+  for (unsigned long i = 0; i < random_inputs; i++)
+  {
+    std::vector<uint8_t> input(rand_r(&seed) % FUZZ_RANDOM_INPUT_MAX_LEN);
+
+    for (size_t j = 0; j < input.size(); j++)
+    {
+      input[j] = (uint8_t)rand_r(&seed);
+    }
+
+    corpus.push_back(input);
+  }
+
+  if (corpus.empty())
+  {
+    print_usage();
+    return 1;
+  }
+
+  FILE* reffp = NULL;
+
+  if (write_path != NULL || compare_path != NULL)
+  {
+    reffp = fopen((write_path != NULL) ? write_path : compare_path, (write_path != NULL) ? "wb" : "rb");
+
+    if (reffp == NULL)
+    {
+      fprintf(stderr, "%s: failed to open\n", (write_path != NULL) ? write_path : compare_path);
+      return 1;
+    }
+  }
+
+  json_t* json = appd_iot_json_init();
+  std::vector<std::string> expected;
+  unsigned long mismatches = 0;
+  unsigned long long output_bytes = 0;
+  long long elapsed_ns = 0;
+
+  for (int r = 0; r < repeat; r++)
+  {
+    for (size_t i = 0; i < corpus.size(); i++)
+    {
+      long long start = get_time_ns();
+      const char* output = serialize(json, corpus[i].empty() ? NULL : &corpus[i][0], corpus[i].size(), &expected);
+
+      elapsed_ns += get_time_ns() - start;
+      output_bytes += strlen(output);
+
+      verify(output, expected);
+
+      if (r > 0 || reffp == NULL)
+      {
+        continue;
+      }
+
+      if (write_path != NULL && !write_reference(reffp, output))
+      {
+        fprintf(stderr, "%s: failed to write\n", write_path);
+        return 1;
+      }
+
+      if (compare_path != NULL && !compare_reference(reffp, output))
+      {
+        fprintf(stderr, "input %lu: output differs from reference: %s\n", (unsigned long)i, output);
+        mismatches++;
+      }
+    }
+  }
+
+  appd_iot_json_free(json);
+
+  if (reffp != NULL)
+  {
+    fclose(reffp);
+  }
+
+  unsigned long inputs = (unsigned long)corpus.size() * repeat;
+
+  fprintf(stdout, "{\"benchmark\":\"json_serializer_fuzzer\",\"inputs\":%lu,\"output_bytes\":%llu,"
+          "\"ns_per_input\":%lld,\"mb_per_sec\":%.2f,\"mismatches\":%lu}\n", inputs, output_bytes,
+          elapsed_ns / (long long)inputs, (elapsed_ns > 0) ? (output_bytes * 1000.0) / elapsed_ns : 0.0, mismatches);
+
+  return (mismatches == 0) ? 0 : 1;
+}
+
+#endif /* APPD_IOT_LIBFUZZER */
@@ -0,0 +1,564 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include "atomic.hpp"
+#include "json_validator.hpp"
+
+/**
+ * Loopback stand-in for the EUM collector, used to load test SDK and a transport end to end on a
+ * developer machine. Implements, on 127.0.0.1 over HTTP/1.1 with keep-alive:
+ *   POST /eumcollector/iot/v1/application/<appkey>/beacons : validates payload is a JSON array of
+ *        beacon objects, counts the events in it and responds 202, or 400 if payload is invalid
+ *   GET  /eumcollector/iot/v1/application/<appkey>/enabled : responds 200
+ * Latency and 5xx, 429 and 402 responses can be injected into beacon responses. Throughput is
+ * written to stderr once a second and totals on exit.
+ *
+ * Usage: loopback_collector [options]
+ *   -p <port>     port to listen on, default 9001
+ *   -l <ms>       latency added to each beacon response
+ *   -e <percent>  percent of beacons responded with 503
+ *   -t <percent>  percent of beacons responded with 429
+ *   -x <percent>  percent of beacons responded with 402
+ *   -d <seconds>  exit after given time, default runs until SIGINT or SIGTERM
+ *   -q            do not write throughput every second
+ */
+
+#define COLLECTOR_DEFAULT_PORT 9001
+#define COLLECTOR_URL_PREFIX "/eumcollector/iot/v1/application/"
+#define COLLECTOR_MAX_HEADER_SIZE (16 * 1024)
+#define COLLECTOR_MAX_BODY_SIZE (64 * 1024 * 1024)
+
+typedef struct
+{
+  int port;
+  int latency_ms;
+  int error_percent;
+  int too_many_requests_percent;
+  int payment_required_percent;
+  int duration_sec;
+  bool quiet;
+} collector_options_t;
+
+typedef struct
+{
+  uint64_t requests;
+  uint64_t beacons;
+  uint64_t events;
+  uint64_t bytes;
+  uint64_t invalid_beacons;
+  uint64_t injected_errors;
+} collector_stats_t;
+
+static collector_options_t global_options;
+static collector_stats_t global_stats;
+static volatile sig_atomic_t global_stop = 0;
+
+
+/**
+ * @brief Writes entire buffer to socket
+ * @return true on success
+ */
+static bool write_all(int fd, const char* buf, size_t len)
+{
+  while (len > 0)
+  {
+    ssize_t written = send(fd, buf, len, MSG_NOSIGNAL);
+
+    if (written < 0 && errno == EINTR)
+    {
+      continue;
+    }
+
+    if (written <= 0)
+    {
+      return false;
+    }
+
+    buf += written;
+    len -= written;
+  }
+
+  return true;
+}
+
+
+/**
+ * @brief Writes http response without content
+ * @return true on success
+ */
+static bool send_response(int fd, int resp_code, const char* reason, bool keep_alive)
+{
+  char resp[256];
+  int len = snprintf(resp, sizeof(resp), "HTTP/1.1 %d %s\r\nContent-Length: 0\r\nConnection: %s\r\n\r\n",
+                     resp_code, reason, keep_alive ? "keep-alive" : "close");
+
+  return write_all(fd, resp, len);
+}
+
+
+/**
+ * @brief Picks response code of a beacon, injecting errors at configured rates
+ * @param seed contains random seed of the connection
+ */
+static int pick_beacon_resp_code(unsigned int* seed)
+{
+  int percent = rand_r(seed) % 100;
+
+  if ((percent -= global_options.error_percent) < 0)
+  {
+    return 503;
+  }
+
+  if ((percent -= global_options.too_many_requests_percent) < 0)
+  {
+    return 429;
+  }
+
+  if ((percent -= global_options.payment_required_percent) < 0)
+  {
+    return 402;
+  }
+
+  return 202;
+}
+
+
+/**
+ * @brief Handles a request
+ * @return true if connection can be kept open
+ */
+static bool handle_request(int fd, const std::string& method, const std::string& path, const std::string& body,
+                           bool keep_alive, unsigned int* seed)
+{
+  appd_iot_atomic_fetch_add(&global_stats.requests, (uint64_t)1);
+
+  size_t suffix_pos = path.rfind('/');
+  std::string suffix = (suffix_pos != std::string::npos) ? path.substr(suffix_pos) : "";
+
+  if (path.compare(0, strlen(COLLECTOR_URL_PREFIX), COLLECTOR_URL_PREFIX) != 0 ||
+      suffix_pos <= strlen(COLLECTOR_URL_PREFIX))
+  {
+    return send_response(fd, 404, "Not Found", keep_alive) && keep_alive;
+  }
+
+  if (suffix == "/enabled" && method == "GET")
+  {
+    return send_response(fd, 200, "OK", keep_alive) && keep_alive;
+  }
+
+  if (suffix != "/beacons" || method != "POST")
+  {
+    return send_response(fd, 404, "Not Found", keep_alive) && keep_alive;
+  }
+
+  json_validator validator(body.data(), body.length());
+
+  if (!validator.validate())
+  {
+    appd_iot_atomic_fetch_add(&global_stats.invalid_beacons, (uint64_t)1);
+    return send_response(fd, 400, "Bad Request", keep_alive) && keep_alive;
+  }
+
+  if (global_options.latency_ms > 0)
+  {
+    usleep(global_options.latency_ms * 1000);
+  }
+
+  int resp_code = pick_beacon_resp_code(seed);
+
+  if (resp_code != 202)
+  {
+    appd_iot_atomic_fetch_add(&global_stats.injected_errors, (uint64_t)1);
+
+    const char* reason = (resp_code == 503) ? "Service Unavailable" :
+                         (resp_code == 429) ? "Too Many Requests" : "Payment Required";
+
+    return send_response(fd, resp_code, reason, keep_alive) && keep_alive;
+  }
+
+  appd_iot_atomic_fetch_add(&global_stats.beacons, (uint64_t)1);
+  appd_iot_atomic_fetch_add(&global_stats.events, validator.events());
+  appd_iot_atomic_fetch_add(&global_stats.bytes, (uint64_t)body.length());
+
+  return send_response(fd, 202, "Accepted", keep_alive) && keep_alive;
+}
+
+
+/**
+ * @brief Gets value of a header from request header block, matching name case insensitively
+ * @return true if header is present
+ */
+static bool get_header(const std::string& headers, const char* name, std::string* value)
+{
+  size_t name_len = strlen(name);
+  size_t pos = headers.find("\r\n");
+
+  while (pos != std::string::npos && pos + 2 < headers.length())
+  {
+    size_t start = pos + 2;
+    size_t end = headers.find("\r\n", start);
+
+    if (end == std::string::npos)
+    {
+      end = headers.length();
+    }
+
+    if (end - start > name_len && headers[start + name_len] == ':' &&
+        strncasecmp(headers.c_str() + start, name, name_len) == 0)
+    {
+      size_t value_start = headers.find_first_not_of(' ', start + name_len + 1);
+
+      value->assign(headers, value_start, (value_start < end) ? end - value_start : 0);
+      return true;
+    }
+
+    pos = (end < headers.length()) ? end : std::string::npos;
+  }
+
+  return false;
+}
+
+
+/**
+ * @brief Serves http requests of a connection until it is closed
+ * @param arg contains socket fd
+ */
+static void* connection_thread(void* arg)
+{
+  int fd = (int)(intptr_t)arg;
+  unsigned int seed = (unsigned int)time(NULL) ^ (unsigned int)fd;
+  std::string buf;
+  char chunk[64 * 1024];
+  bool open = true;
+
+  while (open && !global_stop)
+  {
+    size_t header_end;
+
+    while ((header_end = buf.find("\r\n\r\n")) == std::string::npos)
+    {
+      ssize_t len = recv(fd, chunk, sizeof(chunk), 0);
+
+      if (len < 0 && errno == EINTR)
+      {
+        continue;
+      }
+
+      if (len <= 0 || buf.length() > COLLECTOR_MAX_HEADER_SIZE)
+      {
+        close(fd);
+        return NULL;
+      }
+
+      buf.append(chunk, len);
+    }
+
+    std::string headers = buf.substr(0, header_end);
+    std::string method = headers.substr(0, headers.find(' '));
+    size_t path_start = method.length() + 1;
+    std::string path = headers.substr(path_start, headers.find(' ', path_start) - path_start);
+    std::string value;
+    size_t content_length = 0;
+    bool keep_alive = (headers.find("HTTP/1.1") != std::string::npos);
+
+    if (get_header(headers, "Connection", &value))
+    {
+      keep_alive = (strcasecmp(value.c_str(), "close") != 0);
+    }
+
+    if (get_header(headers, "Content-Length", &value))
+    {
+      content_length = strtoul(value.c_str(), NULL, 10);
+    }
+
+    if (content_length > COLLECTOR_MAX_BODY_SIZE)
+    {
+      send_response(fd, 413, "Payload Too Large", false);
+      break;
+    }
+
+    buf.erase(0, header_end + 4);
+
+    while (buf.length() < content_length)
+    {
+      ssize_t len = recv(fd, chunk, sizeof(chunk), 0);
+
+      if (len < 0 && errno == EINTR)
+      {
+        continue;
+      }
+
+      if (len <= 0)
+      {
+        close(fd);
+        return NULL;
+      }
+
+      buf.append(chunk, len);
+    }
+
+    std::string body = buf.substr(0, content_length);
+
+    buf.erase(0, content_length);
+
+    open = handle_request(fd, method, path, body, keep_alive, &seed);
+  }
+
+  close(fd);
+
+  return NULL;
+}
+
+
+/**
+ * @brief Writes throughput since previous report, or totals
+ * @param prev contains stats at previous report, updated with current stats
+ * @param elapsed_ms contains time since previous report
+ */
+static void report_stats(collector_stats_t* prev, long long elapsed_ms, const char* label)
+{
+  collector_stats_t curr;
+
+  curr.requests = appd_iot_atomic_load(&global_stats.requests);
+  curr.beacons = appd_iot_atomic_load(&global_stats.beacons);
+  curr.events = appd_iot_atomic_load(&global_stats.events);
+  curr.bytes = appd_iot_atomic_load(&global_stats.bytes);
+  curr.invalid_beacons = appd_iot_atomic_load(&global_stats.invalid_beacons);
+  curr.injected_errors = appd_iot_atomic_load(&global_stats.injected_errors);
+
+  if (elapsed_ms <= 0)
+  {
+    elapsed_ms = 1;
+  }
+
+  fprintf(stderr, "%s requests/s:%llu beacons/s:%llu events/s:%llu KB/s:%llu invalid:%llu injected errors:%llu\n",
+          label,
+          (unsigned long long)((curr.requests - prev->requests) * 1000 / elapsed_ms),
+          (unsigned long long)((curr.beacons - prev->beacons) * 1000 / elapsed_ms),
+          (unsigned long long)((curr.events - prev->events) * 1000 / elapsed_ms),
+          (unsigned long long)((curr.bytes - prev->bytes) * 1000 / 1024 / elapsed_ms),
+          (unsigned long long)(curr.invalid_beacons - prev->invalid_beacons),
+          (unsigned long long)(curr.injected_errors - prev->injected_errors));
+
+  *prev = curr;
+}
+
+
+/**
+ * @brief Accepts connections and starts a thread per connection
+ * @param arg contains listening socket fd
+ */
+static void* accept_thread(void* arg)
+{
+  int listen_fd = (int)(intptr_t)arg;
+
+  while (!global_stop)
+  {
+    int fd = accept(listen_fd, NULL, NULL);
+
+    if (fd < 0)
+    {
+      continue;
+    }
+
+    int nodelay = 1;
+    pthread_t thread;
+
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    if (pthread_create(&thread, NULL, &connection_thread, (void*)(intptr_t)fd) != 0)
+    {
+      close(fd);
+      continue;
+    }
+
+    pthread_detach(thread);
+  }
+
+  return NULL;
+}
+
+
+/**
+ * @brief Get monotonic time in milliseconds
+ */
+static long long get_time_ms(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+static void stop_handler(int signum)
+{
+  global_stop = 1;
+}
+
+
+/**
+ * @brief Reads a percentage option
+ */
+static bool read_percent(const char* arg, int* value)
+{
+  *value = atoi(arg);
+  return (*value >= 0 && *value <= 100);
+}
+
+
+static void print_usage(void)
+{
+  fprintf(stderr, "Usage: loopback_collector [-p port] [-l latency ms] [-e 503 percent] [-t 429 percent]\n"
+          "                          [-x 402 percent] [-d duration sec] [-q]\n");
+}
+
+
+int main(int argc, char* argv[])
+{
+  int opt;
+
+  global_options.port = COLLECTOR_DEFAULT_PORT;
+
+  while ((opt = getopt(argc, argv, "p:l:e:t:x:d:qh")) != -1)
+  {
+    bool valid = true;
+
+    switch (opt)
+    {
+      case 'p':
+        global_options.port = atoi(optarg);
+        valid = (global_options.port > 0 && global_options.port < 65536);
+        break;
+
+      case 'l':
+        global_options.latency_ms = atoi(optarg);
+        valid = (global_options.latency_ms >= 0);
+        break;
+
+      case 'e':
+        valid = read_percent(optarg, &global_options.error_percent);
+        break;
+
+      case 't':
+        valid = read_percent(optarg, &global_options.too_many_requests_percent);
+        break;
+
+      case 'x':
+        valid = read_percent(optarg, &global_options.payment_required_percent);
+        break;
+
+      case 'd':
+        global_options.duration_sec = atoi(optarg);
+        break;
+
+      case 'q':
+        global_options.quiet = true;
+        break;
+
+      default:
+        valid = false;
+        break;
+    }
+
+    if (!valid)
+    {
+      print_usage();
+      return 1;
+    }
+  }
+
+  int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  int reuse = 1;
+  struct sockaddr_in addr;
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(global_options.port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  if (listen_fd < 0 || bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(listen_fd, 128) != 0)
+  {
+    fprintf(stderr, "Failed to listen on 127.0.0.1:%d: %s\n", global_options.port, strerror(errno));
+    return 1;
+  }
+
+  signal(SIGINT, &stop_handler);
+  signal(SIGTERM, &stop_handler);
+  signal(SIGPIPE, SIG_IGN);
+
+  pthread_t thread;
+
+  if (pthread_create(&thread, NULL, &accept_thread, (void*)(intptr_t)listen_fd) != 0)
+  {
+    fprintf(stderr, "Failed to start accept thread\n");
+    return 1;
+  }
+
+  pthread_detach(thread);
+
+  fprintf(stderr, "Loopback collector listening on http://127.0.0.1:%d\n", global_options.port);
+
+  collector_stats_t prev, total;
+  long long start_ms = get_time_ms();
+  long long prev_ms = start_ms;
+
+  memset(&prev, 0, sizeof(prev));
+  memset(&total, 0, sizeof(total));
+
+  while (!global_stop)
+  {
+    sleep(1);
+
+    long long now_ms = get_time_ms();
+
+    if (!global_options.quiet)
+    {
+      report_stats(&prev, now_ms - prev_ms, "last 1s");
+    }
+
+    prev_ms = now_ms;
+
+    if (global_options.duration_sec > 0 && now_ms - start_ms >= global_options.duration_sec * 1000LL)
+    {
+      break;
+    }
+  }
+
+  report_stats(&total, get_time_ms() - start_ms, "total");
+
+  fprintf(stderr, "total beacons:%llu events:%llu\n", (unsigned long long)total.beacons,
+          (unsigned long long)total.events);
+
+  return 0;
+}
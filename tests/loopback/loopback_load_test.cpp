@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <curl/curl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <appd_iot_interface.h>
+#include "http_curl_interface.hpp"
+
+/**
+ * Load test which drives SDK and the curl transport of the sample app end to end against
+ * loopback_collector, or any collector, at high event rates. Adds custom events in batches and
+ * sends each batch, then writes event rate and SDK send statistics to stderr. The curl transport
+ * writes request details to stdout, which can be redirected to /dev/null.
+ *
+ * Usage: loopback_load_test [options]
+ *   -u <url>     collector url, default http://127.0.0.1:9001
+ *   -n <events>  total number of events, default 100000
+ *   -b <events>  events added before each send, default 200
+ *   -c <count>   beacons in flight at once. If greater than 1, batches are sent with
+ *                appd_iot_drain_all_events() using the curl multi transport, default 1
+ *   -s <events>  max events per beacon when draining, default 50
+ */
+
+#define LOAD_TEST_DEFAULT_URL "http://127.0.0.1:9001"
+
+
+/**
+ * @brief Get monotonic time in milliseconds
+ */
+static long long get_time_ms(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+/**
+ * @brief Get average of a latency histogram in microseconds
+ */
+static unsigned long long get_avg_us(const appd_iot_histogram_t* histogram)
+{
+  return (histogram->count > 0) ? (unsigned long long)(histogram->sum_us / histogram->count) : 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+  const char* url = LOAD_TEST_DEFAULT_URL;
+  long total_events = 100000;
+  int batch_events = 200;
+  int max_in_flight = 1;
+  int max_events_per_beacon = 50;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "u:n:b:c:s:h")) != -1)
+  {
+    switch (opt)
+    {
+      case 'u':
+        url = optarg;
+        break;
+
+      case 'n':
+        total_events = atol(optarg);
+        break;
+
+      case 'b':
+        batch_events = atoi(optarg);
+        break;
+
+      case 'c':
+        max_in_flight = atoi(optarg);
+        break;
+
+      case 's':
+        max_events_per_beacon = atoi(optarg);
+        break;
+
+      default:
+        fprintf(stderr, "Usage: loopback_load_test [-u url] [-n events] [-b events per send] "
+                "[-c beacons in flight] [-s events per beacon]\n");
+        return 1;
+    }
+  }
+
+  if (total_events <= 0 || batch_events <= 0 || max_in_flight <= 0 || max_events_per_beacon <= 0)
+  {
+    fprintf(stderr, "Event counts must be greater than 0\n");
+    return 1;
+  }
+
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = "LOAD-TEST-APP-KEY";
+  sdkcfg.eum_collector_url = url;
+  //events dropped while collector fails beacons are counted in sdk stats instead of being logged
+  sdkcfg.log_level = APPD_IOT_LOG_OFF;
+
+  devcfg.device_id = "1111";
+  devcfg.device_type = "SmartCar";
+  devcfg.device_name = "LoadTest";
+
+  curl_global_init(CURL_GLOBAL_ALL);
+
+  if ((retcode = appd_iot_init_sdk(sdkcfg, devcfg)) != APPD_IOT_SUCCESS)
+  {
+    fprintf(stderr, "Failed to initialize sdk:%s\n", appd_iot_error_code_to_str(retcode));
+    return 1;
+  }
+
+  appd_iot_http_cb_t http_cb;
+
+  http_cb.http_req_send_cb = &http_curl_req_send_cb;
+  http_cb.http_resp_done_cb = &http_curl_resp_done_cb;
+
+  appd_iot_register_network_interface(http_cb);
+
+  if (max_in_flight > 1)
+  {
+    appd_iot_http_pipeline_cb_t http_pipeline_cb;
+
+    http_pipeline_cb.http_req_send_batch_cb = &http_curl_req_send_batch_cb;
+    http_pipeline_cb.http_resp_done_cb = &http_curl_resp_done_cb;
+    http_pipeline_cb.max_requests_in_flight = max_in_flight;
+
+    appd_iot_register_network_pipeline_interface(http_pipeline_cb);
+  }
+
+  appd_iot_custom_event_t custom_event;
+  appd_iot_data_t custom_event_data[3];
+
+  appd_iot_init_to_zero(&custom_event, sizeof(custom_event));
+
+  custom_event.type = "SmartCar Data";
+  custom_event.summary = "Car Speed and Location";
+  custom_event.data_count = 3;
+  custom_event.data = custom_event_data;
+
+  appd_iot_data_set_string(&custom_event_data[1], "Location", "SFO Bay Area");
+  appd_iot_data_set_double(&custom_event_data[2], "Fuel Level", 0.6);
+
+  long failed_sends = 0;
+  long rejected_sends = 0;
+  long long start_ms = get_time_ms();
+
+  for (long added = 0; added < total_events;)
+  {
+    for (int i = 0; i < batch_events && added < total_events; i++, added++)
+    {
+      appd_iot_data_set_integer(&custom_event_data[0], "Speed mph", added % 100);
+      appd_iot_add_custom_event(custom_event);
+    }
+
+    retcode = (max_in_flight > 1) ? appd_iot_drain_all_events(max_events_per_beacon) : appd_iot_send_all_events();
+
+    if (retcode == APPD_IOT_ERR_NETWORK_REJECT)
+    {
+      //collector disabled sdk, check app status to enable it again
+      rejected_sends++;
+      appd_iot_check_app_status();
+    }
+    else if (retcode != APPD_IOT_SUCCESS)
+    {
+      failed_sends++;
+    }
+  }
+
+  //send events left in memory after failed sends
+  appd_iot_send_all_events();
+
+  long long elapsed_ms = get_time_ms() - start_ms;
+  appd_iot_stats_t stats;
+
+  appd_iot_get_stats(&stats);
+
+  if (elapsed_ms <= 0)
+  {
+    elapsed_ms = 1;
+  }
+
+  fprintf(stderr, "events added:%llu sent:%llu dropped:%llu in %lld ms, %lld events/s\n",
+          (unsigned long long)stats.custom_events_added, (unsigned long long)stats.events_sent,
+          (unsigned long long)stats.custom_events_dropped, elapsed_ms,
+          (long long)stats.events_sent * 1000 / elapsed_ms);
+  fprintf(stderr, "beacons sent:%llu failed:%llu, failed sends:%ld rejected sends:%ld, KB sent:%llu\n",
+          (unsigned long long)stats.beacons_sent, (unsigned long long)stats.beacon_send_failures,
+          failed_sends, rejected_sends, (unsigned long long)(stats.bytes_sent / 1024));
+  fprintf(stderr, "avg us per send - serialize:%llu transport:%llu response:%llu\n",
+          get_avg_us(&stats.serialize_latency), get_avg_us(&stats.transport_latency),
+          get_avg_us(&stats.response_latency));
+
+  http_curl_cleanup();
+  curl_global_cleanup();
+
+  return 0;
+}
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cgreen/cgreen.h>
+#include <appd_iot_interface.h>
+#include <stdlib.h>
+#include "alloc_tracker.hpp"
+#include "common_test.hpp"
+#include "http_mock_interface.hpp"
+
+using namespace cgreen;
+
+/*
+ * Allocation budgets of SDK API calls. A change which makes a call allocate more than its budget
+ * fails the test, lower the budget when a change makes a call allocate less.
+ */
+#define ALLOC_BUDGET_ADD_CUSTOM_EVENT 10
+#define ALLOC_BUDGET_ADD_NETWORK_EVENT 1
+#define ALLOC_BUDGET_ADD_ERROR_EVENT 7
+#define ALLOC_BUDGET_SEND_10_EVENTS 79
+
+Describe(alloc);
+BeforeEach(alloc) { }
+AfterEach(alloc) { }
+
+/**
+ * @brief Initializes SDK with logging off, so that only allocations of the API call are counted
+ */
+static void alloc_test_init_sdk(void)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  appd_iot_http_cb_t http_cb;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_level = APPD_IOT_LOG_OFF;
+
+  devcfg.device_id = "5555";
+  devcfg.device_type = "SmartCar";
+
+  assert_that(appd_iot_init_sdk(sdkcfg, devcfg), is_equal_to(APPD_IOT_SUCCESS));
+
+  http_cb.http_req_send_cb = &appd_iot_test_http_req_send_cb;
+  http_cb.http_resp_done_cb = &appd_iot_test_http_resp_done_cb;
+
+  assert_that(appd_iot_register_network_interface(http_cb), is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_clear_all_events();
+}
+
+/**
+ * @brief Unit Test for allocation tracker counting allocations of calling thread
+ */
+Ensure(alloc, counts_allocations_of_calling_thread)
+{
+  alloc_stats_t stats;
+  void* volatile ptr;
+
+  appd_iot_alloc_tracker_start();
+  ptr = malloc(100);
+  free(ptr);
+  ptr = calloc(2, 10);
+  free(ptr);
+  appd_iot_alloc_tracker_stop(&stats);
+
+  assert_that(stats.count, is_equal_to(2));
+  assert_that(stats.bytes, is_equal_to(120));
+
+  ptr = malloc(100);
+  free(ptr);
+
+  appd_iot_alloc_tracker_start();
+  appd_iot_alloc_tracker_stop(&stats);
+
+  assert_that(stats.count, is_equal_to(0));
+}
+
+/**
+ * @brief Unit Test for allocations made by adding a custom event with 4 properties
+ */
+Ensure(alloc, add_custom_event_allocates_within_budget)
+{
+  appd_iot_custom_event_t custom_event;
+  appd_iot_data_t data[4];
+  alloc_stats_t stats;
+
+  alloc_test_init_sdk();
+
+  appd_iot_init_to_zero(&custom_event, sizeof(custom_event));
+  custom_event.type = "Smart Car Reading";
+  custom_event.summary = "Events Captured in Smart Car";
+  custom_event.timestamp_ms = 1500000000000LL;
+  custom_event.data_count = 4;
+  custom_event.data = data;
+
+  appd_iot_data_set_integer(&data[0], "Speed mph", 65);
+  appd_iot_data_set_string(&data[1], "Location", "SFO Bay Area");
+  appd_iot_data_set_double(&data[2], "Fuel Level", 0.6);
+  appd_iot_data_set_boolean(&data[3], "Engine Lights ON", false);
+
+  //first event also makes one time allocations, such as per thread state
+  appd_iot_add_custom_event(custom_event);
+
+  appd_iot_alloc_tracker_start();
+  appd_iot_error_code_t retcode = appd_iot_add_custom_event(custom_event);
+  appd_iot_alloc_tracker_stop(&stats);
+
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+  assert_that(stats.count, is_less_than(ALLOC_BUDGET_ADD_CUSTOM_EVENT + 1));
+
+  appd_iot_clear_all_events();
+}
+
+/**
+ * @brief Unit Test for allocations made by adding a network request event with 2 response headers
+ */
+Ensure(alloc, add_network_event_allocates_within_budget)
+{
+  appd_iot_network_request_event_t network_event;
+  appd_iot_data_t resp_headers[2];
+  alloc_stats_t stats;
+
+  alloc_test_init_sdk();
+
+  appd_iot_init_to_zero(&network_event, sizeof(network_event));
+  network_event.url = "https://aws.amazon.com";
+  network_event.resp_code = 202;
+  network_event.duration_ms = 10;
+  network_event.req_content_length = 300;
+  network_event.resp_content_length = 100;
+  network_event.timestamp_ms = 1500000000000LL;
+  network_event.resp_headers_count = 2;
+  network_event.resp_headers = resp_headers;
+
+  appd_iot_data_set_string(&resp_headers[0], "Content-Type", "application/json");
+  appd_iot_data_set_string(&resp_headers[1], "Cache-Control", "no-cache");
+
+  appd_iot_add_network_request_event(network_event);
+
+  appd_iot_alloc_tracker_start();
+  appd_iot_error_code_t retcode = appd_iot_add_network_request_event(network_event);
+  appd_iot_alloc_tracker_stop(&stats);
+
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+  assert_that(stats.count, is_less_than(ALLOC_BUDGET_ADD_NETWORK_EVENT + 1));
+
+  appd_iot_clear_all_events();
+}
+
+/**
+ * @brief Unit Test for allocations made by adding an error event with a stack trace of 4 frames
+ */
+Ensure(alloc, add_error_event_allocates_within_budget)
+{
+  appd_iot_error_event_t error_event;
+  appd_iot_stack_trace_t stack_trace;
+  appd_iot_stack_frame_t stack_frames[4];
+  alloc_stats_t stats;
+
+  alloc_test_init_sdk();
+
+  appd_iot_init_to_zero(stack_frames, sizeof(stack_frames));
+
+  for (int i = 0; i < 4; i++)
+  {
+    stack_frames[i].symbol_name = "_sigtramp";
+    stack_frames[i].package_name = "libsystem_platform.dylib";
+    stack_frames[i].file_name = "main.cpp";
+    stack_frames[i].lineno = 100 + i;
+    stack_frames[i].absolute_addr = 0x00000001000082d1ULL;
+  }
+
+  stack_trace.thread = "main";
+  stack_trace.stack_frame = stack_frames;
+  stack_trace.stack_frame_count = 4;
+
+  appd_iot_init_to_zero(&error_event, sizeof(error_event));
+  error_event.name = "Out of Memory";
+  error_event.message = "Memory allocation failed";
+  error_event.severity = APPD_IOT_ERR_SEVERITY_FATAL;
+  error_event.timestamp_ms = 1500000000000LL;
+  error_event.stack_trace_count = 1;
+  error_event.stack_trace = &stack_trace;
+
+  appd_iot_add_error_event(error_event);
+
+  appd_iot_alloc_tracker_start();
+  appd_iot_error_code_t retcode = appd_iot_add_error_event(error_event);
+  appd_iot_alloc_tracker_stop(&stats);
+
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+  assert_that(stats.count, is_less_than(ALLOC_BUDGET_ADD_ERROR_EVENT + 1));
+
+  appd_iot_clear_all_events();
+}
+
+/**
+ * @brief Unit Test for allocations made by sending 10 custom events, including mock transport
+ */
+Ensure(alloc, send_all_events_allocates_within_budget)
+{
+  appd_iot_custom_event_t custom_event;
+  alloc_stats_t stats;
+
+  alloc_test_init_sdk();
+
+  appd_iot_init_to_zero(&custom_event, sizeof(custom_event));
+  custom_event.type = "Smart Car Reading";
+  custom_event.summary = "Events Captured in Smart Car";
+  custom_event.timestamp_ms = 1500000000000LL;
+
+  //first send warms up payload buffer of mock transport, so that its size does not depend on earlier tests
+  for (int send = 0; send < 2; send++)
+  {
+    for (int i = 0; i < 10; i++)
+    {
+      appd_iot_add_custom_event(custom_event);
+    }
+
+    appd_iot_set_response_code(202);
+
+    if (send == 0)
+    {
+      appd_iot_send_all_events();
+    }
+  }
+
+  appd_iot_alloc_tracker_start();
+  appd_iot_error_code_t retcode = appd_iot_send_all_events();
+  appd_iot_alloc_tracker_stop(&stats);
+
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+  assert_that(stats.count, is_less_than(ALLOC_BUDGET_SEND_10_EVENTS + 1));
+}
+
+
+TestSuite* alloc_tests()
+{
+  TestSuite* suite = create_test_suite();
+
+  add_test_with_context(suite, alloc, counts_allocations_of_calling_thread);
+  add_test_with_context(suite, alloc, add_custom_event_allocates_within_budget);
+  add_test_with_context(suite, alloc, add_network_event_allocates_within_budget);
+  add_test_with_context(suite, alloc, add_error_event_allocates_within_budget);
+  add_test_with_context(suite, alloc, send_all_events_allocates_within_budget);
+
+  return suite;
+}
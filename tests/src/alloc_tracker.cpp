@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stddef.h>
+#include "alloc_tracker.hpp"
+
+/* glibc entry points of the allocator, called by the interposed functions below */
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t nmemb, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static __thread bool alloc_tracker_enabled = false;
+static __thread uint64_t alloc_tracker_count = 0;
+static __thread uint64_t alloc_tracker_bytes = 0;
+static __thread bool alloc_tracker_calloc_fails = false;
+
+
+/**
+ * @brief Counts an allocation if tracking is on for the calling thread
+ */
+static inline void alloc_tracker_count_alloc(size_t size)
+{
+  if (alloc_tracker_enabled)
+  {
+    alloc_tracker_count++;
+    alloc_tracker_bytes += size;
+  }
+}
+
+
+extern "C" void* malloc(size_t size)
+{
+  alloc_tracker_count_alloc(size);
+
+  return __libc_malloc(size);
+}
+
+
+extern "C" void* calloc(size_t nmemb, size_t size)
+{
+  if (alloc_tracker_calloc_fails)
+  {
+    return NULL;
+  }
+
+  alloc_tracker_count_alloc(nmemb * size);
+
+  return __libc_calloc(nmemb, size);
+}
+
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+  if (size > 0)
+  {
+    alloc_tracker_count_alloc(size);
+  }
+
+  return __libc_realloc(ptr, size);
+}
+
+
+/**
+ * @brief Starts counting allocations made by the calling thread
+ */
+void appd_iot_alloc_tracker_start(void)
+{
+  alloc_tracker_count = 0;
+  alloc_tracker_bytes = 0;
+  alloc_tracker_enabled = true;
+}
+
+
+/**
+ * @brief Stops counting allocations made by the calling thread
+ * @param stats to which allocations made since start are written
+ */
+void appd_iot_alloc_tracker_stop(alloc_stats_t* stats)
+{
+  alloc_tracker_enabled = false;
+
+  stats->count = alloc_tracker_count;
+  stats->bytes = alloc_tracker_bytes;
+}
+
+
+/**
+ * @brief Makes calloc calls of the calling thread fail
+ * @param fail is true to make calloc return NULL, false to restore it
+ */
+void appd_iot_alloc_tracker_fail_calloc(bool fail)
+{
+  alloc_tracker_calloc_fails = fail;
+}
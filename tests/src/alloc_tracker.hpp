@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ALLOC_TRACKER_H
+#define _ALLOC_TRACKER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Allocations made by a thread while tracking was on
+ */
+typedef struct
+{
+  uint64_t count;   /* Number of malloc, calloc and realloc calls */
+  uint64_t bytes;   /* Bytes requested by those calls */
+} alloc_stats_t;
+
+/**
+ * @brief Starts counting allocations made by the calling thread. <br>
+ * The tests executable interposes malloc, calloc and realloc, which also counts allocations made
+ * by operator new and by the SDK shared library.
+ */
+void appd_iot_alloc_tracker_start(void);
+
+/**
+ * @brief Stops counting allocations made by the calling thread
+ * @param stats to which allocations made since start are written
+ */
+void appd_iot_alloc_tracker_stop(alloc_stats_t* stats);
+
+/**
+ * @brief Makes calloc calls of the calling thread fail, to test handling of allocation failures. <br>
+ * JSON serializer allocates its buffers with calloc, while operator new uses malloc and keeps working.
+ * @param fail is true to make calloc return NULL, false to restore it
+ */
+void appd_iot_alloc_tracker_fail_calloc(bool fail);
+
+#endif /* _ALLOC_TRACKER_H */
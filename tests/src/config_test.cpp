@@ -16,8 +16,11 @@
 
 #include <cgreen/cgreen.h>
 #include <appd_iot_interface.h>
+#include <pthread.h>
+#include <string.h>
 #include "common_test.hpp"
 #include "log_mock_interface.hpp"
+#include "config.hpp"
 
 using namespace cgreen;
 
@@ -165,6 +168,115 @@ Ensure(config, returns_error_on_null_appd_iot_dev_config)
   assert_that(appd_iot_is_log_write_cb_success(), is_equal_to(true));
 }
 
+#define TEST_CONFIG_REINIT_COUNT 2000
+
+/**
+ * @brief Re-initializes sdk repeatedly, alternating log level and collector url
+ */
+static void* appd_iot_reinit_sdk_thread(void* arg)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  devcfg.device_id = "1111";
+  devcfg.device_type = "SmartCar";
+
+  for (int i = 0; i < TEST_CONFIG_REINIT_COUNT; i++)
+  {
+    sdkcfg.log_level = (i % 2) ? APPD_IOT_LOG_WARN : APPD_IOT_LOG_ERROR;
+    sdkcfg.eum_collector_url = (i % 2) ? "http://localhost:9001" : "http://localhost:9002";
+
+    appd_iot_init_sdk(sdkcfg, devcfg);
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Unit Test for config reads while sdk is re-initialized from another thread
+ */
+Ensure(config, reads_consistent_config_during_reinit)
+{
+  pthread_t reinit_thread;
+  int invalid_reads = 0;
+
+  assert_that(pthread_create(&reinit_thread, NULL, &appd_iot_reinit_sdk_thread, NULL), is_equal_to(0));
+
+  for (int i = 0; i < TEST_CONFIG_REINIT_COUNT * 10; i++)
+  {
+    appd_iot_log_level_t log_level = appd_iot_get_log_level();
+    std::string url = appd_iot_get_eum_collector_url();
+
+    if (log_level != APPD_IOT_LOG_OFF && log_level != APPD_IOT_LOG_ERROR && log_level != APPD_IOT_LOG_WARN)
+    {
+      invalid_reads++;
+    }
+
+    if (!url.empty() && url.compare(0, strlen("http://localhost:900"), "http://localhost:900") != 0)
+    {
+      invalid_reads++;
+    }
+  }
+
+  pthread_join(reinit_thread, NULL);
+
+  assert_that(invalid_reads, is_equal_to(0));
+  assert_that(appd_iot_get_sdk_state(), is_equal_to(APPD_IOT_SDK_ENABLED));
+}
+
+/**
+ * @brief Unit Test for failed init leaving config of previous init in place
+ */
+Ensure(config, keeps_config_on_failed_init)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = "http://localhost:9001";
+  sdkcfg.log_write_cb = &appd_iot_log_write_cb;
+  sdkcfg.log_level = APPD_IOT_LOG_WARN;
+
+  devcfg.device_id = "1111";
+  devcfg.device_type = "SmartCar";
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  std::string url = appd_iot_get_eum_collector_url();
+
+  //init with new log level and url fails on NULL appkey, nothing of it is applied
+  sdkcfg.appkey = NULL;
+  sdkcfg.eum_collector_url = "http://localhost:9002";
+  sdkcfg.log_level = APPD_IOT_LOG_ERROR;
+
+  appd_iot_clear_log_write_cb_flags();
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_ERR_INVALID_INPUT));
+  assert_that(appd_iot_is_log_write_cb_success(), is_equal_to(true));
+
+  assert_that(appd_iot_get_log_level(), is_equal_to(APPD_IOT_LOG_WARN));
+  assert_that(appd_iot_get_eum_collector_url().c_str(), is_equal_to_string(url.c_str()));
+
+  //same for NULL device type
+  sdkcfg.appkey = TEST_APP_KEY;
+  devcfg.device_type = NULL;
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_ERR_INVALID_INPUT));
+
+  assert_that(appd_iot_get_log_level(), is_equal_to(APPD_IOT_LOG_WARN));
+  assert_that(appd_iot_get_eum_collector_url().c_str(), is_equal_to_string(url.c_str()));
+}
+
 TestSuite* config_tests()
 {
 
@@ -174,6 +286,8 @@ TestSuite* config_tests()
   add_test_with_context(suite, config, returns_success_on_minimal_appd_iot_config);
   add_test_with_context(suite, config, returns_error_on_null_appd_iot_sdk_config);
   add_test_with_context(suite, config, returns_error_on_null_appd_iot_dev_config);
+  add_test_with_context(suite, config, reads_consistent_config_during_reinit);
+  add_test_with_context(suite, config, keeps_config_on_failed_init);
 
   return suite;
 }
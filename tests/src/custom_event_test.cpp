@@ -17,6 +17,8 @@
 #include <cgreen/cgreen.h>
 #include <appd_iot_interface.h>
 #include <time.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include "common_test.hpp"
 #include "http_mock_interface.hpp"
@@ -426,6 +428,133 @@ Ensure(custom_event, check_for_null_fields_appd_iot_add_custom_event)
   assert_that(appd_iot_is_log_write_cb_success(), is_equal_to(true));
 }
 
+/**
+ * @brief Unit Test for SDK health custom event added with events sent, at most once per interval
+ */
+Ensure(custom_event, adds_sdk_health_event_once_per_interval)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  appd_iot_stats_t before, after;
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_write_cb = &appd_iot_log_write_cb;
+  sdkcfg.log_level = APPD_IOT_LOG_ERROR;
+  sdkcfg.health_event_interval_ms = 60 * 60 * 1000;
+
+  devcfg.device_id = "5555";
+  devcfg.device_type = "SmartCar";
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_http_cb_t http_cb;
+  http_cb.http_req_send_cb = &appd_iot_test_http_req_send_cb;
+  http_cb.http_resp_done_cb = &appd_iot_test_http_resp_done_cb;
+
+  retcode = appd_iot_register_network_interface(http_cb);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_clear_all_events();
+  appd_iot_get_stats(&before);
+
+  appd_iot_custom_event_t custom_event;
+
+  appd_iot_init_to_zero(&custom_event, sizeof(custom_event));
+  custom_event.type = "Smart Car Reading";
+  custom_event.summary = "Events Captured in Smart Car";
+
+  //health event is sent with the first send
+  retcode = appd_iot_add_custom_event(custom_event);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_set_response_code(202);
+  retcode = appd_iot_send_all_events();
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_get_stats(&after);
+  assert_that(after.events_sent - before.events_sent, is_equal_to(2));
+
+  //and not again within the interval
+  retcode = appd_iot_add_custom_event(custom_event);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_set_response_code(202);
+  retcode = appd_iot_drain_all_events(10);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_get_stats(&after);
+  assert_that(after.events_sent - before.events_sent, is_equal_to(3));
+}
+
+/**
+ * @brief Unit Test for custom event without timestamp, which is sent with the time it is added
+ */
+Ensure(custom_event, sends_time_of_add_as_timestamp_of_event_without_timestamp)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_write_cb = &appd_iot_log_write_cb;
+  sdkcfg.log_level = APPD_IOT_LOG_ERROR;
+
+  devcfg.device_id = "5555";
+  devcfg.device_type = "SmartCar";
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_http_cb_t http_cb;
+  http_cb.http_req_send_cb = &appd_iot_test_http_req_send_cb;
+  http_cb.http_resp_done_cb = &appd_iot_test_http_resp_done_cb;
+
+  retcode = appd_iot_register_network_interface(http_cb);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_clear_all_events();
+
+  appd_iot_custom_event_t custom_event;
+
+  appd_iot_init_to_zero(&custom_event, sizeof(custom_event));
+  custom_event.type = "Smart Car Reading";
+  custom_event.timestamp_ms = 0;
+
+  int64_t before_ms = appd_iot_get_time_ms();
+
+  retcode = appd_iot_add_custom_event(custom_event);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  int64_t after_ms = appd_iot_get_time_ms();
+
+  appd_iot_set_response_code(202);
+  retcode = appd_iot_send_all_events();
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  const char* data = appd_iot_get_last_http_req_data();
+  const char* timestamp = (data != NULL) ? strstr(data, "\"timestamp\":") : NULL;
+
+  assert_that(timestamp != NULL, is_equal_to(true));
+
+  if (timestamp != NULL)
+  {
+    int64_t timestamp_ms = atoll(timestamp + strlen("\"timestamp\":"));
+
+    assert_that(timestamp_ms, is_greater_than(before_ms - 1));
+    assert_that(timestamp_ms, is_less_than(after_ms + 1));
+  }
+}
+
 
 TestSuite* custom_event_tests()
 {
@@ -436,6 +565,8 @@ TestSuite* custom_event_tests()
   add_test_with_context(suite, custom_event, returns_success_on_minimal_appd_iot_add_and_send_custom_event);
   add_test_with_context(suite, custom_event, test_minimal_device_config);
   add_test_with_context(suite, custom_event, check_for_null_fields_appd_iot_add_custom_event);
+  add_test_with_context(suite, custom_event, adds_sdk_health_event_once_per_interval);
+  add_test_with_context(suite, custom_event, sends_time_of_add_as_timestamp_of_event_without_timestamp);
 
   return suite;
 }
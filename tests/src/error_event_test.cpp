@@ -16,6 +16,7 @@
 
 #include <cgreen/cgreen.h>
 #include <appd_iot_interface.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 #include "common_test.hpp"
@@ -335,6 +336,90 @@ Ensure(error_event, test_full_fatal_error_event)
 }
 
 
+/**
+ * @brief Unit Test for error event with multiple stack traces. Each stack trace is serialized
+ * with its own thread and frames, in the order given.
+ */
+Ensure(error_event, test_multiple_stack_traces_error_event)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_write_cb = &appd_iot_log_write_cb;
+  sdkcfg.log_level = APPD_IOT_LOG_ALL;
+
+  devcfg.device_id = "1111";
+  devcfg.device_type = "SmartCar";
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_stack_frame_t main_frames[1];
+  appd_iot_stack_frame_t worker_frames[2];
+  appd_iot_stack_trace_t stack_traces[2];
+  appd_iot_error_event_t error_event;
+
+  appd_iot_init_to_zero(main_frames, sizeof(main_frames));
+  appd_iot_init_to_zero(worker_frames, sizeof(worker_frames));
+  appd_iot_init_to_zero(stack_traces, sizeof(stack_traces));
+
+  main_frames[0].symbol_name = "main_loop";
+  worker_frames[0].symbol_name = "worker_write";
+  worker_frames[1].symbol_name = "worker_flush";
+
+  stack_traces[0].thread = "main";
+  stack_traces[0].stack_frame_count = 1;
+  stack_traces[0].stack_frame = main_frames;
+
+  stack_traces[1].thread = "worker";
+  stack_traces[1].stack_frame_count = 2;
+  stack_traces[1].stack_frame = worker_frames;
+
+  appd_iot_init_to_zero(&error_event, sizeof(error_event));
+
+  error_event.name = "Deadlock";
+  error_event.severity = APPD_IOT_ERR_SEVERITY_FATAL;
+  error_event.timestamp_ms = ((int64_t)time(NULL) * 1000);
+  error_event.stack_trace_count = 2;
+  error_event.error_stack_trace_index = 1;
+  error_event.stack_trace = stack_traces;
+
+  retcode = appd_iot_add_error_event(error_event);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_http_cb_t http_cb;
+  http_cb.http_req_send_cb = &appd_iot_test_http_req_send_cb;
+  http_cb.http_resp_done_cb = &appd_iot_test_http_resp_done_cb;
+
+  retcode = appd_iot_register_network_interface(http_cb);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_set_response_code(202);
+
+  retcode = appd_iot_send_all_events();
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  const char* data = appd_iot_get_last_http_req_data();
+  const char* main_thread = strstr(data, "\"thread\":\"main\"");
+  const char* main_loop = strstr(data, "\"main_loop\"");
+  const char* worker_thread = strstr(data, "\"thread\":\"worker\"");
+  const char* worker_write = strstr(data, "\"worker_write\"");
+  const char* worker_flush = strstr(data, "\"worker_flush\"");
+
+  assert_that(strstr(data, "\"errorStackTraceIndex\":1") != NULL, is_equal_to(true));
+  assert_that(main_thread != NULL && main_loop != NULL && worker_thread != NULL &&
+              worker_write != NULL && worker_flush != NULL, is_equal_to(true));
+  assert_that(main_thread < main_loop && main_loop < worker_thread && worker_thread < worker_write &&
+              worker_write < worker_flush, is_equal_to(true));
+}
+
+
 /**
  * @brief Unit Test for null error event
  */
@@ -449,6 +534,7 @@ TestSuite* error_event_tests()
   add_test_with_context(suite, error_event, test_full_alert_and_critical_error_event);
   add_test_with_context(suite, error_event, test_minimal_alert_and_critical_error_event);
   add_test_with_context(suite, error_event, test_full_fatal_error_event);
+  add_test_with_context(suite, error_event, test_multiple_stack_traces_error_event);
   add_test_with_context(suite, error_event, test_null_error_event);
 
   return suite;
@@ -16,8 +16,10 @@
 
 #include <cgreen/cgreen.h>
 #include <appd_iot_interface.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include "alloc_tracker.hpp"
 #include "common_test.hpp"
 #include "http_mock_interface.hpp"
 #include "log_mock_interface.hpp"
@@ -140,6 +142,8 @@ Ensure(http_interface, returns_failure_on_bad_appd_iot_http_response)
   appd_iot_device_config_t devcfg;
   appd_iot_error_code_t retcode;
 
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+
   sdkcfg.appkey = TEST_APP_KEY;
   sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
   sdkcfg.log_write_cb = &appd_iot_log_write_cb;
@@ -275,6 +279,8 @@ Ensure(http_interface, check_appd_iot_sdk_disabled_data_limit)
   appd_iot_device_config_t devcfg;
   appd_iot_error_code_t retcode;
 
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+
   sdkcfg.appkey = TEST_APP_KEY;
   sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
   sdkcfg.log_write_cb = &appd_iot_log_write_cb;
@@ -345,6 +351,8 @@ Ensure(http_interface, check_appd_iot_sdk_disabled_license_expired)
   appd_iot_device_config_t devcfg;
   appd_iot_error_code_t retcode;
 
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+
   sdkcfg.appkey = TEST_APP_KEY;
   sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
   sdkcfg.log_write_cb = &appd_iot_log_write_cb;
@@ -415,6 +423,8 @@ Ensure(http_interface, check_appd_iot_sdk_disabled_kill_switch_and_enabled)
   appd_iot_device_config_t devcfg;
   appd_iot_error_code_t retcode;
 
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+
   sdkcfg.appkey = TEST_APP_KEY;
   sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
   sdkcfg.log_write_cb = &appd_iot_log_write_cb;
@@ -548,6 +558,417 @@ Ensure(http_interface, check_appd_iot_sdk_disabled_kill_switch_and_enabled)
   free(resp_headers);
 }
 
+/**
+ * @brief Initializes sdk and adds given number of custom events for drain tests
+ * @param num_events contains number of custom events to be added
+ * @param serialize_on_add indicates if events are serialized when added
+ */
+static void appd_iot_init_sdk_with_custom_events(int num_events, bool serialize_on_add = false)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_write_cb = &appd_iot_log_write_cb;
+  sdkcfg.sdk_state_change_cb = &appd_iot_mock_sdk_state_change_cb;
+  sdkcfg.log_level = APPD_IOT_LOG_ALL;
+  sdkcfg.serialize_on_add = serialize_on_add;
+
+  devcfg.device_id = "5555";
+  devcfg.device_type = "SmartCar";
+  devcfg.device_name = "AudiS3";
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_custom_event_t custom_event;
+
+  appd_iot_init_to_zero(&custom_event, sizeof(appd_iot_custom_event_t));
+
+  custom_event.type = "Smart Car Reading";
+  custom_event.summary = "Events Captured in Smart Car";
+  custom_event.timestamp_ms = ((int64_t)time(NULL) * 1000);
+
+  for (int i = 0; i < num_events; i++)
+  {
+    retcode = appd_iot_add_custom_event(custom_event);
+    assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+  }
+}
+
+/**
+ * @brief Unit Test for draining events as multiple beacons in flight
+ */
+Ensure(http_interface, drains_events_as_pipelined_beacons)
+{
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_sdk_with_custom_events(5);
+
+  //test for invalid pipeline interface
+  appd_iot_http_pipeline_cb_t http_pipeline_cb;
+  http_pipeline_cb.http_req_send_batch_cb = &appd_iot_test_http_req_send_batch_cb;
+  http_pipeline_cb.http_resp_done_cb = &appd_iot_test_http_batch_resp_done_cb;
+  http_pipeline_cb.max_requests_in_flight = 0;
+
+  retcode = appd_iot_register_network_pipeline_interface(http_pipeline_cb);
+  assert_that(retcode, is_equal_to(APPD_IOT_ERR_INVALID_INPUT));
+
+  http_pipeline_cb.max_requests_in_flight = 2;
+
+  retcode = appd_iot_register_network_pipeline_interface(http_pipeline_cb);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  //test for invalid max events per beacon
+  retcode = appd_iot_drain_all_events(0);
+  assert_that(retcode, is_equal_to(APPD_IOT_ERR_INVALID_INPUT));
+
+  //5 events with 2 events per beacon are sent as 3 beacons, 2 beacons at a time
+  appd_iot_clear_http_batch_counters();
+
+  retcode = appd_iot_drain_all_events(2);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  assert_that(appd_iot_get_http_req_send_batch_cb_count(), is_equal_to(2));
+  assert_that(appd_iot_get_http_batch_req_count(), is_equal_to(3));
+  assert_that(appd_iot_get_http_batch_max_events_per_req(), is_equal_to(2));
+  assert_that(appd_iot_get_http_batch_events_acked_count(), is_equal_to(5));
+  assert_that(appd_iot_get_http_batch_resp_done_count(), is_equal_to(3));
+
+  //test for no events
+  retcode = appd_iot_drain_all_events(2);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  assert_that(appd_iot_get_http_req_send_batch_cb_count(), is_equal_to(2));
+}
+
+/**
+ * @brief Unit Test for events of a batch which fails to be serialized being kept in memory while draining
+ */
+Ensure(http_interface, keeps_events_on_drain_serialization_failure)
+{
+  appd_iot_error_code_t retcode;
+  appd_iot_stats_t before, after;
+
+  appd_iot_init_sdk_with_custom_events(5);
+
+  appd_iot_http_pipeline_cb_t http_pipeline_cb;
+  http_pipeline_cb.http_req_send_batch_cb = &appd_iot_test_http_req_send_batch_cb;
+  http_pipeline_cb.http_resp_done_cb = &appd_iot_test_http_batch_resp_done_cb;
+  http_pipeline_cb.max_requests_in_flight = 2;
+
+  retcode = appd_iot_register_network_pipeline_interface(http_pipeline_cb);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_clear_http_batch_counters();
+  appd_iot_get_stats(&before);
+
+  //beacon json cannot be allocated, nothing is sent
+  appd_iot_alloc_tracker_fail_calloc(true);
+  retcode = appd_iot_drain_all_events(2);
+  appd_iot_alloc_tracker_fail_calloc(false);
+
+  assert_that(retcode, is_equal_to(APPD_IOT_ERR_NULL_PTR));
+  assert_that(appd_iot_get_http_req_send_batch_cb_count(), is_equal_to(0));
+
+  //all events are kept and sent by next drain
+  retcode = appd_iot_drain_all_events(2);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_get_stats(&after);
+
+  assert_that(appd_iot_get_http_batch_req_count(), is_equal_to(3));
+  assert_that(appd_iot_get_http_batch_events_acked_count(), is_equal_to(5));
+  assert_that(after.events_sent - before.events_sent, is_equal_to(5));
+
+  //test for no events left
+  retcode = appd_iot_drain_all_events(2);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+  assert_that(appd_iot_get_http_batch_req_count(), is_equal_to(3));
+}
+
+/**
+ * @brief Unit Test for events of failed beacons being kept in memory while draining
+ */
+Ensure(http_interface, keeps_events_of_failed_beacons_on_drain)
+{
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_sdk_with_custom_events(5);
+
+  appd_iot_http_pipeline_cb_t http_pipeline_cb;
+  http_pipeline_cb.http_req_send_batch_cb = &appd_iot_test_http_req_send_batch_cb;
+  http_pipeline_cb.http_resp_done_cb = &appd_iot_test_http_batch_resp_done_cb;
+  http_pipeline_cb.max_requests_in_flight = 4;
+
+  retcode = appd_iot_register_network_pipeline_interface(http_pipeline_cb);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  //second of three beacons fails, other beacons are acknowledged independently
+  int resp_codes[] = {202, 500, 202};
+
+  appd_iot_clear_http_batch_counters();
+  appd_iot_set_batch_response_codes(3, resp_codes);
+
+  retcode = appd_iot_drain_all_events(2);
+  assert_that(retcode, is_equal_to(APPD_IOT_ERR_NETWORK_ERROR));
+
+  assert_that(appd_iot_get_http_req_send_batch_cb_count(), is_equal_to(1));
+  assert_that(appd_iot_get_http_batch_req_count(), is_equal_to(3));
+  assert_that(appd_iot_get_http_batch_events_acked_count(), is_equal_to(3));
+  assert_that(appd_iot_get_http_batch_resp_done_count(), is_equal_to(3));
+
+  //events of failed beacon are sent on next drain
+  retcode = appd_iot_drain_all_events(2);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  assert_that(appd_iot_get_http_batch_req_count(), is_equal_to(4));
+  assert_that(appd_iot_get_http_batch_events_acked_count(), is_equal_to(5));
+
+  //test for app disabled response (429), remaining events are cleared
+  appd_iot_custom_event_t custom_event;
+
+  appd_iot_init_to_zero(&custom_event, sizeof(appd_iot_custom_event_t));
+
+  custom_event.type = "Smart Car Reading";
+  custom_event.timestamp_ms = ((int64_t)time(NULL) * 1000);
+
+  for (int i = 0; i < 3; i++)
+  {
+    retcode = appd_iot_add_custom_event(custom_event);
+    assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+  }
+
+  resp_codes[0] = 429;
+
+  appd_iot_clear_http_batch_counters();
+  appd_iot_set_batch_response_codes(1, resp_codes);
+
+  retcode = appd_iot_drain_all_events(1);
+  assert_that(retcode, is_equal_to(APPD_IOT_ERR_NETWORK_REJECT));
+
+  assert_that(appd_iot_get_http_batch_req_count(), is_equal_to(3));
+  assert_that(appd_iot_get_http_batch_events_acked_count(), is_equal_to(2));
+  assert_that(appd_iot_mock_get_sdk_state(), is_equal_to(APPD_IOT_SDK_DISABLED_DATA_LIMIT_EXCEEDED));
+
+  //no events left in memory and sdk is disabled
+  retcode = appd_iot_drain_all_events(1);
+  assert_that(retcode, is_equal_to(APPD_IOT_ERR_SDK_NOT_ENABLED));
+}
+
+/**
+ * @brief Unit Test for drain sending oldest events first, whatever their type, and keeping
+ * that order for events of failed beacons
+ */
+Ensure(http_interface, drains_oldest_events_of_any_type_first)
+{
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_sdk_with_custom_events(0);
+
+  appd_iot_network_request_event_t network_event;
+
+  appd_iot_init_to_zero(&network_event, sizeof(network_event));
+  network_event.url = "https://api.smartcar.com";
+  network_event.resp_code = 200;
+  network_event.timestamp_ms = ((int64_t)time(NULL) * 1000);
+
+  retcode = appd_iot_add_network_request_event(network_event);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_custom_event_t custom_event;
+
+  appd_iot_init_to_zero(&custom_event, sizeof(custom_event));
+  custom_event.type = "Smart Car Reading";
+  custom_event.timestamp_ms = ((int64_t)time(NULL) * 1000);
+
+  retcode = appd_iot_add_custom_event(custom_event);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_http_pipeline_cb_t http_pipeline_cb;
+  http_pipeline_cb.http_req_send_batch_cb = &appd_iot_test_http_req_send_batch_cb;
+  http_pipeline_cb.http_resp_done_cb = &appd_iot_test_http_batch_resp_done_cb;
+  http_pipeline_cb.max_requests_in_flight = 1;
+
+  retcode = appd_iot_register_network_pipeline_interface(http_pipeline_cb);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  //network event was added first, so it is sent first, although custom events come first in a beacon
+  int resp_codes[] = {500};
+
+  appd_iot_clear_http_batch_counters();
+  appd_iot_set_batch_response_codes(1, resp_codes);
+
+  retcode = appd_iot_drain_all_events(1);
+  assert_that(retcode, is_equal_to(APPD_IOT_ERR_NETWORK_ERROR));
+
+  assert_that(appd_iot_get_http_batch_req_count(), is_equal_to(1));
+  assert_that(strstr(appd_iot_get_last_http_req_data(), "networkRequestEvents") != NULL, is_equal_to(true));
+  assert_that(strstr(appd_iot_get_last_http_req_data(), "customEvents") == NULL, is_equal_to(true));
+
+  //network event of failed beacon is kept ahead of custom event
+  appd_iot_clear_http_batch_counters();
+
+  retcode = appd_iot_drain_all_events(1);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  assert_that(appd_iot_get_http_batch_req_count(), is_equal_to(2));
+  assert_that(appd_iot_get_http_batch_events_acked_count(), is_equal_to(2));
+  assert_that(strstr(appd_iot_get_last_http_req_data(), "customEvents") != NULL, is_equal_to(true));
+}
+
+/**
+ * @brief Adds a custom event with properties, a network request event and an error event with a stack trace
+ * @param timestamp_ms contains timestamp of the events
+ */
+static void appd_iot_add_events_of_all_types(int64_t timestamp_ms)
+{
+  appd_iot_error_code_t retcode;
+  appd_iot_custom_event_t custom_event;
+  appd_iot_data_t custom_event_data[2];
+
+  appd_iot_init_to_zero(&custom_event, sizeof(custom_event));
+  appd_iot_data_set_string(&custom_event_data[0], "Location", "SFO Bay Area");
+  appd_iot_data_set_integer(&custom_event_data[1], "Speed mph", 65);
+
+  custom_event.type = "Smart Car Reading";
+  custom_event.timestamp_ms = timestamp_ms;
+  custom_event.data_count = 2;
+  custom_event.data = custom_event_data;
+
+  retcode = appd_iot_add_custom_event(custom_event);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_network_request_event_t network_event;
+
+  appd_iot_init_to_zero(&network_event, sizeof(network_event));
+  network_event.url = "https://api.smartcar.com";
+  network_event.resp_code = 200;
+  network_event.timestamp_ms = timestamp_ms;
+
+  retcode = appd_iot_add_network_request_event(network_event);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_error_event_t error_event;
+  appd_iot_stack_frame_t stack_frame;
+  appd_iot_stack_trace_t stack_trace;
+
+  appd_iot_init_to_zero(&error_event, sizeof(error_event));
+  appd_iot_init_to_zero(&stack_frame, sizeof(stack_frame));
+  appd_iot_init_to_zero(&stack_trace, sizeof(stack_trace));
+
+  stack_frame.symbol_name = "_sigtramp";
+  stack_frame.package_name = "libsystem_platform.dylib";
+  stack_trace.thread = "main";
+  stack_trace.stack_frame_count = 1;
+  stack_trace.stack_frame = &stack_frame;
+
+  error_event.name = "Bus Error";
+  error_event.severity = APPD_IOT_ERR_SEVERITY_FATAL;
+  error_event.timestamp_ms = timestamp_ms;
+  error_event.stack_trace_count = 1;
+  error_event.stack_trace = &stack_trace;
+
+  retcode = appd_iot_add_error_event(error_event);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+}
+
+/**
+ * @brief Sends all events with http send callback and returns beacon sent
+ */
+static std::string appd_iot_send_events_and_get_beacon(void)
+{
+  appd_iot_http_cb_t http_cb;
+  http_cb.http_req_send_cb = &appd_iot_test_http_req_send_cb;
+  http_cb.http_resp_done_cb = &appd_iot_test_http_resp_done_cb;
+
+  appd_iot_register_network_interface(http_cb);
+  appd_iot_set_response_code(202);
+
+  appd_iot_error_code_t retcode = appd_iot_send_all_events();
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  return appd_iot_get_last_http_req_data();
+}
+
+/**
+ * @brief Unit Test for events serialized when added being sent as the same beacon as events
+ * serialized when sent, including events added before serialize on add is enabled
+ */
+Ensure(http_interface, sends_same_beacon_with_events_serialized_on_add)
+{
+  int64_t timestamp_ms = ((int64_t)time(NULL) * 1000);
+
+  appd_iot_init_sdk_with_custom_events(1, false);
+  appd_iot_add_events_of_all_types(timestamp_ms);
+
+  std::string expected = appd_iot_send_events_and_get_beacon();
+
+  assert_that(strstr(expected.c_str(), "errorEvents") != NULL, is_equal_to(true));
+
+  appd_iot_init_sdk_with_custom_events(1, true);
+  appd_iot_add_events_of_all_types(timestamp_ms);
+
+  assert_that(appd_iot_send_events_and_get_beacon().c_str(), is_equal_to_string(expected.c_str()));
+
+  //custom event added before enabling keeps custom events unserialized until it is sent
+  appd_iot_init_sdk_with_custom_events(1, false);
+  appd_iot_init_sdk_with_custom_events(0, true);
+  appd_iot_add_events_of_all_types(timestamp_ms);
+
+  assert_that(appd_iot_send_events_and_get_beacon().c_str(), is_equal_to_string(expected.c_str()));
+}
+
+/**
+ * @brief Unit Test for events serialized when added being split into beacons on drain and kept
+ * in the order they were added when beacon fails
+ */
+Ensure(http_interface, drains_events_serialized_on_add)
+{
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_sdk_with_custom_events(2, true);
+  appd_iot_add_events_of_all_types((int64_t)time(NULL) * 1000);
+
+  appd_iot_http_pipeline_cb_t http_pipeline_cb;
+  http_pipeline_cb.http_req_send_batch_cb = &appd_iot_test_http_req_send_batch_cb;
+  http_pipeline_cb.http_resp_done_cb = &appd_iot_test_http_batch_resp_done_cb;
+  http_pipeline_cb.max_requests_in_flight = 1;
+
+  retcode = appd_iot_register_network_pipeline_interface(http_pipeline_cb);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  //beacon with first two of three custom events fails, other events are not sent
+  int resp_codes[] = {500};
+
+  appd_iot_clear_http_batch_counters();
+  appd_iot_set_batch_response_codes(1, resp_codes);
+
+  retcode = appd_iot_drain_all_events(2);
+  assert_that(retcode, is_equal_to(APPD_IOT_ERR_NETWORK_ERROR));
+
+  assert_that(appd_iot_get_http_batch_req_count(), is_equal_to(1));
+  assert_that(appd_iot_get_http_batch_max_events_per_req(), is_equal_to(2));
+  assert_that(strstr(appd_iot_get_last_http_req_data(), "customEvents") != NULL, is_equal_to(true));
+  assert_that(strstr(appd_iot_get_last_http_req_data(), "networkRequestEvents") == NULL, is_equal_to(true));
+
+  //events of failed beacon are put back ahead of the third custom event, one event per beacon
+  appd_iot_clear_http_batch_counters();
+
+  retcode = appd_iot_drain_all_events(1);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  assert_that(appd_iot_get_http_batch_req_count(), is_equal_to(5));
+  assert_that(appd_iot_get_http_batch_max_events_per_req(), is_equal_to(1));
+  assert_that(appd_iot_get_http_batch_events_acked_count(), is_equal_to(5));
+  assert_that(strstr(appd_iot_get_last_http_req_data(), "errorEvents") != NULL, is_equal_to(true));
+}
+
 /**
  * @brief Unit Tests for valid http response
  */
@@ -561,6 +982,12 @@ TestSuite* http_interface_tests()
   add_test_with_context(suite, http_interface, check_appd_iot_sdk_disabled_data_limit);
   add_test_with_context(suite, http_interface, check_appd_iot_sdk_disabled_license_expired);
   add_test_with_context(suite, http_interface, check_appd_iot_sdk_disabled_kill_switch_and_enabled);
+  add_test_with_context(suite, http_interface, drains_events_as_pipelined_beacons);
+  add_test_with_context(suite, http_interface, keeps_events_of_failed_beacons_on_drain);
+  add_test_with_context(suite, http_interface, keeps_events_on_drain_serialization_failure);
+  add_test_with_context(suite, http_interface, drains_oldest_events_of_any_type_first);
+  add_test_with_context(suite, http_interface, sends_same_beacon_with_events_serialized_on_add);
+  add_test_with_context(suite, http_interface, drains_events_serialized_on_add);
 
   return suite;
 }
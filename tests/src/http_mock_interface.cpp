@@ -17,6 +17,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string>
 #include "common_test.hpp"
 #include "http_mock_interface.hpp"
 
@@ -26,6 +27,17 @@ static bool global_http_req_check_app_status_cb_triggered;
 static bool global_http_resp_done_cb_triggered;
 static bool global_http_req_bt_header_present;
 
+#define MAX_BATCH_RESPONSE_CODES 32
+
+static int global_batch_resp_codes[MAX_BATCH_RESPONSE_CODES];
+static int global_batch_resp_codes_count;
+static int global_http_req_send_batch_cb_count;
+static int global_http_batch_req_count;
+static int global_http_batch_events_acked_count;
+static int global_http_batch_max_events_per_req;
+static int global_http_batch_resp_done_count;
+static std::string global_http_req_data;
+
 
 /**
  * @brief Set Response code for mock http response
@@ -311,6 +323,14 @@ static bool appd_iot_validate_http_req(const appd_iot_http_req_t* http_req)
     return false;
   }
 
+  //beacon requests are prepared, with static headers ahead of content length
+  if (http_req->prepared_id == 0 || http_req->static_headers_count <= 0 ||
+      http_req->static_headers_count >= http_req->headers_count)
+  {
+    fprintf(stdout, "Invalid http req prepared params\n");
+    return false;
+  }
+
   //check for BT Headers
   if ((strstr(http_req->data, TEST_ADRUM_0) != NULL) &&
       (strstr(http_req->data, TEST_ADRUM_1) != NULL) &&
@@ -389,6 +409,8 @@ appd_iot_http_resp_t* appd_iot_test_http_req_send_cb(const appd_iot_http_req_t*
 
   appd_iot_set_http_req_send_cb_triggered(true);
 
+  global_http_req_data = (http_req->data != NULL) ? http_req->data : "";
+
   appd_iot_get_http_response(&http_resp);
 
   bool valid_http_req_check = appd_iot_validate_http_req(http_req);
@@ -401,6 +423,14 @@ appd_iot_http_resp_t* appd_iot_test_http_req_send_cb(const appd_iot_http_req_t*
   return http_resp;
 }
 
+/**
+ * @brief Get payload of the last request sent through http send or http batch send callback
+ */
+const char* appd_iot_get_last_http_req_data(void)
+{
+  return global_http_req_data.c_str();
+}
+
 /**
  * @brief Http Request Check App Status Callback Function.
  * This function mocks an actual http request and returns a http response
@@ -435,3 +465,153 @@ void appd_iot_test_http_resp_done_cb(appd_iot_http_resp_t* http_resp)
 
   appd_iot_clear_http_response(http_resp);
 }
+
+
+/**
+ * @brief Set Response codes for mock http batch responses <br>
+ * Response code at index i is returned for the i-th request sent since last clear.
+ * Requests beyond resp_codes_count get response code 202
+ */
+void appd_iot_set_batch_response_codes(int resp_codes_count, const int* resp_codes)
+{
+  if (resp_codes_count > MAX_BATCH_RESPONSE_CODES)
+  {
+    resp_codes_count = MAX_BATCH_RESPONSE_CODES;
+  }
+
+  for (int i = 0; i < resp_codes_count; i++)
+  {
+    global_batch_resp_codes[i] = resp_codes[i];
+  }
+
+  global_batch_resp_codes_count = resp_codes_count;
+}
+
+/**
+ * @brief Clear counters tracking mock http batch requests
+ */
+void appd_iot_clear_http_batch_counters(void)
+{
+  global_batch_resp_codes_count = 0;
+  global_http_req_send_batch_cb_count = 0;
+  global_http_batch_req_count = 0;
+  global_http_batch_events_acked_count = 0;
+  global_http_batch_max_events_per_req = 0;
+  global_http_batch_resp_done_count = 0;
+}
+
+/**
+ * @brief Get number of times http req send batch callback is triggered
+ */
+int appd_iot_get_http_req_send_batch_cb_count(void)
+{
+  return global_http_req_send_batch_cb_count;
+}
+
+/**
+ * @brief Get number of http requests sent through http req send batch callback
+ */
+int appd_iot_get_http_batch_req_count(void)
+{
+  return global_http_batch_req_count;
+}
+
+/**
+ * @brief Get number of events in http requests which received a successful response
+ */
+int appd_iot_get_http_batch_events_acked_count(void)
+{
+  return global_http_batch_events_acked_count;
+}
+
+/**
+ * @brief Get maximum number of events sent in a single http request
+ */
+int appd_iot_get_http_batch_max_events_per_req(void)
+{
+  return global_http_batch_max_events_per_req;
+}
+
+/**
+ * @brief Get number of http batch responses released through http resp done callback
+ */
+int appd_iot_get_http_batch_resp_done_count(void)
+{
+  return global_http_batch_resp_done_count;
+}
+
+/**
+ * @brief Count number of events in beacon payload. Each event has exactly one timestamp.
+ */
+static int appd_iot_count_http_req_events(const char* data)
+{
+  const char key[] = "\"timestamp\"";
+  int count = 0;
+
+  for (const char* p = strstr(data, key); p != NULL; p = strstr(p + 1, key))
+  {
+    count++;
+  }
+
+  return count;
+}
+
+/**
+ * @brief Http Request Send Batch Callback Function <br>
+ * This function mocks actual http requests and returns a http response for each request
+ */
+void appd_iot_test_http_req_send_batch_cb(const appd_iot_http_req_t* http_reqs,
+    appd_iot_http_resp_t** http_resps, int http_req_count)
+{
+  global_http_req_send_batch_cb_count++;
+
+  for (int i = 0; i < http_req_count; i++)
+  {
+    appd_iot_http_resp_t* http_resp = (appd_iot_http_resp_t*)calloc(1, sizeof(appd_iot_http_resp_t));
+
+    int req_index = global_http_batch_req_count++;
+
+    if (req_index < global_batch_resp_codes_count)
+    {
+      http_resp->resp_code = global_batch_resp_codes[req_index];
+    }
+    else
+    {
+      http_resp->resp_code = 202;
+    }
+
+    if (!appd_iot_validate_http_req(&http_reqs[i]))
+    {
+      http_resp->error = APPD_IOT_ERR_INVALID_INPUT;
+    }
+    else
+    {
+      int events = appd_iot_count_http_req_events(http_reqs[i].data);
+
+      global_http_req_data = http_reqs[i].data;
+
+      if (events > global_http_batch_max_events_per_req)
+      {
+        global_http_batch_max_events_per_req = events;
+      }
+
+      if (http_resp->resp_code >= 200 && http_resp->resp_code < 300)
+      {
+        global_http_batch_events_acked_count += events;
+      }
+    }
+
+    http_resps[i] = http_resp;
+  }
+}
+
+/**
+ * @brief Http response done Callback Function for batch responses <br>
+ * This function frees the mock http response
+ */
+void appd_iot_test_http_batch_resp_done_cb(appd_iot_http_resp_t* http_resp)
+{
+  global_http_batch_resp_done_count++;
+
+  free(http_resp);
+}
@@ -76,6 +76,11 @@ void appd_iot_clear_http_cb_triggered_flags();
  */
 appd_iot_http_resp_t* appd_iot_test_http_req_send_cb(const appd_iot_http_req_t* http_req);
 
+/**
+ * @brief Get payload of the last request sent through http send or http batch send callback
+ */
+const char* appd_iot_get_last_http_req_data(void);
+
 
 /**
  * @brief Http Request Check App Status Callback Function <br>
@@ -90,5 +95,55 @@ appd_iot_http_resp_t* appd_iot_test_http_req_check_app_status_cb(const appd_iot_
  */
 void appd_iot_test_http_resp_done_cb(appd_iot_http_resp_t* http_resp);
 
+/**
+ * @brief Set Response codes for mock http batch responses <br>
+ * Response code at index i is returned for the i-th request sent since last clear.
+ * Requests beyond resp_codes_count get response code 202
+ */
+void appd_iot_set_batch_response_codes(int resp_codes_count, const int* resp_codes);
+
+/**
+ * @brief Clear counters tracking mock http batch requests
+ */
+void appd_iot_clear_http_batch_counters(void);
+
+/**
+ * @brief Get number of times http req send batch callback is triggered
+ */
+int appd_iot_get_http_req_send_batch_cb_count(void);
+
+/**
+ * @brief Get number of http requests sent through http req send batch callback
+ */
+int appd_iot_get_http_batch_req_count(void);
+
+/**
+ * @brief Get number of events in http requests which received a successful response
+ */
+int appd_iot_get_http_batch_events_acked_count(void);
+
+/**
+ * @brief Get maximum number of events sent in a single http request
+ */
+int appd_iot_get_http_batch_max_events_per_req(void);
+
+/**
+ * @brief Get number of http batch responses released through http resp done callback
+ */
+int appd_iot_get_http_batch_resp_done_count(void);
+
+/**
+ * @brief Http Request Send Batch Callback Function <br>
+ * This function mocks actual http requests and returns a http response for each request
+ */
+void appd_iot_test_http_req_send_batch_cb(const appd_iot_http_req_t* http_reqs,
+    appd_iot_http_resp_t** http_resps, int http_req_count);
+
+/**
+ * @brief Http response done Callback Function for batch responses <br>
+ * This function frees the mock http response
+ */
+void appd_iot_test_http_batch_resp_done_cb(appd_iot_http_resp_t* http_resp);
+
 
 #endif /* http_mock_interface_hpp */
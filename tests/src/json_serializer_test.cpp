@@ -15,6 +15,7 @@
  */
 
 #include <cgreen/cgreen.h>
+#include <limits>
 #include "json_serializer.hpp"
 
 using namespace cgreen;
@@ -278,6 +279,82 @@ Ensure(json_serializer, test_json_url)
   appd_iot_json_free(json);
 }
 
+/**
+ * @brief Test for escaping of control characters, quotes and non-ASCII characters in keys and values,
+ * and for numbers which cannot be represented in json
+ * TEST CASES:
+ * {"a\"b":"\u0001\u001f\"\"\"","caf\u00e9":"","num":[null,null]}
+ */
+Ensure(json_serializer, test_json_escape_and_invalid_numbers)
+{
+  const char* input[] =
+  {
+    "{\"a\\\"b\":\"\\u0001\\u001f\\\"\\\"\\\"\",\"caf\xc3\xa9\":\"\",\"num\":[null,null]}",
+  };
+
+  const char* output;
+  json_t* json;
+
+  json = appd_iot_json_init();
+  appd_iot_json_start_object(json, NULL);
+  appd_iot_json_add_string_key_value(json, "a\"b", "\x01\x1f\"\"\"");
+  appd_iot_json_add_string_key_value(json, "caf\xc3\xa9", "");
+  appd_iot_json_start_array(json, "num");
+  appd_iot_json_add_double_value(json, std::numeric_limits<double>::quiet_NaN());
+  appd_iot_json_add_double_value(json, std::numeric_limits<double>::infinity());
+  appd_iot_json_end_array(json);
+  appd_iot_json_end_object(json);
+  output =  appd_iot_json_get_string(json);
+  assert_that(output, is_equal_to_string(input[0]));
+  appd_iot_json_free(json);
+
+  //largest doubles are not truncated
+  json = appd_iot_json_init();
+  appd_iot_json_start_array(json, NULL);
+  appd_iot_json_add_double_value(json, -std::numeric_limits<double>::max());
+  appd_iot_json_end_array(json);
+  output =  appd_iot_json_get_string(json);
+  assert_that(strlen(output), is_equal_to(319));
+  assert_that(strcmp(output + strlen(output) - 8, ".000000]"), is_equal_to(0));
+  appd_iot_json_free(json);
+}
+
+/**
+ * @brief Test for adding values serialized in another json struct to an array
+ * TEST CASES:
+ * [{"n":1},{"n":2}]
+ * [0,{"n":1},{"n":2},3]
+ */
+Ensure(json_serializer, test_json_add_json_value)
+{
+  const char* input[] =
+  {
+    "[{\"n\":1},{\"n\":2}]",
+    "[0,{\"n\":1},{\"n\":2},3]"
+  };
+  const char* values = "{\"n\":1},{\"n\":2}";
+
+  json_t* json = appd_iot_json_init();
+
+  appd_iot_json_start_array(json, NULL);
+  assert_that(appd_iot_json_add_json_value(json, values, strlen(values)), is_equal_to(APPD_IOT_SUCCESS));
+  appd_iot_json_end_array(json);
+  assert_that(appd_iot_json_get_string(json), is_equal_to_string(input[0]));
+
+  //values are separated by comma from elements added before and after them
+  appd_iot_json_reset(json);
+  appd_iot_json_start_array(json, NULL);
+  appd_iot_json_add_integer_value(json, 0);
+  appd_iot_json_add_json_value(json, values, strlen(values));
+  appd_iot_json_add_integer_value(json, 3);
+  appd_iot_json_end_array(json);
+  assert_that(appd_iot_json_get_string(json), is_equal_to_string(input[1]));
+
+  assert_that(appd_iot_json_add_json_value(json, NULL, 0), is_equal_to(APPD_IOT_ERR_NULL_PTR));
+
+  appd_iot_json_free(json);
+}
+
 TestSuite* json_serializer_tests()
 {
 
@@ -287,6 +364,8 @@ TestSuite* json_serializer_tests()
   add_test_with_context(suite, json_serializer, test_json_nesting);
   add_test_with_context(suite, json_serializer, test_json_symbols);
   add_test_with_context(suite, json_serializer, test_json_url);
+  add_test_with_context(suite, json_serializer, test_json_escape_and_invalid_numbers);
+  add_test_with_context(suite, json_serializer, test_json_add_json_value);
 
   return suite;
 }
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "log_binary_format.hpp"
+
+using namespace cgreen;
+
+#define TEST_LOG_MSG_SIZE 2048
+
+/**
+ * @brief Encodes args of format in binary, decodes them and returns the formatted message
+ */
+static std::string appd_iot_log_binary_roundtrip(const char* format, ...)
+{
+  log_binary_args_t args;
+  char payload[TEST_LOG_MSG_SIZE];
+  char logmsg[TEST_LOG_MSG_SIZE];
+  va_list ap;
+
+  if (!log_binary_parse_format(format, &args))
+  {
+    return "<unsupported>";
+  }
+
+  va_start(ap, format);
+  int payload_len = log_binary_encode(&args, ap, payload, sizeof(payload));
+  va_end(ap);
+
+  if (payload_len < 0 || log_binary_format(format, payload, payload_len, logmsg, sizeof(logmsg)) < 0)
+  {
+    return "<malformed>";
+  }
+
+  return logmsg;
+}
+
+/**
+ * @brief Formats message with vsnprintf
+ */
+static std::string appd_iot_log_text_format(const char* format, ...)
+{
+  char logmsg[TEST_LOG_MSG_SIZE];
+  va_list ap;
+
+  va_start(ap, format);
+  vsnprintf(logmsg, sizeof(logmsg), format, ap);
+  va_end(ap);
+
+  return logmsg;
+}
+
+Describe(log_binary);
+BeforeEach(log_binary) { }
+AfterEach(log_binary) { }
+
+/**
+ * @brief Unit Test for binary log record decoded to the same message as vsnprintf
+ */
+Ensure(log_binary, formats_binary_log_record_as_vsnprintf)
+{
+  std::string key = "Speed mph";
+  const char* nullstr = NULL;
+
+  assert_that(appd_iot_log_binary_roundtrip("Added Key :%s with value type:%d", key.c_str(), 2).c_str(),
+              is_equal_to_string(appd_iot_log_text_format("Added Key :%s with value type:%d", key.c_str(), 2).c_str()));
+  assert_that(appd_iot_log_binary_roundtrip("%-*s|%5.2f|%c|100%%", 12, "key", 3.14159, 'x').c_str(),
+              is_equal_to_string(appd_iot_log_text_format("%-*s|%5.2f|%c|100%%", 12, "key", 3.14159, 'x').c_str()));
+  assert_that(appd_iot_log_binary_roundtrip("%lu %lld %hhd %hu %zu %#x %o", 4000000000UL, -5LL, 300, 70000, (size_t)7,
+                                            255u, 8u).c_str(),
+              is_equal_to_string(appd_iot_log_text_format("%lu %lld %hhd %hu %zu %#x %o", 4000000000UL, -5LL, 300, 70000,
+                                                          (size_t)7, 255u, 8u).c_str()));
+  assert_that(appd_iot_log_binary_roundtrip("[%.3s] [%.*s] [%s]", "abcdef", 2, "xyz", nullstr).c_str(),
+              is_equal_to_string("[abc] [xy] [(null)]"));
+  assert_that(appd_iot_log_binary_roundtrip("No Arguments").c_str(), is_equal_to_string("No Arguments"));
+}
+
+/**
+ * @brief Unit Test for format strings which cannot be logged in binary
+ */
+Ensure(log_binary, returns_unsupported_on_invalid_binary_log_format)
+{
+  log_binary_args_t args;
+
+  assert_that(log_binary_parse_format("%d%n", &args), is_equal_to(false));
+  assert_that(log_binary_parse_format("%Lf", &args), is_equal_to(false));
+  assert_that(log_binary_parse_format("%ls", &args), is_equal_to(false));
+  assert_that(log_binary_parse_format("%1$d", &args), is_equal_to(false));
+  assert_that(log_binary_parse_format("%m", &args), is_equal_to(false));
+  assert_that(log_binary_parse_format("trailing %", &args), is_equal_to(false));
+  assert_that(log_binary_parse_format("%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d", &args), is_equal_to(false));
+  assert_that(log_binary_parse_format("%d %s %f", &args), is_equal_to(true));
+  assert_that(args.nargs, is_equal_to(3));
+}
+
+/**
+ * @brief Unit Test for malformed binary log record payload
+ */
+Ensure(log_binary, returns_fail_on_malformed_binary_log_record)
+{
+  char logmsg[TEST_LOG_MSG_SIZE];
+  char payload[4] = {0};
+
+  assert_that(log_binary_format("%d", payload, sizeof(payload), logmsg, sizeof(logmsg)), is_equal_to(-1));
+  assert_that(log_binary_format("%s", payload, 2, logmsg, sizeof(logmsg)), is_equal_to(-1));
+}
+
+
+TestSuite* log_binary_tests()
+{
+  TestSuite* suite = create_test_suite();
+
+  add_test_with_context(suite, log_binary, formats_binary_log_record_as_vsnprintf);
+  add_test_with_context(suite, log_binary, returns_unsupported_on_invalid_binary_log_format);
+  add_test_with_context(suite, log_binary, returns_fail_on_malformed_binary_log_record);
+
+  return suite;
+}
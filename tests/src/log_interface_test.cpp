@@ -16,6 +16,13 @@
 
 #include <cgreen/cgreen.h>
 #include <appd_iot_interface.h>
+#include <pthread.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
 #include "common_test.hpp"
 #include "log_mock_interface.hpp"
 
@@ -143,6 +150,424 @@ Ensure(log_interface, returns_fail_on_invalid_appd_iot_log_config)
   assert_that(appd_iot_is_log_write_cb_success(), is_equal_to(false));
 }
 
+#define TEST_ASYNC_LOG_EVENTS 10
+
+/**
+ * @brief Adds custom events, each of which is logged
+ */
+static void* appd_iot_add_custom_events_thread(void* arg)
+{
+  appd_iot_custom_event_t custom_event;
+
+  appd_iot_init_to_zero(&custom_event, sizeof(appd_iot_custom_event_t));
+
+  custom_event.type = "Thermostat Reading";
+  custom_event.summary = "Temperature Captured";
+  custom_event.timestamp_ms = ((int64_t)time(NULL) * 1000);
+
+  for (int i = 0; i < TEST_ASYNC_LOG_EVENTS; i++)
+  {
+    appd_iot_add_custom_event(custom_event);
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Unit Test for log messages written in async log mode
+ */
+Ensure(log_interface, writes_log_messages_in_async_log_mode)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_write_cb = &appd_iot_log_write_cb;
+  sdkcfg.log_level = APPD_IOT_LOG_INFO;
+  sdkcfg.log_mode = APPD_IOT_LOG_MODE_ASYNC;
+
+  devcfg.device_id = "1234";
+  devcfg.device_type = "Thermostat";
+
+  appd_iot_error_code_t retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_flush_log();
+  appd_iot_clear_log_write_cb_flags();
+
+  //log messages from another thread are written once flushed
+  pthread_t add_events_thread;
+
+  assert_that(pthread_create(&add_events_thread, NULL, &appd_iot_add_custom_events_thread, NULL), is_equal_to(0));
+  pthread_join(add_events_thread, NULL);
+
+  appd_iot_flush_log();
+
+  assert_that(appd_iot_is_log_write_cb_success(), is_equal_to(true));
+  assert_that(appd_iot_get_log_write_cb_count(), is_greater_than(TEST_ASYNC_LOG_EVENTS - 1));
+
+  //log messages from calling thread
+  appd_iot_clear_log_write_cb_flags();
+  appd_iot_add_custom_events_thread(NULL);
+  appd_iot_flush_log();
+
+  assert_that(appd_iot_get_log_write_cb_count(), is_greater_than(TEST_ASYNC_LOG_EVENTS - 1));
+
+  appd_iot_clear_all_events();
+}
+
+/**
+ * @brief Unit Test for log messages written in binary log mode, formatted by background thread
+ * or written to binary log file
+ */
+Ensure(log_interface, writes_log_messages_in_binary_log_mode)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  char log_binary_file[] = "/tmp/appd_iot_log_binary_test_XXXXXX";
+  int fd = mkstemp(log_binary_file);
+
+  assert_that(fd, is_greater_than(-1));
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_write_cb = &appd_iot_log_write_cb;
+  sdkcfg.log_level = APPD_IOT_LOG_INFO;
+  sdkcfg.log_mode = APPD_IOT_LOG_MODE_BINARY;
+
+  devcfg.device_id = "1234";
+  devcfg.device_type = "Thermostat";
+
+  appd_iot_error_code_t retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_flush_log();
+  appd_iot_clear_log_write_cb_flags();
+
+  //log messages are formatted by log thread and written with log write callback
+  appd_iot_add_custom_events_thread(NULL);
+  appd_iot_flush_log();
+
+  assert_that(appd_iot_is_log_write_cb_success(), is_equal_to(true));
+  assert_that(appd_iot_get_log_write_cb_count(), is_greater_than(TEST_ASYNC_LOG_EVENTS - 1));
+
+  //log records are written to binary log file without formatting
+  sdkcfg.log_binary_file = log_binary_file;
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_clear_log_write_cb_flags();
+  appd_iot_add_custom_events_thread(NULL);
+  appd_iot_flush_log();
+
+  assert_that(appd_iot_get_log_write_cb_count(), is_equal_to(0));
+
+  char magic[8];
+  off_t file_size = lseek(fd, 0, SEEK_END);
+
+  assert_that(pread(fd, magic, sizeof(magic), 0), is_equal_to((ssize_t)sizeof(magic)));
+  assert_that(memcmp(magic, "APPDLOG", sizeof(magic)), is_equal_to(0));
+  assert_that(file_size, is_greater_than(TEST_ASYNC_LOG_EVENTS * 32));
+
+  //binary log file is closed when log mode is changed
+  sdkcfg.log_mode = APPD_IOT_LOG_MODE_SYNC;
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_clear_all_events();
+  close(fd);
+  unlink(log_binary_file);
+}
+
+/**
+ * @brief Unit Test for log messages written to log file, which is rotated by size
+ */
+Ensure(log_interface, writes_log_messages_to_rotated_log_file)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  char log_dir[] = "/tmp/appd_iot_log_file_test_XXXXXX";
+
+  assert_that(mkdtemp(log_dir) != NULL, is_equal_to(true));
+
+  std::string log_file = std::string(log_dir) + "/sdk.log";
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_level = APPD_IOT_LOG_ALL;
+  sdkcfg.log_file = log_file.c_str();
+  sdkcfg.log_file_max_size_kb = 1;
+  sdkcfg.log_file_max_count = 2;
+
+  devcfg.device_id = "1234";
+  devcfg.device_type = "Thermostat";
+
+  appd_iot_error_code_t retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  for (int i = 0; i < 5; i++)
+  {
+    appd_iot_add_custom_events_thread(NULL);
+  }
+
+  appd_iot_flush_log();
+
+  //files are rotated at line boundary before exceeding max size, and oldest ones are removed
+  const char* suffixes[] = {"", ".1", ".2"};
+
+  for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++)
+  {
+    struct stat st;
+    char line[64] = {0};
+    FILE* fp = fopen((log_file + suffixes[i]).c_str(), "r");
+
+    assert_that(fp != NULL, is_equal_to(true));
+    assert_that(fstat(fileno(fp), &st), is_equal_to(0));
+    assert_that(st.st_size, is_greater_than(0));
+    assert_that(st.st_size, is_less_than(1025));
+    assert_that(fgets(line, sizeof(line), fp) != NULL, is_equal_to(true));
+    assert_that(line, contains_string("/APPDYNAMICS: "));
+    fclose(fp);
+  }
+
+  assert_that(access((log_file + ".3").c_str(), F_OK), is_equal_to(-1));
+
+  //log file is closed when sdk is initialized without it
+  sdkcfg.log_file = NULL;
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_clear_all_events();
+
+  for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++)
+  {
+    unlink((log_file + suffixes[i]).c_str());
+  }
+
+  rmdir(log_dir);
+}
+
+/**
+ * @brief Unit Test for ERROR log messages, which are written to log file by the logging thread right away
+ */
+Ensure(log_interface, writes_error_log_messages_to_log_file_right_away)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  appd_iot_custom_event_t custom_event;
+  char log_dir[] = "/tmp/appd_iot_log_file_test_XXXXXX";
+  char content[8192] = {0};
+
+  assert_that(mkdtemp(log_dir) != NULL, is_equal_to(true));
+
+  std::string log_file = std::string(log_dir) + "/sdk.log";
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+  appd_iot_init_to_zero(&custom_event, sizeof(custom_event));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_level = APPD_IOT_LOG_ALL;
+  sdkcfg.log_file = log_file.c_str();
+
+  devcfg.device_id = "1234";
+  devcfg.device_type = "Thermostat";
+
+  appd_iot_error_code_t retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  //event data count without event data logs an ERROR message
+  custom_event.type = "Smart Car Reading";
+  custom_event.summary = "Events Captured in Smart Car";
+  custom_event.data_count = 1;
+
+  appd_iot_add_custom_event(custom_event);
+
+  FILE* fp = fopen(log_file.c_str(), "r");
+
+  assert_that(fp != NULL, is_equal_to(true));
+  assert_that(fread(content, 1, sizeof(content) - 1, fp), is_greater_than(0));
+  assert_that(content, contains_string("Source Data Pointer is NULL"));
+  fclose(fp);
+
+  sdkcfg.log_file = NULL;
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_clear_all_events();
+  unlink(log_file.c_str());
+  rmdir(log_dir);
+}
+
+/**
+ * @brief Unit Test for log messages formatted as JSON, with fields of log statements, in all log modes
+ */
+Ensure(log_interface, writes_json_log_messages_in_json_log_format)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_write_cb = &appd_iot_log_write_cb;
+  sdkcfg.log_level = APPD_IOT_LOG_ALL;
+  sdkcfg.log_format = APPD_IOT_LOG_FORMAT_JSON;
+
+  devcfg.device_id = "1234";
+  devcfg.device_type = "Thermostat";
+
+  appd_iot_log_mode_t log_modes[] = {APPD_IOT_LOG_MODE_SYNC, APPD_IOT_LOG_MODE_ASYNC, APPD_IOT_LOG_MODE_BINARY};
+
+  for (size_t i = 0; i < sizeof(log_modes) / sizeof(log_modes[0]); i++)
+  {
+    sdkcfg.log_mode = log_modes[i];
+
+    appd_iot_error_code_t retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+    assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+    appd_iot_flush_log();
+    appd_iot_clear_log_write_cb_flags();
+
+    appd_iot_add_custom_events_thread(NULL);
+    appd_iot_flush_log();
+
+    int count = appd_iot_get_log_write_cb_count();
+
+    assert_that(appd_iot_is_log_write_cb_success(), is_equal_to(true));
+    assert_that(count, is_greater_than(TEST_ASYNC_LOG_EVENTS - 1));
+    assert_that(appd_iot_get_log_write_cb_match_count("{\"ts\":"), is_equal_to(count));
+    assert_that(appd_iot_get_log_write_cb_match_count("\"subsystem\":\"events\""), is_greater_than(0));
+    assert_that(appd_iot_get_log_write_cb_match_count("\"level\":\""), is_equal_to(count));
+    assert_that(appd_iot_get_log_write_cb_match_count("\"message\":\""), is_equal_to(count));
+    assert_that(appd_iot_get_log_write_cb_match_count("/APPDYNAMICS: "), is_equal_to(0));
+
+    //fields of log statements are separate keys, unset fields are omitted
+    assert_that(appd_iot_get_log_write_cb_match_count("\"event_type\":\""), is_greater_than(0));
+    assert_that(appd_iot_get_log_write_cb_match_count("\"error_code\":"), is_equal_to(0));
+
+    appd_iot_clear_all_events();
+  }
+
+  sdkcfg.log_mode = APPD_IOT_LOG_MODE_SYNC;
+  sdkcfg.log_format = APPD_IOT_LOG_FORMAT_TEXT;
+
+  appd_iot_error_code_t retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+}
+
+/**
+ * @brief Unit Test for log level set per log subsystem
+ */
+Ensure(log_interface, writes_log_messages_for_subsystem_log_level)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_write_cb = &appd_iot_log_write_cb;
+  sdkcfg.log_level = APPD_IOT_LOG_ERROR;
+  sdkcfg.subsystem_log_level[APPD_IOT_LOG_SUBSYSTEM_EVENTS] = APPD_IOT_LOG_INFO;
+
+  devcfg.device_id = "1234";
+  devcfg.device_type = "Thermostat";
+
+  appd_iot_error_code_t retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  //events subsystem logs info messages, beacon subsystem does not
+  appd_iot_clear_log_write_cb_flags();
+  appd_iot_add_custom_events_thread(NULL);
+
+  assert_that(appd_iot_get_log_write_cb_match_count("Adding Custom Event"), is_equal_to(TEST_ASYNC_LOG_EVENTS));
+  assert_that(appd_iot_get_log_write_cb_match_count("Custom Event Added"), is_equal_to(0));
+
+  //subsystem log level lower than global log level
+  sdkcfg.log_level = APPD_IOT_LOG_INFO;
+  sdkcfg.subsystem_log_level[APPD_IOT_LOG_SUBSYSTEM_EVENTS] = APPD_IOT_LOG_ERROR;
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_clear_all_events();
+  appd_iot_clear_log_write_cb_flags();
+  appd_iot_add_custom_events_thread(NULL);
+
+  assert_that(appd_iot_get_log_write_cb_match_count("Adding Custom Event"), is_equal_to(0));
+  assert_that(appd_iot_get_log_write_cb_match_count("Custom Event Added"), is_equal_to(TEST_ASYNC_LOG_EVENTS));
+
+  appd_iot_clear_all_events();
+}
+
+/**
+ * @brief Unit Test for log messages suppressed over log rate limit
+ */
+Ensure(log_interface, suppresses_log_messages_over_log_rate_limit)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  const int log_rate_limit = 4;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_write_cb = &appd_iot_log_write_cb;
+  sdkcfg.log_level = APPD_IOT_LOG_INFO;
+  sdkcfg.log_rate_limit = log_rate_limit;
+
+  devcfg.device_id = "1234";
+  devcfg.device_type = "Thermostat";
+
+  appd_iot_error_code_t retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  //burst of messages from a log statement is limited to the rate limit
+  appd_iot_clear_log_write_cb_flags();
+  appd_iot_add_custom_events_thread(NULL);
+
+  assert_that(appd_iot_get_log_write_cb_match_count("Adding Custom Event"), is_equal_to(log_rate_limit));
+  assert_that(appd_iot_get_log_write_cb_match_count("Suppressed"), is_equal_to(0));
+
+  //suppressed messages are reported with the next message logged once bucket is refilled
+  struct timespec interval = {0, 500 * 1000000L};
+
+  nanosleep(&interval, NULL);
+
+  appd_iot_clear_log_write_cb_flags();
+  appd_iot_add_custom_events_thread(NULL);
+
+  assert_that(appd_iot_get_log_write_cb_match_count("Suppressed 6 Similar Log Messages"), is_greater_than(0));
+
+  appd_iot_clear_all_events();
+
+  sdkcfg.log_rate_limit = 0;
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+}
+
 TestSuite* log_interface_tests()
 {
 
@@ -151,6 +576,13 @@ TestSuite* log_interface_tests()
   add_test_with_context(suite, log_interface, returns_success_on_valid_appd_iot_config_with_log_all);
   add_test_with_context(suite, log_interface, returns_success_on_invalid_appd_iot_sdk_config);
   add_test_with_context(suite, log_interface, returns_fail_on_invalid_appd_iot_log_config);
+  add_test_with_context(suite, log_interface, writes_log_messages_in_async_log_mode);
+  add_test_with_context(suite, log_interface, writes_log_messages_in_binary_log_mode);
+  add_test_with_context(suite, log_interface, writes_log_messages_to_rotated_log_file);
+  add_test_with_context(suite, log_interface, writes_error_log_messages_to_log_file_right_away);
+  add_test_with_context(suite, log_interface, writes_json_log_messages_in_json_log_format);
+  add_test_with_context(suite, log_interface, writes_log_messages_for_subsystem_log_level);
+  add_test_with_context(suite, log_interface, suppresses_log_messages_over_log_rate_limit);
 
   return suite;
 }
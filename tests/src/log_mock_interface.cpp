@@ -26,10 +26,14 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <inttypes.h>
+#include <string>
+#include <vector>
 #include "log_mock_interface.hpp"
 
 static bool global_log_write_cb_log_msg_not_null;
 static bool global_log_write_cb_triggered;
+static int global_log_write_cb_count;
+static std::vector<std::string> global_log_write_cb_msgs;
 
 /**
  * @brief Check if log write callback is triggerd and <br>
@@ -47,6 +51,34 @@ void appd_iot_clear_log_write_cb_flags()
 {
   global_log_write_cb_triggered = false;
   global_log_write_cb_log_msg_not_null = true;
+  global_log_write_cb_count = 0;
+  global_log_write_cb_msgs.clear();
+}
+
+/**
+ * @brief Get number of times log write callback is triggered since flags were cleared
+ */
+int appd_iot_get_log_write_cb_count()
+{
+  return global_log_write_cb_count;
+}
+
+/**
+ * @brief Get number of log messages containing given string since flags were cleared
+ */
+int appd_iot_get_log_write_cb_match_count(const char* str)
+{
+  int count = 0;
+
+  for (size_t i = 0; i < global_log_write_cb_msgs.size(); i++)
+  {
+    if (global_log_write_cb_msgs[i].find(str) != std::string::npos)
+    {
+      count++;
+    }
+  }
+
+  return count;
 }
 
 /**
@@ -55,6 +87,7 @@ void appd_iot_clear_log_write_cb_flags()
 void appd_iot_log_write_cb(const char* logmsg, size_t logmsg_len)
 {
   global_log_write_cb_triggered = true;
+  global_log_write_cb_count++;
 
   if ((logmsg == NULL) || (strlen(logmsg) != logmsg_len))
   {
@@ -62,6 +95,8 @@ void appd_iot_log_write_cb(const char* logmsg, size_t logmsg_len)
     return;
   }
 
+  global_log_write_cb_msgs.push_back(std::string(logmsg, logmsg_len));
+
   int iovcnt;
   struct iovec iov[3];
   char timestamp[32];
@@ -29,6 +29,16 @@ bool appd_iot_is_log_write_cb_success();
  */
 void appd_iot_clear_log_write_cb_flags();
 
+/**
+ * @brief Get number of times log write callback is triggered since flags were cleared
+ */
+int appd_iot_get_log_write_cb_count();
+
+/**
+ * @brief Get number of log messages containing given string since flags were cleared
+ */
+int appd_iot_get_log_write_cb_match_count(const char* str);
+
 /**
  * @brief Writes the log message to stderr if the log message is not null
  */
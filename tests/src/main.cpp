@@ -27,7 +27,10 @@ TestSuite* network_event_tests();
 TestSuite* error_event_tests();
 TestSuite* custom_event_tests();
 TestSuite* log_interface_tests();
+TestSuite* log_binary_tests();
 TestSuite* utils_tests();
+TestSuite* stats_tests();
+TestSuite* alloc_tests();
 
 /**
  * @brief create a test suite and run the tests
@@ -43,7 +46,10 @@ int main(int argc, const char* argv[])
   add_suite(suite, error_event_tests());
   add_suite(suite, custom_event_tests());
   add_suite(suite, log_interface_tests());
+  add_suite(suite, log_binary_tests());
   add_suite(suite, utils_tests());
+  add_suite(suite, stats_tests());
+  add_suite(suite, alloc_tests());
 
   if (argc > 1)
   {
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cgreen/cgreen.h>
+#include <appd_iot_interface.h>
+#include <time.h>
+#include "common_test.hpp"
+#include "http_mock_interface.hpp"
+#include "log_mock_interface.hpp"
+
+using namespace cgreen;
+
+//Size of SDK event buffer, shared by events of all types
+#define TEST_MAX_EVENTS 600
+
+Describe(stats);
+BeforeEach(stats) { }
+AfterEach(stats) { }
+
+/**
+ * @brief Unit Test for self-telemetry counters updated on add, drop, failed send and successful send
+ */
+Ensure(stats, counts_events_and_beacons_in_appd_iot_get_stats)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  appd_iot_stats_t before, after;
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_write_cb = &appd_iot_log_write_cb;
+  sdkcfg.log_level = APPD_IOT_LOG_ERROR;
+
+  devcfg.device_id = "5555";
+  devcfg.device_type = "SmartCar";
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_http_cb_t http_cb;
+  http_cb.http_req_send_cb = &appd_iot_test_http_req_send_cb;
+  http_cb.http_resp_done_cb = &appd_iot_test_http_resp_done_cb;
+
+  retcode = appd_iot_register_network_interface(http_cb);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_clear_all_events();
+
+  assert_that(appd_iot_get_stats(NULL), is_equal_to(APPD_IOT_ERR_NULL_PTR));
+  assert_that(appd_iot_get_stats(&before), is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_custom_event_t custom_event;
+
+  appd_iot_init_to_zero(&custom_event, sizeof(custom_event));
+  custom_event.type = "Smart Car Reading";
+  custom_event.summary = "Events Captured in Smart Car";
+  custom_event.timestamp_ms = ((int64_t)time(NULL) * 1000);
+
+  //one event more than the buffer holds is dropped, whatever its type
+  for (int i = 0; i <= TEST_MAX_EVENTS; i++)
+  {
+    appd_iot_add_custom_event(custom_event);
+  }
+
+  appd_iot_network_request_event_t network_event;
+
+  appd_iot_init_to_zero(&network_event, sizeof(network_event));
+  network_event.url = "https://api.smartcar.com";
+  network_event.resp_code = 200;
+  network_event.timestamp_ms = ((int64_t)time(NULL) * 1000);
+
+  assert_that(appd_iot_add_network_request_event(network_event), is_equal_to(APPD_IOT_ERR_MAX_LIMIT));
+
+  //failed send keeps events in buffer
+  appd_iot_set_response_code(500);
+  appd_iot_set_response_headers(0, NULL);
+
+  retcode = appd_iot_send_all_events();
+  assert_that(retcode, is_equal_to(APPD_IOT_ERR_NETWORK_ERROR));
+
+  appd_iot_set_response_code(202);
+
+  retcode = appd_iot_send_all_events();
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  assert_that(appd_iot_get_stats(&after), is_equal_to(APPD_IOT_SUCCESS));
+
+  assert_that(after.custom_events_added - before.custom_events_added, is_equal_to(TEST_MAX_EVENTS));
+  assert_that(after.custom_events_dropped - before.custom_events_dropped, is_equal_to(1));
+  assert_that(after.network_events_dropped - before.network_events_dropped, is_equal_to(1));
+  assert_that(after.beacon_send_failures - before.beacon_send_failures, is_equal_to(1));
+  assert_that(after.events_requeued - before.events_requeued, is_equal_to(TEST_MAX_EVENTS));
+  assert_that(after.beacons_sent - before.beacons_sent, is_equal_to(1));
+  assert_that(after.events_sent - before.events_sent, is_equal_to(TEST_MAX_EVENTS));
+  assert_that(after.bytes_sent - before.bytes_sent, is_greater_than(0));
+  assert_that(after.bytes_serialized - before.bytes_serialized,
+              is_equal_to(2 * (after.bytes_sent - before.bytes_sent)));
+  assert_that(after.serialize_latency.count - before.serialize_latency.count, is_equal_to(2));
+  assert_that(after.snapshot_latency.count - before.snapshot_latency.count, is_equal_to(2));
+  assert_that(after.transport_latency.count - before.transport_latency.count, is_equal_to(2));
+  assert_that(after.response_latency.count - before.response_latency.count, is_equal_to(2));
+  assert_that(after.clear_latency.count - before.clear_latency.count, is_equal_to(2));
+  assert_that(after.time_disabled_ms, is_equal_to(before.time_disabled_ms));
+}
+
+/**
+ * @brief Unit Test for send timing custom event added after each successful send
+ */
+Ensure(stats, adds_send_timing_event_after_successful_send)
+{
+  appd_iot_sdk_config_t sdkcfg;
+  appd_iot_device_config_t devcfg;
+  appd_iot_stats_t before, after;
+  appd_iot_error_code_t retcode;
+
+  appd_iot_init_to_zero(&sdkcfg, sizeof(sdkcfg));
+  appd_iot_init_to_zero(&devcfg, sizeof(devcfg));
+
+  sdkcfg.appkey = TEST_APP_KEY;
+  sdkcfg.eum_collector_url = TEST_EUM_COLLECTOR_URL;
+  sdkcfg.log_write_cb = &appd_iot_log_write_cb;
+  sdkcfg.log_level = APPD_IOT_LOG_ERROR;
+  sdkcfg.send_timing_events = true;
+
+  devcfg.device_id = "5555";
+  devcfg.device_type = "SmartCar";
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_http_cb_t http_cb;
+  http_cb.http_req_send_cb = &appd_iot_test_http_req_send_cb;
+  http_cb.http_resp_done_cb = &appd_iot_test_http_resp_done_cb;
+
+  retcode = appd_iot_register_network_interface(http_cb);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_clear_all_events();
+  appd_iot_get_stats(&before);
+
+  appd_iot_custom_event_t custom_event;
+
+  appd_iot_init_to_zero(&custom_event, sizeof(custom_event));
+  custom_event.type = "Smart Car Reading";
+  custom_event.summary = "Events Captured in Smart Car";
+
+  retcode = appd_iot_add_custom_event(custom_event);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  //first send records its timing, which is added only by a send with other events
+  appd_iot_set_response_code(202);
+  retcode = appd_iot_send_all_events();
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_get_stats(&after);
+
+  assert_that(after.events_sent - before.events_sent, is_equal_to(1));
+  assert_that(after.custom_events_added - before.custom_events_added, is_equal_to(1));
+
+  //idle device does not send timing of its previous send
+  appd_iot_set_response_code(202);
+  retcode = appd_iot_drain_all_events(10);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_get_stats(&after);
+
+  assert_that(after.beacons_sent - before.beacons_sent, is_equal_to(1));
+  assert_that(after.events_sent - before.events_sent, is_equal_to(1));
+  assert_that(after.custom_events_added - before.custom_events_added, is_equal_to(1));
+
+  retcode = appd_iot_add_custom_event(custom_event);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_set_response_code(202);
+  retcode = appd_iot_drain_all_events(10);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_get_stats(&after);
+
+  assert_that(after.beacons_sent - before.beacons_sent, is_equal_to(2));
+  assert_that(after.events_sent - before.events_sent, is_equal_to(3));
+  assert_that(after.custom_events_added - before.custom_events_added, is_equal_to(3));
+
+  appd_iot_set_response_code(202);
+  retcode = appd_iot_send_all_events();
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_get_stats(&after);
+
+  assert_that(after.beacons_sent - before.beacons_sent, is_equal_to(2));
+  assert_that(after.events_sent - before.events_sent, is_equal_to(3));
+
+  //timing events are not added when disabled
+  sdkcfg.send_timing_events = false;
+
+  retcode = appd_iot_init_sdk(sdkcfg, devcfg);
+  assert_that(retcode, is_equal_to(APPD_IOT_SUCCESS));
+
+  appd_iot_clear_all_events();
+}
+
+
+TestSuite* stats_tests()
+{
+  TestSuite* suite = create_test_suite();
+
+  add_test_with_context(suite, stats, counts_events_and_beacons_in_appd_iot_get_stats);
+  add_test_with_context(suite, stats, adds_send_timing_event_after_successful_send);
+
+  return suite;
+}
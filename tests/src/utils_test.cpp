@@ -14,8 +14,17 @@
  * limitations under the License.
  */
 
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
 #include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <time.h>
+#include <inttypes.h>
+#include <appd_iot_interface.h>
 #include "utils.hpp"
+#include "clock.hpp"
 
 using namespace cgreen;
 
@@ -37,6 +46,37 @@ Ensure(utils, test_utils_remove_character_function)
   assert_that(appd_iot_remove_character(NULL, '|'), is_equal_to_string(""));
 }
 
+/**
+ * @brief Unit Test for cached coarse clock and its decimal rendering
+ */
+Ensure(utils, test_clock_time_ms_and_cached_decimal_string)
+{
+  const int64_t times[] = {0, 7, 1528232743123LL, 1528232743123LL, 1528232743124LL, -42, INT64_MAX};
+  char expected[APPD_IOT_TIME_MS_STR_SIZE];
+  char buf[APPD_IOT_TIME_MS_STR_SIZE];
+
+  for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); i++)
+  {
+    int expected_len = snprintf(expected, sizeof(expected), "%" PRId64, times[i]);
+
+    assert_that(appd_iot_clock_format_time_ms(times[i], buf, sizeof(buf)), is_equal_to(expected_len));
+    assert_that(buf, is_equal_to_string(expected));
+  }
+
+  //truncated to fit in buffer
+  assert_that(appd_iot_clock_format_time_ms(1528232743123LL, buf, 5), is_equal_to(4));
+  assert_that(buf, is_equal_to_string("1528"));
+
+  int64_t now_ms = (int64_t)time(NULL) * 1000;
+  int64_t time_ms = appd_iot_get_time_ms();
+
+  assert_that(time_ms > now_ms - 2000, is_equal_to(true));
+  assert_that(time_ms < now_ms + 2000, is_equal_to(true));
+
+  assert_that(appd_iot_get_time_ms_str(buf, sizeof(buf)), is_equal_to(13));
+  assert_that(strtoll(buf, NULL, 10) >= time_ms, is_equal_to(true));
+}
+
 
 TestSuite* utils_tests()
 {
@@ -44,6 +84,7 @@ TestSuite* utils_tests()
   TestSuite* suite = create_test_suite();
 
   add_test_with_context(suite, utils, test_utils_remove_character_function);
+  add_test_with_context(suite, utils, test_clock_time_ms_and_cached_decimal_string);
 
   return suite;
 }
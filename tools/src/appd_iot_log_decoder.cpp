@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2018 AppDynamics LLC and its affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "log_binary_format.hpp"
+
+/**
+ * Formats binary log files written by the SDK in APPD_IOT_LOG_MODE_BINARY. Each message is
+ * written to stdout in the same format as SDK writes log messages to stderr:
+ *   <timestamp_ms> <L>/APPDYNAMICS: <message>
+ * Messages logged in APPD_IOT_LOG_FORMAT_JSON are written as is, one JSON object per line.
+ *
+ * Usage: appd_iot_log_decoder [binary log file ...]
+ * Reads from stdin if no file is given.
+ */
+
+#define LOG_MSG_MAX_SIZE 4096
+
+static const char loglevel_c[] = {'O', 'E', 'W', 'I', 'D', 'V', 'A'};
+
+
+/**
+ * @brief Reads entire file into buffer
+ * @return true on success
+ */
+static bool read_file(FILE* fp, std::vector<char>& buf)
+{
+  char chunk[64 * 1024];
+  size_t len;
+
+  while ((len = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+  {
+    buf.insert(buf.end(), chunk, chunk + len);
+  }
+
+  return (ferror(fp) == 0);
+}
+
+
+/**
+ * @brief Checks if binary log file header is at given position
+ * @return true if file header is valid, false if there is no file header
+ */
+static bool is_file_header(const std::vector<char>& buf, size_t pos)
+{
+  log_binary_file_header_t file_header;
+
+  if (pos + sizeof(file_header) > buf.size())
+  {
+    return false;
+  }
+
+  memcpy(&file_header, &buf[pos], sizeof(file_header));
+
+  return (memcmp(file_header.magic, LOG_BINARY_FILE_MAGIC, sizeof(LOG_BINARY_FILE_MAGIC)) == 0);
+}
+
+
+/**
+ * @brief Decodes all records in binary log file and writes messages to stdout
+ * @param name of the file, used in error messages
+ * @param buf contains file content
+ * @return number of malformed records
+ */
+static int decode_file(const char* name, const std::vector<char>& buf)
+{
+  std::map<uint16_t, std::string> formats;
+  char logmsg[LOG_MSG_MAX_SIZE];
+  int errors = 0;
+  size_t pos = 0;
+
+  while (pos < buf.size())
+  {
+    //file header is written each time SDK opens the file
+    if (is_file_header(buf, pos))
+    {
+      log_binary_file_header_t file_header;
+
+      memcpy(&file_header, &buf[pos], sizeof(file_header));
+
+      if (file_header.version != LOG_BINARY_FILE_VERSION || file_header.byte_order != LOG_BINARY_FILE_BYTE_ORDER)
+      {
+        fprintf(stderr, "%s: unsupported version %u or byte order at offset %lu\n", name,
+                file_header.version, (unsigned long)pos);
+        return errors + 1;
+      }
+
+      formats.clear();
+      pos += sizeof(file_header);
+      continue;
+    }
+
+    log_record_header_t header;
+
+    if (pos + sizeof(header) > buf.size())
+    {
+      fprintf(stderr, "%s: truncated record at offset %lu\n", name, (unsigned long)pos);
+      return errors + 1;
+    }
+
+    memcpy(&header, &buf[pos], sizeof(header));
+
+    if (header.record_len < sizeof(header) + header.payload_len || pos + header.record_len > buf.size())
+    {
+      fprintf(stderr, "%s: malformed record at offset %lu\n", name, (unsigned long)pos);
+      return errors + 1;
+    }
+
+    const char* payload = &buf[pos + sizeof(header)];
+    int logmsg_len = -1;
+
+    switch (header.type)
+    {
+      case LOG_RECORD_FORMAT:
+        formats[header.format_id] = std::string(payload, header.payload_len);
+        break;
+
+      case LOG_RECORD_TEXT:
+        fprintf(stdout, "%" PRId64 " %.*s\n", header.timestamp_ms, (int)header.payload_len, payload);
+        break;
+
+      case LOG_RECORD_JSON:
+        fprintf(stdout, "%.*s\n", (int)header.payload_len, payload);
+        break;
+
+      case LOG_RECORD_BINARY:
+      {
+        std::map<uint16_t, std::string>::const_iterator format = formats.find(header.format_id);
+
+        if (format != formats.end())
+        {
+          logmsg_len = log_binary_format(format->second.c_str(), payload, header.payload_len,
+                                         logmsg, sizeof(logmsg));
+        }
+
+        if (logmsg_len < 0)
+        {
+          fprintf(stderr, "%s: malformed binary record with format id %u at offset %lu\n", name,
+                  (unsigned int)header.format_id, (unsigned long)pos);
+          errors++;
+          break;
+        }
+
+        char level = (header.log_level < sizeof(loglevel_c)) ? loglevel_c[header.log_level] : 'E';
+
+        fprintf(stdout, "%" PRId64 " %c/APPDYNAMICS: %.*s\n", header.timestamp_ms, level, logmsg_len, logmsg);
+        break;
+      }
+
+      default:
+        fprintf(stderr, "%s: unknown record type %u at offset %lu\n", name, (unsigned int)header.type,
+                (unsigned long)pos);
+        errors++;
+        break;
+    }
+
+    pos += header.record_len;
+  }
+
+  return errors;
+}
+
+
+int main(int argc, char* argv[])
+{
+  int errors = 0;
+
+  for (int i = (argc > 1) ? 1 : 0; i < argc; i++)
+  {
+    const char* name = (argc > 1) ? argv[i] : "stdin";
+    FILE* fp = (argc > 1) ? fopen(name, "rb") : stdin;
+    std::vector<char> buf;
+
+    if (fp == NULL)
+    {
+      fprintf(stderr, "%s: failed to open\n", name);
+      errors++;
+      continue;
+    }
+
+    if (!read_file(fp, buf))
+    {
+      fprintf(stderr, "%s: failed to read\n", name);
+      errors++;
+    }
+    else if (!is_file_header(buf, 0))
+    {
+      fprintf(stderr, "%s: not a binary log file\n", name);
+      errors++;
+    }
+    else
+    {
+      errors += decode_file(name, buf);
+    }
+
+    if (fp != stdin)
+    {
+      fclose(fp);
+    }
+  }
+
+  return (errors == 0) ? 0 : 1;
+}